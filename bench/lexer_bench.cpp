@@ -0,0 +1,139 @@
+/**
+* @brief 词法分析微基准测试
+*
+* 生成批量 INSERT 脚本和混合语句脚本（1 KB ~ 64 MB），测量 Lexer::tokenize 的
+* 吞吐量(MB/s)、每个词元耗时，以及每次分词的堆分配次数。
+*
+* 用法: sdsql-bench-lexer [--max-bytes N] [--min-time-ms N]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../include/client/Lexer.hpp"
+
+// ========== 分配计数 ==========
+// 替换全局 operator new，统计基准循环内的堆分配次数
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    uint64_t max_bytes = 64ull * 1024 * 1024;
+    uint64_t min_time_ms = 200;
+};
+
+// 批量 INSERT：大量数字和字符串字面量
+std::string bulkInsertScript(size_t target_bytes) {
+    std::string script;
+    script.reserve(target_bytes + 128);
+    for (uint64_t id = 1; script.size() < target_bytes; ++id) {
+        script += "insert into users values (" + std::to_string(id) + ", \"user_" + std::to_string(id) +
+                  "\", \"user_" + std::to_string(id) + "@example.com\", " + std::to_string(id % 100) + ")\n";
+    }
+    return script;
+}
+
+// 混合语句：关键字和标识符占多数，大小写混用
+std::string mixedScript(size_t target_bytes) {
+    static const char* statements[] = {
+        "SELECT * FROM users WHERE id = 42\n",
+        "select name, email from users where age > 30\n",
+        "Update users Set name = \"bob\", age = 31 Where id = 7\n",
+        "delete from orders where order_id < 1000\n",
+        "CREATE TABLE orders(order_id int primary, user_id int, note string)\n",
+        "use shop_database\n",
+        "show stats\n",
+    };
+    std::string script;
+    script.reserve(target_bytes + 128);
+    for (size_t i = 0; script.size() < target_bytes; ++i) {
+        script += statements[i % std::size(statements)];
+    }
+    return script;
+}
+
+void benchScript(const BenchConfig& config, const char* name, const std::string& script) {
+    size_t token_count = Lexer(script).tokenize().size();
+
+    const auto min_time = std::chrono::milliseconds(config.min_time_ms);
+    uint64_t iterations = 0;
+    uint64_t allocs_before = g_allocations.load(std::memory_order_relaxed);
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        auto tokens = Lexer(script).tokenize();
+        if (tokens.size() != token_count) {
+            std::abort();
+        }
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < min_time);
+    uint64_t allocs = g_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+    double ns_per_op = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+    double mb_per_s = (static_cast<double>(script.size()) / (1024.0 * 1024.0)) / (ns_per_op / 1e9);
+    std::printf("%-14s %12zu %12zu %12.2f %12.1f %12.1f\n", name, script.size(), token_count,
+                ns_per_op / token_count, mb_per_s, static_cast<double>(allocs) / iterations);
+}
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-bytes" && i + 1 < argc) {
+            config.max_bytes = std::max<uint64_t>(1024, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            config.min_time_ms = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max-bytes N] [--min-time-ms N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+
+    std::cout << "=== Lexer Benchmarks ===" << std::endl;
+    std::printf("%-14s %12s %12s %12s %12s %12s\n", "script", "bytes", "tokens", "ns/token", "MB/s", "allocs");
+    for (uint64_t bytes = 1024; bytes <= config.max_bytes; bytes *= 64) {
+        benchScript(config, "bulk insert", bulkInsertScript(bytes));
+        benchScript(config, "mixed", mixedScript(bytes));
+    }
+    return 0;
+}
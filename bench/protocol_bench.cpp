@@ -0,0 +1,307 @@
+/**
+* @brief 网络层序列化/反序列化微基准测试
+*
+* 覆盖 QueryResponse（窄/宽行、短/长字符串、10 ~ 1M 行）的编码与解码，
+* 以及 LoginRequest、QueryRequest 的往返。输出每条消息耗时、吞吐量(MB/s)
+* 和每条消息的堆分配次数。最后对比 40 列结果只读取其中 2 列时，
+* QueryResponse 全量解码与 ResultSet 按需解码的耗时。
+*
+* 用法: sdsql-bench-protocol [--max-rows N] [--min-time-ms N]
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../include/network/protocol.hpp"
+#include "../include/network/query.hpp"
+#include "../include/network/result_set.hpp"
+
+// ========== 分配计数 ==========
+// 替换全局 operator new，统计基准循环内的堆分配次数
+
+namespace {
+std::atomic<uint64_t> g_allocations{0};
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    uint64_t max_rows = 1000000;
+    uint64_t min_time_ms = 200;
+    // 单个响应的载荷上限，超过则跳过该组合，避免小内存机器 OOM
+    uint64_t max_payload_bytes = 256ull * 1024 * 1024;
+};
+
+struct BenchResult {
+    uint64_t iterations = 0;
+    double ns_per_op = 0;
+    double allocs_per_op = 0;
+};
+
+// 反复执行 fn 直到累计时间超过 min_time_ms（至少执行一次）
+template <typename Fn>
+BenchResult runBench(const BenchConfig& config, Fn&& fn) {
+    const auto min_time = std::chrono::milliseconds(config.min_time_ms);
+    BenchResult result;
+    uint64_t allocs_before = g_allocations.load(std::memory_order_relaxed);
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        fn();
+        ++result.iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < min_time);
+    uint64_t allocs = g_allocations.load(std::memory_order_relaxed) - allocs_before;
+
+    result.ns_per_op = static_cast<double>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / result.iterations;
+    result.allocs_per_op = static_cast<double>(allocs) / result.iterations;
+    return result;
+}
+
+double megabytesPerSecond(size_t bytes, double ns_per_op) {
+    if (ns_per_op <= 0) {
+        return 0;
+    }
+    return (static_cast<double>(bytes) / (1024.0 * 1024.0)) / (ns_per_op / 1e9);
+}
+
+void printHeader() {
+    std::printf("%-34s %10s %12s %14s %10s %12s %14s %10s %12s\n",
+                "case", "rows", "bytes/msg",
+                "enc ns/msg", "enc MB/s", "enc allocs",
+                "dec ns/msg", "dec MB/s", "dec allocs");
+}
+
+void printRow(const std::string& name, uint64_t rows, size_t bytes,
+              const BenchResult& enc, const BenchResult& dec) {
+    std::printf("%-34s %10llu %12zu %14.0f %10.1f %12.1f %14.0f %10.1f %12.1f\n",
+                name.c_str(), static_cast<unsigned long long>(rows), bytes,
+                enc.ns_per_op, megabytesPerSecond(bytes, enc.ns_per_op), enc.allocs_per_op,
+                dec.ns_per_op, megabytesPerSecond(bytes, dec.ns_per_op), dec.allocs_per_op);
+}
+
+// 编码 + 解码一条消息，并打印结果
+template <typename MessageT>
+void benchRoundTrip(const BenchConfig& config, const std::string& name,
+                    uint64_t rows, const MessageT& message) {
+    std::vector<std::byte> encoded = message.serialize();
+
+    auto enc = runBench(config, [&] {
+        auto bytes = message.serialize();
+        if (bytes.empty()) {
+            std::abort();
+        }
+    });
+
+    auto dec = runBench(config, [&] {
+        auto decoded = NET::Message::deserialize(encoded);
+        if (!decoded.has_value()) {
+            std::cerr << "[BENCH] Failed to decode " << name << std::endl;
+            std::abort();
+        }
+    });
+
+    printRow(name, rows, encoded.size(), enc, dec);
+}
+
+// ========== QueryResponse 形状 ==========
+
+struct ResponseShape {
+    const char* name;
+    size_t int_columns;
+    size_t string_columns;
+    size_t string_length;
+};
+
+// 估算编码后的载荷大小，用于在构造之前跳过过大的组合
+uint64_t estimatePayloadBytes(const ResponseShape& shape, uint64_t rows) {
+    const uint64_t int_cell = 4 + 8;
+    const uint64_t string_cell = 4 + shape.string_length;
+    const uint64_t row_bytes = 4 + shape.int_columns * int_cell + shape.string_columns * string_cell;
+    return rows * row_bytes;
+}
+
+NET::QueryResponse buildResponse(const ResponseShape& shape, uint64_t rows) {
+    std::vector<std::string> columns;
+    for (size_t i = 0; i < shape.int_columns; ++i) {
+        columns.push_back("int_col_" + std::to_string(i));
+    }
+    for (size_t i = 0; i < shape.string_columns; ++i) {
+        columns.push_back("str_col_" + std::to_string(i));
+    }
+
+    const std::string text(shape.string_length, 'x');
+    std::vector<NET::QueryResponse::Row> data;
+    data.reserve(rows);
+    for (uint64_t r = 0; r < rows; ++r) {
+        NET::QueryResponse::Row row;
+        row.columns.reserve(columns.size());
+        for (size_t i = 0; i < shape.int_columns; ++i) {
+            row.columns.push_back(std::to_string(r * 31 + i));
+        }
+        for (size_t i = 0; i < shape.string_columns; ++i) {
+            row.columns.push_back(text);
+        }
+        data.push_back(std::move(row));
+    }
+    return NET::QueryResponse(std::move(columns), std::move(data));
+}
+
+void benchQueryResponses(const BenchConfig& config) {
+    const ResponseShape shapes[] = {
+        {"narrow/short", 2, 1, 8},
+        {"narrow/long", 2, 1, 256},
+        {"wide/short", 16, 16, 8},
+        {"wide/long", 16, 16, 256},
+    };
+    const uint64_t row_counts[] = {10, 1000, 100000, 1000000};
+
+    for (const auto& shape : shapes) {
+        for (uint64_t rows : row_counts) {
+            if (rows > config.max_rows) {
+                continue;
+            }
+            std::string name = std::string("QueryResponse ") + shape.name;
+            if (estimatePayloadBytes(shape, rows) > config.max_payload_bytes) {
+                std::printf("%-34s %10llu %12s\n", name.c_str(),
+                            static_cast<unsigned long long>(rows), "(skipped)");
+                continue;
+            }
+            NET::QueryResponse response = buildResponse(shape, rows);
+            benchRoundTrip(config, name, rows, response);
+        }
+    }
+}
+
+// ========== 按需解码 ==========
+
+// 40 列（20 个整数列 + 20 个字符串列）的结果只读取 2 个整数列
+void benchResultAccess(const BenchConfig& config) {
+    const ResponseShape shape{"wide40", 20, 20, 16};
+    const uint64_t row_counts[] = {1000, 100000};
+
+    std::printf("\n%-34s %10s %12s %14s %12s %14s %12s\n",
+                "case (read 2 of 40 columns)", "rows", "bytes/msg",
+                "eager ns/msg", "eager allocs", "lazy ns/msg", "lazy allocs");
+    for (uint64_t rows : row_counts) {
+        if (rows > config.max_rows) {
+            continue;
+        }
+        std::vector<std::byte> encoded = buildResponse(shape, rows).serialize();
+        int64_t expected_sum = 0;
+
+        auto eager = runBench(config, [&] {
+            auto decoded = NET::Message::deserialize(encoded);
+            auto* response = decoded.has_value() ? dynamic_cast<NET::QueryResponse*>(decoded.value().get()) : nullptr;
+            if (response == nullptr) {
+                std::abort();
+            }
+            int64_t sum = 0;
+            for (const auto& row : response->getRows()) {
+                sum += std::stoll(row.columns[0]) + std::stoll(row.columns[7]);
+            }
+            expected_sum = sum;
+        });
+
+        // 帧的拷贝计入耗时：实际使用时 ResultSet 接管接收到的帧，不需要这次拷贝
+        auto lazy = runBench(config, [&] {
+            auto result = NET::ResultSet::fromFrame(encoded);
+            if (!result.has_value()) {
+                std::abort();
+            }
+            int64_t sum = 0;
+            for (size_t r = 0; r < result->getRowCount(); ++r) {
+                sum += result->getInt64(r, 0).value_or(0) + result->getInt64(r, 7).value_or(0);
+            }
+            if (sum != expected_sum) {
+                std::abort();
+            }
+        });
+
+        std::printf("%-34s %10llu %12zu %14.0f %12.1f %14.0f %12.1f\n",
+                    "QueryResponse vs ResultSet", static_cast<unsigned long long>(rows), encoded.size(),
+                    eager.ns_per_op, eager.allocs_per_op, lazy.ns_per_op, lazy.allocs_per_op);
+    }
+}
+
+// ========== 请求消息 ==========
+
+void benchRequests(const BenchConfig& config) {
+    NET::LoginRequest login("admin", "123456");
+    benchRoundTrip(config, "LoginRequest", 0, login);
+
+    NET::QueryRequest select(NET::OperationType::SELECT);
+    select.setSessionToken("token_1001");
+    select.setTableName("users");
+    select.setSelectColumns({"id", "name", "email"});
+    select.setWhereCondition(NET::WhereCondition("id", "=", NET::LiteralValue(NET::DataType::INT, "42")));
+    benchRoundTrip(config, "QueryRequest select", 0, select);
+
+    NET::QueryRequest insert(NET::OperationType::INSERT);
+    insert.setSessionToken("token_1001");
+    insert.setTableName("users");
+    std::vector<NET::LiteralValue> values;
+    for (int i = 0; i < 16; ++i) {
+        values.emplace_back(NET::DataType::STRING, "value_" + std::to_string(i));
+    }
+    insert.setInsertValues(values);
+    benchRoundTrip(config, "QueryRequest insert x16", 0, insert);
+}
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-rows" && i + 1 < argc) {
+            config.max_rows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            config.min_time_ms = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max-rows N] [--min-time-ms N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+
+    std::cout << "=== Protocol Benchmarks ===" << std::endl;
+    printHeader();
+    benchRequests(config);
+    benchQueryResponses(config);
+    benchResultAccess(config);
+    return 0;
+}
@@ -0,0 +1,278 @@
+/**
+* @brief 任务调度器扩展性基准测试
+*
+* 在 1、2、4 … 个工作线程下分别测量：空任务的提交吞吐量、递归 fork-join（fib）、
+* 并行求和、并行排序，以及存储引擎上带 WHERE / ORDER BY 的大表 SELECT
+* （并行扫描和排序），输出每次耗时和相对单线程的加速比。
+*
+* 用法: sdsql-bench-scheduler [--max-threads N] [--rows N] [--min-time-ms N]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+#include "../include/server/DatabaseAPI.hpp"
+#include "../include/server/TaskScheduler.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    size_t rows = 200000;
+    uint64_t min_time_ms = 300;
+};
+
+// 重复执行 body 直到超过 min_time，返回每次的平均耗时(ns)
+double measure(const BenchConfig& config, const std::function<void()>& body) {
+    const auto min_time = std::chrono::milliseconds(config.min_time_ms);
+    uint64_t iterations = 0;
+    auto start = Clock::now();
+    auto elapsed = Clock::duration::zero();
+    do {
+        body();
+        ++iterations;
+        elapsed = Clock::now() - start;
+    } while (elapsed < min_time);
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / iterations;
+}
+
+// ========== 基准用例 ==========
+
+constexpr size_t SPAWN_TASKS = 100000;
+constexpr int FIB_N = 27;
+constexpr int FIB_CUTOFF = 12; // 小于该值时串行计算，避免任务粒度过细
+constexpr size_t SUM_ELEMENTS = 1 << 24;
+constexpr size_t SORT_ELEMENTS = 1 << 21;
+
+void spawnEmpty(TaskScheduler& scheduler) {
+    TaskGroup group(scheduler);
+    for (size_t i = 0; i < SPAWN_TASKS; ++i) {
+        group.run([] {});
+    }
+    group.wait();
+}
+
+long fibSerial(int n) {
+    return n < 2 ? n : fibSerial(n - 1) + fibSerial(n - 2);
+}
+
+long fibParallel(TaskScheduler& scheduler, int n) {
+    if (n < FIB_CUTOFF) {
+        return fibSerial(n);
+    }
+    long left = 0;
+    TaskGroup group(scheduler);
+    group.run([&] { left = fibParallel(scheduler, n - 1); });
+    long right = fibParallel(scheduler, n - 2);
+    group.wait();
+    return left + right;
+}
+
+uint64_t parallelSum(TaskScheduler& scheduler, const std::vector<uint32_t>& values) {
+    size_t chunks = scheduler.threadCount() * 4;
+    size_t chunk_size = (values.size() + chunks - 1) / chunks;
+    std::vector<uint64_t> partial(chunks, 0);
+    TaskGroup group(scheduler);
+    for (size_t c = 0; c < chunks; ++c) {
+        group.run([&, c] {
+            size_t begin = std::min(values.size(), c * chunk_size);
+            size_t end = std::min(values.size(), begin + chunk_size);
+            partial[c] = std::accumulate(values.begin() + begin, values.begin() + end, uint64_t{0});
+        });
+    }
+    group.wait();
+    return std::accumulate(partial.begin(), partial.end(), uint64_t{0});
+}
+
+// 分段并行排序，再逐轮两两归并
+void parallelSort(TaskScheduler& scheduler, std::vector<uint32_t>& values) {
+    size_t segments = scheduler.threadCount() * 4;
+    size_t segment_size = (values.size() + segments - 1) / segments;
+    std::vector<size_t> bounds;
+    for (size_t begin = 0; begin < values.size(); begin += segment_size) {
+        bounds.push_back(begin);
+    }
+    bounds.push_back(values.size());
+
+    TaskGroup group(scheduler);
+    for (size_t i = 0; i + 1 < bounds.size(); ++i) {
+        group.run([&, i] { std::sort(values.begin() + bounds[i], values.begin() + bounds[i + 1]); });
+    }
+    group.wait();
+
+    while (bounds.size() > 2) {
+        std::vector<size_t> merged;
+        for (size_t i = 0; i + 2 < bounds.size(); i += 2) {
+            group.run([&, i] {
+                std::inplace_merge(values.begin() + bounds[i], values.begin() + bounds[i + 1],
+                                   values.begin() + bounds[i + 2]);
+            });
+        }
+        group.wait();
+        for (size_t i = 0; i < bounds.size(); i += 2) {
+            merged.push_back(bounds[i]);
+        }
+        if (merged.back() != values.size()) {
+            merged.push_back(values.size());
+        }
+        bounds.swap(merged);
+    }
+}
+
+// ========== 存储引擎 ==========
+
+struct BenchDatabase {
+    std::filesystem::path root;
+    std::unique_ptr<Database> database;
+
+    explicit BenchDatabase(size_t rows) {
+        root = std::filesystem::temp_directory_path() / ("sdsql-bench-scheduler-" + std::to_string(getpid()));
+        std::filesystem::remove_all(root);
+        database = std::make_unique<Database>(root.string());
+        auto& ddl = database->getDDLOperations();
+        ddl.createDatabase("bench");
+        ddl.useDatabase("bench");
+        ddl.createTable("events", {ColumnDefinition("id", DataType::INT, true),
+                                   ColumnDefinition("grp", DataType::INT),
+                                   ColumnDefinition("score", DataType::DOUBLE),
+                                   ColumnDefinition("note", DataType::STRING)});
+        auto& dml = database->getDMLOperations();
+        std::mt19937 rng(42);
+        for (size_t i = 0; i < rows; ++i) {
+            dml.insert("events", std::vector<std::string>{std::to_string(i), std::to_string(rng() % 8),
+                                                          std::to_string(rng() % 100000 / 100.0),
+                                                          "event_" + std::to_string(rng() % 1000)});
+        }
+    }
+
+    ~BenchDatabase() {
+        database.reset();
+        std::error_code ignored;
+        std::filesystem::remove_all(root, ignored);
+    }
+};
+
+size_t selectRows(Database& database, const char* where, const char* order_by) {
+    auto result = database.getDMLOperations().select("events", where, order_by);
+    return static_cast<size_t>(result->getRowCount());
+}
+
+// ========== 输出 ==========
+
+struct Case {
+    const char* name;
+    std::function<void(TaskScheduler&)> body;
+    std::vector<double> ns_by_threads;
+};
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--max-threads" && i + 1 < argc) {
+            config.max_threads = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--rows" && i + 1 < argc) {
+            config.rows = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-time-ms" && i + 1 < argc) {
+            config.min_time_ms = std::strtoull(argv[++i], nullptr, 10);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--max-threads N] [--rows N] [--min-time-ms N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+
+    std::vector<size_t> thread_counts;
+    for (size_t threads = 1; threads < config.max_threads; threads *= 2) {
+        thread_counts.push_back(threads);
+    }
+    thread_counts.push_back(config.max_threads);
+
+    std::vector<uint32_t> values(SUM_ELEMENTS);
+    std::mt19937 rng(7);
+    for (auto& value : values) {
+        value = rng();
+    }
+    const uint64_t expected_sum = std::accumulate(values.begin(), values.end(), uint64_t{0});
+    const std::vector<uint32_t> unsorted(values.begin(), values.begin() + SORT_ELEMENTS);
+    const long expected_fib = fibSerial(FIB_N);
+
+    std::cout << "Loading " << config.rows << " rows..." << std::endl;
+    BenchDatabase bench_db(config.rows);
+    Database& database = *bench_db.database;
+    const size_t expected_matches = selectRows(database, "grp = 3", "");
+
+    std::vector<Case> cases;
+    cases.push_back({"spawn 100k", [](TaskScheduler& s) { spawnEmpty(s); }, {}});
+    cases.push_back({"fib(27)", [&](TaskScheduler& s) {
+        if (fibParallel(s, FIB_N) != expected_fib) {
+            std::abort();
+        }
+    }, {}});
+    cases.push_back({"sum 16M", [&](TaskScheduler& s) {
+        if (parallelSum(s, values) != expected_sum) {
+            std::abort();
+        }
+    }, {}});
+    cases.push_back({"sort 2M", [&](TaskScheduler& s) {
+        std::vector<uint32_t> copy = unsorted;
+        parallelSort(s, copy);
+        if (!std::is_sorted(copy.begin(), copy.end())) {
+            std::abort();
+        }
+    }, {}});
+    cases.push_back({"select where", [&](TaskScheduler&) {
+        if (selectRows(database, "grp = 3", "") != expected_matches) {
+            std::abort();
+        }
+    }, {}});
+    cases.push_back({"select order", [&](TaskScheduler&) {
+        if (selectRows(database, "grp = 3", "score") != expected_matches) {
+            std::abort();
+        }
+    }, {}});
+
+    std::cout << "=== Scheduler Benchmarks ===" << std::endl;
+    for (size_t threads : thread_counts) {
+        TaskScheduler scheduler(SchedulerConfig{threads, false});
+        database.setTaskScheduler(&scheduler);
+        for (auto& c : cases) {
+            c.ns_by_threads.push_back(measure(config, [&] { c.body(scheduler); }));
+        }
+        database.setTaskScheduler(nullptr);
+    }
+
+    std::printf("%-14s", "case");
+    for (size_t threads : thread_counts) {
+        std::printf(" %9zuT ms %7s", threads, "speedup");
+    }
+    std::printf("\n");
+    for (const auto& c : cases) {
+        std::printf("%-14s", c.name);
+        for (double ns : c.ns_by_threads) {
+            std::printf(" %12.2f %6.2fx", ns / 1e6, c.ns_by_threads.front() / ns);
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
@@ -0,0 +1,210 @@
+/**
+* @brief 本机传输往返延迟基准测试
+*
+* fork 出一个回显服务端，客户端按主键点查的形状发送 QueryRequest，服务端回复一行
+* QueryResponse，分别测量 Unix 域套接字和共享内存环两种传输的往返延迟（p50/p99/max），
+* 以及 AsyncClient 在一条连接上保持 N 个未完成请求时的吞吐量。
+* 不经过存储引擎，只反映传输和编解码本身的开销。
+*
+* 用法: sdsql-bench-transport [--iterations N] [--spin-us N] [--depth N]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../include/network/async_client.hpp"
+#include "../include/network/protocol.hpp"
+#include "../include/network/query.hpp"
+#include "../include/network/socket_client.hpp"
+#include "../include/network/socket_server.hpp"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct BenchConfig {
+    uint64_t iterations = 20000;
+    int64_t spin_us = -1;  // <0 使用默认自旋时长
+    uint64_t depth = 256;  // 异步测试中保持的未完成请求数
+};
+
+// 回显服务端：依次服务每个连接，对每个查询回复固定的一行结果
+[[noreturn]] void runEchoServer(NET::SocketServer& server) {
+    NET::QueryResponse response({"id", "name", "email"},
+                                {NET::QueryResponse::Row{{"42", "alice", "alice@example.com"}}});
+    auto frame = response.serialize();
+
+    while (true) {
+        auto client_fd = server.acceptClient();
+        if (!client_fd.has_value()) {
+            _exit(1);
+        }
+        while (true) {
+            auto message = server.receiveMessage(client_fd.value());
+            if (!message.has_value()) {
+                break;
+            }
+            if (message.value()->getType() == NET::MessageType::SHM_ATTACH_REQUEST) {
+                if (!server.acceptSharedMemory(client_fd.value(), true).has_value()) {
+                    break;
+                }
+                continue;
+            }
+            if (!server.sendFrame(client_fd.value(), frame).has_value()) {
+                break;
+            }
+        }
+        server.disconnectClient(client_fd.value());
+    }
+}
+
+NET::QueryRequest pointLookup() {
+    NET::QueryRequest request(NET::OperationType::SELECT);
+    request.setSessionToken("token_1001");
+    request.setTableName("users");
+    request.setWhereCondition(NET::WhereCondition("id", "=", NET::LiteralValue(NET::DataType::INT, "42")));
+    return request;
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    size_t index = static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+bool measure(const BenchConfig& config, NET::SocketClient& client, const std::string& name) {
+    NET::QueryRequest request = pointLookup();
+
+    // 预热
+    for (int i = 0; i < 1000; ++i) {
+        if (!client.sendMessage(request).has_value() || !client.receiveMessage().has_value()) {
+            return false;
+        }
+    }
+
+    std::vector<double> samples;
+    samples.reserve(config.iterations);
+    for (uint64_t i = 0; i < config.iterations; ++i) {
+        auto start = Clock::now();
+        if (!client.sendMessage(request).has_value() || !client.receiveMessage().has_value()) {
+            return false;
+        }
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+    }
+
+    double mean = 0;
+    for (double sample : samples) {
+        mean += sample;
+    }
+    mean /= samples.size();
+    double max = *std::max_element(samples.begin(), samples.end());
+    double p50 = percentile(samples, 0.50);
+    double p99 = percentile(samples, 0.99);
+    std::printf("%-14s %10llu %10.2f %10.2f %10.2f %10.2f\n", name.c_str(),
+                static_cast<unsigned long long>(config.iterations), mean, p50, p99, max);
+    return true;
+}
+
+// 异步流水线：始终保持 depth 个未完成的请求，统计吞吐量
+bool measurePipelined(const BenchConfig& config, const std::string& path) {
+    NET::AsyncClient client;
+    if (!client.connectUnix(path).has_value()) {
+        return false;
+    }
+    NET::QueryRequest request = pointLookup();
+
+    std::deque<std::future<NET::AsyncClient::QueryResult>> in_flight;
+    auto start = Clock::now();
+    for (uint64_t i = 0; i < config.iterations; ++i) {
+        if (in_flight.size() >= config.depth) {
+            if (!in_flight.front().get().has_value()) {
+                return false;
+            }
+            in_flight.pop_front();
+        }
+        in_flight.push_back(client.executeAsync(request));
+    }
+    for (auto& future : in_flight) {
+        if (!future.get().has_value()) {
+            return false;
+        }
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::printf("%-14s %10llu %10llu %14.0f %12.2f\n", "async (unix)",
+                static_cast<unsigned long long>(config.iterations),
+                static_cast<unsigned long long>(config.depth),
+                config.iterations / seconds, seconds * 1e6 / config.iterations);
+    return true;
+}
+
+bool parseArgs(int argc, char* argv[], BenchConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            config.iterations = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--spin-us" && i + 1 < argc) {
+            config.spin_us = std::strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "--depth" && i + 1 < argc) {
+            config.depth = std::max<uint64_t>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--iterations N] [--spin-us N] [--depth N]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchConfig config;
+    if (!parseArgs(argc, argv, config)) {
+        return 1;
+    }
+    if (config.spin_us >= 0) {
+        NET::ShmChannel::setSpinDuration(std::chrono::microseconds(config.spin_us));
+    }
+
+    std::string path = "/tmp/sdsql-bench-" + std::to_string(getpid()) + ".sock";
+    NET::SocketServer server;
+    if (!server.startUnix(path).has_value()) {
+        std::cerr << "[BENCH] Failed to listen on " << path << std::endl;
+        return 1;
+    }
+
+    pid_t child = fork();
+    if (child == 0) {
+        runEchoServer(server);
+    }
+
+    NET::SocketClient client;
+    bool ok = client.connectUnix(path).has_value();
+    std::cout << "=== Transport Round-Trip Benchmarks (us) ===" << std::endl;
+    std::printf("%-14s %10s %10s %10s %10s %10s\n", "transport", "requests", "mean", "p50", "p99", "max");
+    ok = ok && measure(config, client, "unix socket");
+    if (ok && !client.enableSharedMemory().has_value()) {
+        std::cerr << "[BENCH] Failed to switch to shared memory" << std::endl;
+        ok = false;
+    }
+    ok = ok && measure(config, client, "shared memory");
+    client.disconnect();
+
+    std::printf("\n%-14s %10s %10s %14s %12s\n", "transport", "requests", "depth", "requests/s", "us/request");
+    ok = ok && measurePipelined(config, path);
+
+    kill(child, SIGTERM);
+    waitpid(child, nullptr, 0);
+    server.stop();
+    return ok ? 0 : 1;
+}
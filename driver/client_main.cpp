@@ -1,7 +1,84 @@
 #include "../include/client/CliApp.hpp"
+#include <iostream>
 
-int main() {
-    CliApp app;
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --host IP       Server address (default: 127.0.0.1)\n"
+              << "  --port N        Server port (default: 4399)\n"
+              << "  --socket PATH   Connect through a unix domain socket instead of TCP\n"
+              << "  --peer-auth     Log in with the process credentials (unix socket only)\n"
+              << "  --shm           Switch to the shared memory transport (unix socket only)\n"
+              << "  --keepalive SEC Ping the server after SEC idle seconds (default: 30, 0 disables)\n"
+              << "  --user NAME     Log in as NAME instead of prompting\n"
+              << "  --password PW   Password for --user\n"
+              << "  --format FMT    Result format: table (default), unaligned or tsv\n"
+              << "\n"
+              << "Batch mode:\n"
+              << "  -f FILE         Run the statements in FILE (one per line, -- comments) and exit\n"
+              << "  --quiet         Print only errors and the summary\n"
+              << "  --pipeline N    Statements sent ahead of their responses (default: 64, 1 disables)\n";
+}
+
+int main(int argc, char* argv[]) {
+    ConnectionOptions options;
+    ScriptOptions script;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        try {
+            if (arg == "--host" && has_value) {
+                options.server_ip = argv[++i];
+            } else if (arg == "--port" && has_value) {
+                options.server_port = static_cast<uint16_t>(std::stoul(argv[++i]));
+            } else if (arg == "--socket" && has_value) {
+                options.unix_socket = argv[++i];
+            } else if (arg == "--peer-auth") {
+                options.peer_auth = true;
+            } else if (arg == "--shm") {
+                options.shared_memory = true;
+            } else if (arg == "--keepalive" && has_value) {
+                options.keepalive_interval = std::chrono::seconds(std::stoul(argv[++i]));
+            } else if (arg == "--user" && has_value) {
+                options.username = argv[++i];
+            } else if (arg == "--password" && has_value) {
+                options.password = argv[++i];
+            } else if (arg == "-f" && has_value) {
+                script.path = argv[++i];
+            } else if ((arg == "--format" && has_value) || arg.starts_with("--format=")) {
+                std::string format = arg == "--format" ? argv[++i] : arg.substr(std::string("--format=").size());
+                if (format == "table") {
+                    script.format = OutputFormat::TABLE;
+                } else if (format == "unaligned") {
+                    script.format = OutputFormat::UNALIGNED;
+                } else if (format == "tsv") {
+                    script.format = OutputFormat::TSV;
+                } else {
+                    throw std::invalid_argument(format);
+                }
+            } else if (arg == "--quiet") {
+                script.format = OutputFormat::QUIET;
+            } else if (arg == "--pipeline" && has_value) {
+                script.pipeline_depth = std::stoull(argv[++i]);
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Invalid value for " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.shared_memory && options.unix_socket.empty()) {
+        std::cerr << "--shm requires --socket" << std::endl;
+        return 1;
+    }
+
+    CliApp app(options);
+    if (!script.path.empty()) {
+        return app.run_script(script);
+    }
+    app.set_output_format(script.format);
     app.run();
     return 0;
 }
\ No newline at end of file
@@ -1,28 +1,143 @@
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <deque>
 #include <filesystem>
+#include <iomanip>
 #include <iostream>
 #include <memory>
 #include <string>
 #include <map>
+#include <sstream>
 #include <vector>
+#include <fcntl.h>
+#include <unistd.h>
 
 // 包含数据库API和网络层头文件
+#include "../include/server/AdmissionController.hpp"
 #include "../include/server/DatabaseAPI.hpp"
+#include "../include/server/QueryInterrupt.hpp"
+#include "../include/server/RowFilter.hpp"
+#include "../include/server/ServerStats.hpp"
+#include "../include/server/SessionManager.hpp"
+#include "../include/server/SlowQueryLog.hpp"
+#include "../include/server/TaskScheduler.hpp"
+#include "../include/server/Trace.hpp"
+#include "../include/network/event_loop.hpp"
 #include "../include/network/socket_server.hpp"
+#include "../include/network/parse_cache.hpp"
 #include "../include/network/protocol.hpp"
 #include "../include/network/query.hpp"
 
 #define USERNAME "admin"
 #define PASSWORD "123456"
 
-void handleLogin(NET::SocketServer& server, int client_fd, const NET::LoginRequest& request);
-void handleQuery(NET::SocketServer& server, int client_fd, const NET::QueryRequest& request);
+// 服务端启动参数
+struct ServerOptions {
+    SlowQueryLogConfig slow_query_log;
+    bool trace = false;                 // 是否开启请求追踪
+    size_t trace_buffer_spans = 65536;  // 每个线程保留的 span 数量
+    std::string trace_dir = ".";        // SHOW TRACE 导出目录
+    uint64_t memory_limit = 0;          // 以下内存上限单位为字节，0 表示不限制
+    uint64_t table_memory_limit = 0;
+    uint64_t session_memory_limit = 0;
+    uint64_t query_memory_limit = 0;
+    bool tcp = true;                    // 是否监听 TCP 127.0.0.1:4399
+    std::string unix_socket;            // 非空时同时监听该路径上的 Unix 域套接字
+    bool unix_peer_auth = false;        // Unix 域连接按 SO_PEERCRED 免密码登录
+    bool shared_memory = false;         // 允许 Unix 域连接升级为共享内存传输
+    unsigned idle_timeout_sec = 120;    // 连接空闲超过该秒数即断开，0 表示不限制
+    unsigned statement_timeout_ms = 0;  // 语句的默认最长执行时间，0 表示不限制
+    unsigned session_timeout_sec = 3600; // 会话空闲超过该秒数即失效，0 表示不限制
+    size_t parse_cache_entries = 256;   // SQL 文本解析缓存的条目数，0 表示不缓存
+    int listen_backlog = 128;           // 内核中等待 accept 的连接数
+    AdmissionConfig admission;          // 连接数、请求队列和单条查询的预算
+    SchedulerConfig scheduler;          // 执行语句和并行扫描/排序的工作线程
+};
+
+bool parseServerOptions(int argc, char* argv[], ServerOptions& options);
 
 // 全局变量
-std::string current_token = "";
-bool is_logged_in = false;
 std::unique_ptr<Database> database_instance = nullptr;
+std::unique_ptr<SessionManager> session_manager = nullptr;
+std::shared_ptr<Session> current_session = nullptr;  // 正在执行的请求所属的会话
+std::string active_database;                         // 存储引擎当前 USE 的数据库
+ServerStats server_stats;
+std::unique_ptr<SlowQueryLog> slow_query_log = nullptr;
+std::unique_ptr<NET::ParseCache> parse_cache = nullptr;
+std::string trace_dir = ".";
+uint64_t session_memory_limit = 0;
+uint64_t query_memory_limit = 0;
+uint64_t last_query_peak_bytes = 0;
+bool unix_peer_auth = false;
+bool allow_shared_memory = false;
+std::chrono::milliseconds idle_timeout{-1};          // 连接空闲超时，负数表示不限制
+QueryInterrupt query_interrupt;                       // 当前语句的取消状态
+std::chrono::milliseconds default_statement_timeout{0};
+std::unique_ptr<AdmissionController> admission = nullptr;
+
+// 所有连接在 event_loop 线程上以协程并发服务，语句在 scheduler 的工作线程上执行，
+// 大表的扫描和排序也拆分到这些线程上。存储引擎和上面的执行状态不是线程安全的，
+// engine_lock 保证同一时刻只有一条语句在执行
+std::unique_ptr<NET::EventLoop> event_loop = nullptr;
+std::unique_ptr<TaskScheduler> scheduler = nullptr;
+std::unique_ptr<NET::Executor> io_executor = nullptr;   // 阻塞的握手收发，不占用调度器的线程
+std::unique_ptr<NET::AsyncMutex> engine_lock = nullptr;
+uint64_t running_session_id = 0;                      // 正在执行的语句所属的会话和连接，0 表示没有
+uint64_t running_connection_id = 0;
+uint64_t next_connection_id = 0;
+
+// 每个连接最多预读的请求数，处理跟不上时暂停读取，由 TCP 流控让客户端放慢
+constexpr size_t MAX_INBOX_REQUESTS = 1024;
+
+// 已读到、等待处理的请求
+struct PendingRequest {
+    std::unique_ptr<NET::Message> message;
+    AdmissionController::Clock::time_point arrivedAt;
+    QueryTimings timings;  // 已计入接收和反序列化的耗时
+};
+
+// 一个客户端连接，由它的读协程和处理协程共同持有，两者都结束后关闭
+struct Connection {
+    Connection(NET::SocketServer& owner, int client_fd, uint64_t connection_id)
+        : server(owner), fd(client_fd), id(connection_id) {}
+    ~Connection();
+    
+    NET::SocketServer& server;
+    int fd;
+    uint64_t id;
+    std::unique_ptr<NET::ShmChannel> shm;      // 已升级为共享内存传输时的通道
+    std::unique_ptr<NET::Executor> shm_io;     // 通道的收发线程
+    std::deque<PendingRequest> inbox;
+    NET::AsyncEvent inbox_ready;               // 读协程 -> 处理协程：有新请求或连接已关闭
+    NET::AsyncEvent inbox_space;               // 处理协程 -> 读协程：inbox 有空位
+    NET::AsyncEvent handshake_done;            // 处理协程 -> 读协程：共享内存握手结束
+    bool closed = false;                       // 读协程已结束，不会再有新请求
+    bool busy = false;                         // 处理协程正在处理一条请求
+    bool cancel_requested = false;             // 当前请求开始执行前收到了 CANCEL，轮到时不再执行
+    std::vector<std::string> tokens;           // 该连接上登录产生的令牌
+};
+
+Connection::~Connection() {
+    // 令牌只在登录所在的连接上有效，连接断开后一并注销
+    for (const auto& token : tokens) {
+        session_manager->remove(token);
+    }
+    shm_io.reset();  // 先停止收发线程再释放通道
+    shm.reset();
+    close(fd);
+    admission->connectionClosed();
+    std::cout << "[CONNECTION] Connection " << id << " closed" << std::endl;
+}
 
-int main() {
+NET::Task<void> acceptConnections(NET::SocketServer& server, int listen_fd);
+
+int main(int argc, char* argv[]) {
+    ServerOptions options;
+    if (!parseServerOptions(argc, argv, options)) {
+        return 1;
+    }
+    
     std::cout << "=== Database Server ===" << std::endl;
     std::cout << "Username: " << USERNAME << std::endl;
     std::cout << "Password: " << PASSWORD << std::endl;
@@ -41,60 +156,78 @@ int main() {
         database_instance = std::make_unique<Database>(dbRoot);
         std::cout << "[INIT] Database initialized at: " << dbRoot << std::endl;
         
+        database_instance->getMemoryRoot().setLimit(options.memory_limit);
+        database_instance->setTableMemoryLimit(options.table_memory_limit);
+        database_instance->setQueryInterrupt(&query_interrupt);
+        database_instance->setQueryRowLimit(options.admission.maxResultRows);
+        scheduler = std::make_unique<TaskScheduler>(options.scheduler);
+        database_instance->setTaskScheduler(scheduler.get());
+        std::cout << "[INIT] Task scheduler: " << scheduler->threadCount() << " worker thread(s)";
+        if (options.scheduler.pinThreads) {
+            std::cout << ", pinned across " << scheduler->stats().numaNodes << " NUMA node(s)";
+        }
+        std::cout << std::endl;
+        default_statement_timeout = std::chrono::milliseconds(options.statement_timeout_ms);
+        session_memory_limit = options.session_memory_limit;
+        query_memory_limit = options.query_memory_limit;
+        parse_cache = std::make_unique<NET::ParseCache>(options.parse_cache_entries);
+        session_manager = std::make_unique<SessionManager>(std::chrono::seconds(options.session_timeout_sec));
+        options.admission.maxQueryBytes = options.query_memory_limit;
+        admission = std::make_unique<AdmissionController>(options.admission);
+        
+        slow_query_log = std::make_unique<SlowQueryLog>(options.slow_query_log);
+        if (slow_query_log->enabled()) {
+            std::cout << "[INIT] Slow query log: " << options.slow_query_log.path
+                      << " (threshold " << options.slow_query_log.thresholdMicros << " us)" << std::endl;
+        }
+        
+        trace_dir = options.trace_dir;
+        if (options.trace) {
+            Tracer::instance().setEnabled(true, options.trace_buffer_spans);
+            std::cout << "[INIT] Tracing enabled (" << options.trace_buffer_spans
+                      << " spans per thread, export dir: " << trace_dir << ")" << std::endl;
+        }
+        
         // 启动网络服务器
         NET::SocketServer server;
-        auto start_result = server.start("127.0.0.1", 4399);
-        if (!start_result.has_value()) {
-            std::cerr << "[ERROR] Failed to start server!" << std::endl;
-            return 1;
+        server.setIdleTimeout(std::chrono::seconds(options.idle_timeout_sec));
+        server.setListenBacklog(options.listen_backlog);
+        if (options.tcp) {
+            auto start_result = server.start("127.0.0.1", 4399);
+            if (!start_result.has_value()) {
+                std::cerr << "[ERROR] Failed to start server!" << std::endl;
+                return 1;
+            }
+            std::cout << "[INFO] Server started successfully on 127.0.0.1:4399" << std::endl;
+        }
+        
+        if (!options.unix_socket.empty()) {
+            auto start_result = server.startUnix(options.unix_socket);
+            if (!start_result.has_value()) {
+                std::cerr << "[ERROR] Failed to listen on unix socket: " << options.unix_socket << std::endl;
+                return 1;
+            }
+            unix_peer_auth = options.unix_peer_auth;
+            std::cout << "[INFO] Listening on unix socket " << options.unix_socket
+                      << (unix_peer_auth ? " (peer credential auth enabled)" : "")
+                      << (options.shared_memory ? " (shared memory transport enabled)" : "") << std::endl;
         }
         
-        std::cout << "[INFO] Server started successfully on 127.0.0.1:8080" << std::endl;
         std::cout << "[INFO] Waiting for client connections..." << std::endl;
         
-        // 主服务循环
-        while (true) {
-            auto client_result = server.acceptClient();
-            if (!client_result.has_value()) {
-                continue;
-            }
-            
-            int client_fd = client_result.value();
-            std::cout << "\n[CONNECTION] Client connected: " << client_fd << std::endl;
-            
-            // 处理客户端消息
-            while (true) {
-                auto msg_result = server.receiveMessage(client_fd);
-                if (!msg_result.has_value()) {
-                    std::cout << "[CONNECTION] Client disconnected" << std::endl;
-                    break;
-                }
-                
-                auto message = std::move(msg_result.value());
-                
-                switch (message->getType()) {
-                    case NET::MessageType::LOGIN_REQUEST: {
-                        auto* login_req = dynamic_cast<NET::LoginRequest*>(message.get());
-                        handleLogin(server, client_fd, *login_req);
-                        break;
-                    }
-                    
-                    case NET::MessageType::QUERY_REQUEST: {
-                        auto* query_req = dynamic_cast<NET::QueryRequest*>(message.get());
-                        handleQuery(server, client_fd, *query_req);
-                        break;
-                    }
-                    
-                    default:
-                        std::cout << "[ERROR] Unsupported message type" << std::endl;
-                        NET::ErrorResponse response("Unsupported message type", 400);
-                        server.sendMessage(client_fd, response);
-                        break;
-                }
-            }
-            
-            server.disconnectClient(client_fd);
+        allow_shared_memory = options.shared_memory;
+        if (options.idle_timeout_sec > 0) {
+            idle_timeout = std::chrono::seconds(options.idle_timeout_sec);
+        }
+        event_loop = std::make_unique<NET::EventLoop>();
+        io_executor = std::make_unique<NET::Executor>(1);
+        engine_lock = std::make_unique<NET::AsyncMutex>(*event_loop);
+        
+        // 主服务循环：每个监听套接字一个接受协程，连接和请求都在事件循环上并发处理
+        for (int listen_fd : server.listeningSockets()) {
+            NET::spawn(acceptConnections(server, listen_fd));
         }
+        event_loop->run();
         
     } catch (const DatabaseException& e) {
         std::cerr << "[ERROR] Database exception: " << e.what() << std::endl;
@@ -109,15 +242,126 @@ int main() {
 
 // ========== Tool Functions ==========
 
-// 简单的token生成
-std::string generateSimpleToken() {
-    static int counter = 1000;
-    return "token_" + std::to_string(++counter);
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --slow-query-ms N         Log statements slower than N ms (0 logs all)\n"
+              << "  --slow-query-log PATH     Slow query log file (default: slow_query.log)\n"
+              << "  --slow-query-log-size MB  Rotate the log after MB megabytes (default: 64)\n"
+              << "  --slow-query-log-files N  Number of rotated files to keep (default: 5)\n"
+              << "  --trace                   Record per-request pipeline spans\n"
+              << "  --trace-buffer N          Spans kept per thread (default: 65536)\n"
+              << "  --trace-dir DIR           Directory for SHOW TRACE exports (default: .)\n"
+              << "  --memory-limit MB         Reject allocations beyond MB for the whole server\n"
+              << "  --table-memory-limit MB   Per-table data limit\n"
+              << "  --session-memory-limit MB Per-session limit for in-flight query memory\n"
+              << "  --query-memory-limit MB   Per-query limit for intermediate results\n"
+              << "  --unix-socket PATH        Also listen on a unix domain socket at PATH\n"
+              << "  --unix-peer-auth          Log in unix socket peers running as the server's uid\n"
+              << "                            (or root) without a password\n"
+              << "  --shm                     Let unix socket clients switch to a shared memory\n"
+              << "                            ring transport\n"
+              << "  --no-tcp                  Do not listen on 127.0.0.1:4399\n"
+              << "  --idle-timeout SEC        Close connections idle for SEC seconds (default: 120,\n"
+              << "                            0 disables)\n"
+              << "  --statement-timeout MS    Cancel statements running longer than MS ms (default: 0,\n"
+              << "                            off); sessions can override it with SET statement_timeout\n"
+              << "  --session-timeout SEC     Expire sessions idle for SEC seconds (default: 3600,\n"
+              << "                            0 disables)\n"
+              << "  --parse-cache N           Cache the parsed form of N distinct SQL text statements\n"
+              << "                            (default: 256, 0 disables)\n"
+              << "  --listen-backlog N        Kernel accept queue length (default: 128)\n"
+              << "  --max-connections N       Reject new connections beyond N open ones (default: 1024)\n"
+              << "  --max-queued-requests N   Queries allowed to wait for the storage engine; later ones\n"
+              << "                            are rejected at once (default: 1024)\n"
+              << "  --queue-timeout MS        Reject queries that waited longer than MS ms for the\n"
+              << "                            storage engine (default: 30000, 0 disables)\n"
+              << "  --max-result-rows N       Reject SELECTs returning more than N rows (default: 0, off)\n"
+              << "  --worker-threads N        Scheduler threads running statements and parallel\n"
+              << "                            scans and sorts (default: number of CPUs)\n"
+              << "  --pin-threads             Pin scheduler threads to CPUs, grouped by NUMA node\n";
 }
 
-// 验证token
-bool validateToken(const std::string& token) {
-    return is_logged_in && token == current_token;
+// 解析命令行参数
+bool parseServerOptions(int argc, char* argv[], ServerOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = (i + 1 < argc);
+        try {
+            if (arg == "--slow-query-ms" && has_value) {
+                options.slow_query_log.thresholdMicros = std::stoll(argv[++i]) * 1000;
+            } else if (arg == "--slow-query-log" && has_value) {
+                options.slow_query_log.path = argv[++i];
+            } else if (arg == "--slow-query-log-size" && has_value) {
+                options.slow_query_log.maxFileBytes = std::stoull(argv[++i]) * 1024 * 1024;
+            } else if (arg == "--slow-query-log-files" && has_value) {
+                options.slow_query_log.maxFiles = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--trace") {
+                options.trace = true;
+            } else if (arg == "--trace-buffer" && has_value) {
+                options.trace_buffer_spans = std::stoull(argv[++i]);
+            } else if (arg == "--trace-dir" && has_value) {
+                options.trace_dir = argv[++i];
+            } else if (arg == "--unix-socket" && has_value) {
+                options.unix_socket = argv[++i];
+            } else if (arg == "--unix-peer-auth") {
+                options.unix_peer_auth = true;
+            } else if (arg == "--shm") {
+                options.shared_memory = true;
+            } else if (arg == "--no-tcp") {
+                options.tcp = false;
+            } else if (arg == "--idle-timeout" && has_value) {
+                options.idle_timeout_sec = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--statement-timeout" && has_value) {
+                options.statement_timeout_ms = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--session-timeout" && has_value) {
+                options.session_timeout_sec = static_cast<unsigned>(std::stoul(argv[++i]));
+            } else if (arg == "--parse-cache" && has_value) {
+                options.parse_cache_entries = std::stoull(argv[++i]);
+            } else if (arg == "--listen-backlog" && has_value) {
+                options.listen_backlog = std::stoi(argv[++i]);
+            } else if (arg == "--max-connections" && has_value) {
+                options.admission.maxConnections = std::stoull(argv[++i]);
+            } else if (arg == "--max-queued-requests" && has_value) {
+                options.admission.maxQueuedRequests = std::stoull(argv[++i]);
+            } else if (arg == "--queue-timeout" && has_value) {
+                options.admission.queueTimeout = std::chrono::milliseconds(std::stoull(argv[++i]));
+            } else if (arg == "--max-result-rows" && has_value) {
+                options.admission.maxResultRows = std::stoull(argv[++i]);
+            } else if (arg == "--worker-threads" && has_value) {
+                options.scheduler.threads = std::stoull(argv[++i]);
+            } else if (arg == "--pin-threads") {
+                options.scheduler.pinThreads = true;
+            } else if (arg == "--memory-limit" && has_value) {
+                options.memory_limit = std::stoull(argv[++i]) * 1024 * 1024;
+            } else if (arg == "--table-memory-limit" && has_value) {
+                options.table_memory_limit = std::stoull(argv[++i]) * 1024 * 1024;
+            } else if (arg == "--session-memory-limit" && has_value) {
+                options.session_memory_limit = std::stoull(argv[++i]) * 1024 * 1024;
+            } else if (arg == "--query-memory-limit" && has_value) {
+                options.query_memory_limit = std::stoull(argv[++i]) * 1024 * 1024;
+            } else {
+                printUsage(argv[0]);
+                return false;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "[ERROR] Invalid value for " << arg << std::endl;
+            return false;
+        }
+    }
+    if (!options.tcp && options.unix_socket.empty()) {
+        std::cerr << "[ERROR] --no-tcp requires --unix-socket" << std::endl;
+        return false;
+    }
+    if (options.shared_memory && options.unix_socket.empty()) {
+        std::cerr << "[ERROR] --shm requires --unix-socket" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// 验证token：返回令牌对应的会话，令牌无效、已过期或属于其他连接时返回空指针
+std::shared_ptr<Session> validateToken(const std::string& token, uint64_t connection_id) {
+    return session_manager->find(token, connection_id);
 }
 
 // 数据类型转换函数
@@ -141,12 +385,333 @@ NET::DataType convertToNetworkDataType(DataType db_type) {
     }
 }
 
-// 执行查询的核心函数
-NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
-    if (!database_instance) {
-        return NET::QueryResponse("Database not initialized");
+// 操作类型名称（用于统计）
+std::string operationName(NET::OperationType op) {
+    switch (op) {
+        case NET::OperationType::CREATE_DATABASE: return "CREATE_DATABASE";
+        case NET::OperationType::DROP_DATABASE: return "DROP_DATABASE";
+        case NET::OperationType::USE_DATABASE: return "USE_DATABASE";
+        case NET::OperationType::CREATE_TABLE: return "CREATE_TABLE";
+        case NET::OperationType::DROP_TABLE: return "DROP_TABLE";
+        case NET::OperationType::INSERT: return "INSERT";
+        case NET::OperationType::SELECT: return "SELECT";
+        case NET::OperationType::UPDATE: return "UPDATE";
+        case NET::OperationType::DELETE: return "DELETE";
+        case NET::OperationType::SHOW_STATS: return "SHOW_STATS";
+        case NET::OperationType::SHOW_TRACE: return "SHOW_TRACE";
+        case NET::OperationType::SHOW_MEMORY: return "SHOW_MEMORY";
+        case NET::OperationType::SHOW_ADMISSION: return "SHOW_ADMISSION";
+        case NET::OperationType::SET_OPTION: return "SET";
+        default: return "UNKNOWN";
+    }
+}
+
+// 将单个条件翻译为存储层的条件字符串，值统一加引号
+std::string formatCondition(const NET::WhereCondition& where) {
+    if (where.operator_str == "BETWEEN" && where.values.size() == 2) {
+        return where.column + " BETWEEN " + RowFilter::quote(where.values[0].value) +
+               " AND " + RowFilter::quote(where.values[1].value);
+    }
+    if (where.operator_str == "IN") {
+        std::string condition = where.column + " IN (";
+        for (size_t i = 0; i < where.values.size(); ++i) {
+            condition += (i > 0 ? ", " : "") + RowFilter::quote(where.values[i].value);
+        }
+        return condition + ")";
+    }
+    return where.column + " " + where.operator_str + " " + RowFilter::quote(where.value.value);
+}
+
+// 优先级从低到高：OR、AND、NOT、单个条件
+int precedence(NET::WhereExpression::Kind kind) {
+    using Kind = NET::WhereExpression::Kind;
+    switch (kind) {
+        case Kind::OR: return 0;
+        case Kind::AND: return 1;
+        case Kind::NOT: return 2;
+        case Kind::CONDITION: return 3;
+    }
+    return 3;
+}
+
+// 只给优先级低于父节点的操作数加括号，使存储层看到的嵌套层数不超过客户端写出的层数
+std::string formatExpression(const NET::WhereExpression& expression) {
+    using Kind = NET::WhereExpression::Kind;
+    if (expression.kind == Kind::CONDITION) {
+        return formatCondition(expression.condition);
+    }
+    auto operand = [&](const NET::WhereExpression& child) {
+        std::string text = formatExpression(child);
+        return precedence(child.kind) < precedence(expression.kind) ? "(" + text + ")" : text;
+    };
+    if (expression.kind == Kind::NOT) {
+        return "NOT " + operand(expression.children.front());
+    }
+    const char* separator = expression.kind == Kind::AND ? " AND " : " OR ";
+    std::string text;
+    for (size_t i = 0; i < expression.children.size(); ++i) {
+        text += (i > 0 ? separator : "") + operand(expression.children[i]);
+    }
+    return text;
+}
+
+// 将结构化WHERE条件翻译为存储层使用的条件字符串
+std::string buildWhereClause(const NET::QueryRequest& request) {
+    if (!request.getWhereExpression().has_value()) {
+        return "";
     }
+    return formatExpression(request.getWhereExpression().value());
+}
+
+// 将结构化请求还原为近似的SQL文本（用于慢查询日志）
+std::string describeRequest(const NET::QueryRequest& request) {
+    std::ostringstream oss;
+    const std::string where = buildWhereClause(request);
+    
+    switch (request.getOperation()) {
+        case NET::OperationType::CREATE_DATABASE:
+            oss << "CREATE DATABASE " << request.getDatabaseName();
+            break;
+        case NET::OperationType::DROP_DATABASE:
+            oss << "DROP DATABASE " << request.getDatabaseName();
+            break;
+        case NET::OperationType::USE_DATABASE:
+            oss << "USE " << request.getDatabaseName();
+            break;
+        case NET::OperationType::CREATE_TABLE:
+            oss << "CREATE TABLE " << request.getTableName() << " (" << request.getColumns().size() << " columns)";
+            break;
+        case NET::OperationType::DROP_TABLE:
+            oss << "DROP TABLE " << request.getTableName();
+            break;
+        case NET::OperationType::INSERT: {
+            oss << "INSERT INTO " << request.getTableName() << " VALUES (";
+            const auto& values = request.getInsertValues();
+            for (size_t i = 0; i < values.size(); ++i) {
+                oss << (i ? ", " : "") << "'" << values[i].value << "'";
+            }
+            oss << ")";
+            break;
+        }
+        case NET::OperationType::SELECT: {
+            oss << "SELECT ";
+            const auto& columns = request.getSelectColumns();
+            if (columns.empty()) {
+                oss << "*";
+            }
+            for (size_t i = 0; i < columns.size(); ++i) {
+                oss << (i ? ", " : "") << columns[i];
+            }
+            oss << " FROM " << request.getTableName();
+            break;
+        }
+        case NET::OperationType::UPDATE: {
+            oss << "UPDATE " << request.getTableName() << " SET ";
+            const auto& clauses = request.getUpdateClauses();
+            for (size_t i = 0; i < clauses.size(); ++i) {
+                oss << (i ? ", " : "") << clauses[i].column << " = '" << clauses[i].value.value << "'";
+            }
+            break;
+        }
+        case NET::OperationType::DELETE:
+            oss << "DELETE FROM " << request.getTableName();
+            break;
+        case NET::OperationType::SET_OPTION: {
+            oss << "SET";
+            const auto& clauses = request.getUpdateClauses();
+            for (size_t i = 0; i < clauses.size(); ++i) {
+                oss << (i ? ", " : " ") << clauses[i].column << " = " << clauses[i].value.value;
+            }
+            break;
+        }
+        default:
+            oss << operationName(request.getOperation());
+            break;
+    }
+    
+    if (!where.empty()) {
+        oss << " WHERE " << where;
+    }
+    
+    // 日志按行存储，转义换行和引号
+    std::string text;
+    for (char c : oss.str()) {
+        if (c == '\n') {
+            text += "\\n";
+        } else if (c == '"') {
+            text += "\\\"";
+        } else {
+            text += c;
+        }
+    }
+    return text;
+}
+
+// 格式化微秒数，保留两位小数
+std::string formatMicros(double micros) {
+    std::ostringstream oss;
+    oss << std::fixed << std::setprecision(2) << micros;
+    return oss.str();
+}
+
+// SHOW STATS：每个（操作, 表）组合输出各阶段的延迟分布，计数器列在 total 行给出
+NET::QueryResponse buildStatsResponse() {
+    std::vector<std::string> columns = {
+        "operation", "table", "stage", "count", "mean_us", "p50_us", "p90_us", "p99_us", "max_us",
+        "rows_scanned", "rows_returned", "bytes_sent"
+    };
+    
+    std::vector<NET::QueryResponse::Row> rows;
+    for (const auto& entry : server_stats.snapshot()) {
+        for (size_t i = 0; i < QUERY_STAGE_COUNT; ++i) {
+            const auto stage = static_cast<QueryStage>(i);
+            const auto& summary = entry.stages[i];
+            const bool is_total = (stage == QueryStage::TOTAL);
+            
+            NET::QueryResponse::Row row;
+            row.columns = {
+                entry.operation,
+                entry.table.empty() ? "-" : entry.table,
+                queryStageName(stage),
+                std::to_string(summary.count),
+                formatMicros(summary.meanMicros),
+                formatMicros(summary.p50Micros),
+                formatMicros(summary.p90Micros),
+                formatMicros(summary.p99Micros),
+                formatMicros(summary.maxMicros),
+                is_total ? std::to_string(entry.rowsScanned) : "",
+                is_total ? std::to_string(entry.rowsReturned) : "",
+                is_total ? std::to_string(entry.bytesSent) : ""
+            };
+            rows.push_back(std::move(row));
+        }
+    }
+    
+    return NET::QueryResponse(columns, rows);
+}
+
+// SHOW TRACE：把当前各线程环形缓冲区中的 span 导出为 Chrome trace-event JSON 文件
+NET::QueryResponse buildTraceResponse() {
+    if (!Tracer::instance().enabled()) {
+        return NET::QueryResponse("Tracing is disabled (start the server with --trace)");
+    }
+    
+    auto epoch_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::filesystem::path path = std::filesystem::path(trace_dir) /
+                                 ("sdsql-trace-" + std::to_string(epoch_ms) + ".json");
+    
+    size_t span_count = 0;
+    if (!Tracer::instance().exportChromeJson(path.string(), span_count)) {
+        return NET::QueryResponse("Failed to write trace file: " + path.string());
+    }
+    std::cout << "[TRACE] Exported " << span_count << " span(s) to " << path.string() << std::endl;
+    
+    std::vector<std::string> columns = {"path", "spans", "threads"};
+    std::vector<NET::QueryResponse::Row> rows;
+    NET::QueryResponse::Row row;
+    row.columns = {path.string(), std::to_string(span_count),
+                   std::to_string(Tracer::instance().threadCount())};
+    rows.push_back(row);
     
+    return NET::QueryResponse(columns, rows);
+}
+
+// SHOW MEMORY：服务器、各表、当前会话和上一条查询的内存用量
+NET::QueryResponse buildMemoryResponse() {
+    std::vector<std::string> columns = {
+        "scope", "name", "bytes_in_use", "peak_bytes", "allocations", "limit_bytes"
+    };
+    
+    std::vector<NET::QueryResponse::Row> rows;
+    auto add_row = [&rows](const std::string& scope, const MemoryUsage& usage) {
+        NET::QueryResponse::Row row;
+        row.columns = {
+            scope, usage.name,
+            std::to_string(usage.bytesInUse),
+            std::to_string(usage.peakBytes),
+            std::to_string(usage.allocations),
+            usage.limitBytes ? std::to_string(usage.limitBytes) : "unlimited"
+        };
+        rows.push_back(std::move(row));
+    };
+    
+    add_row("server", database_instance->getMemoryRoot().usage());
+    for (const auto& usage : database_instance->getTableMemoryUsage()) {
+        add_row("table", usage);
+    }
+    if (current_session && current_session->memory) {
+        add_row("session", current_session->memory->usage());
+    }
+    
+    MemoryUsage last_query;
+    last_query.name = "previous";
+    last_query.peakBytes = last_query_peak_bytes;
+    last_query.limitBytes = query_memory_limit;
+    add_row("query", last_query);
+    
+    return NET::QueryResponse(columns, rows);
+}
+
+// SHOW ADMISSION：连接数、请求队列的深度、准入计数和排队时间
+NET::QueryResponse buildAdmissionResponse() {
+    const AdmissionStats stats = admission->stats();
+    const AdmissionConfig& config = admission->config();
+    
+    std::vector<std::string> columns = {"metric", "value"};
+    std::vector<NET::QueryResponse::Row> rows;
+    auto add_row = [&rows](const std::string& metric, const std::string& value) {
+        NET::QueryResponse::Row row;
+        row.columns = {metric, value};
+        rows.push_back(std::move(row));
+    };
+    auto limit = [](uint64_t value) { return value ? std::to_string(value) : "unlimited"; };
+    
+    add_row("active_connections", std::to_string(stats.activeConnections));
+    add_row("peak_connections", std::to_string(stats.peakConnections));
+    add_row("max_connections", std::to_string(config.maxConnections));
+    add_row("admitted_connections", std::to_string(stats.admittedConnections));
+    add_row("rejected_connections", std::to_string(stats.rejectedConnections));
+    add_row("queued_requests", std::to_string(stats.queuedRequests));
+    add_row("peak_queued_requests", std::to_string(stats.peakQueuedRequests));
+    add_row("max_queued_requests", std::to_string(config.maxQueuedRequests));
+    add_row("rejected_queue_full", std::to_string(stats.rejectedQueueFull));
+    add_row("expired_requests", std::to_string(stats.expiredRequests));
+    add_row("request_wait_p50_us", formatMicros(stats.requestWait.p50Micros));
+    add_row("request_wait_p99_us", formatMicros(stats.requestWait.p99Micros));
+    add_row("request_wait_max_us", formatMicros(stats.requestWait.maxMicros));
+    add_row("queue_timeout_ms", limit(static_cast<uint64_t>(config.queueTimeout.count())));
+    add_row("max_result_rows", limit(config.maxResultRows));
+    add_row("max_query_bytes", limit(config.maxQueryBytes));
+    add_row("rejected_by_estimate", std::to_string(stats.rejectedByEstimate));
+    add_row("aborted_over_budget", std::to_string(stats.abortedOverBudget));
+    
+    return NET::QueryResponse(columns, rows);
+}
+
+// SET：会话级设置，目前只有 statement_timeout（毫秒，0 表示不限制），重新登录后恢复默认值
+NET::QueryResponse applySessionOption(const NET::QueryRequest& request) {
+    for (const auto& clause : request.getUpdateClauses()) {
+        std::string name = clause.column;
+        std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+        if (name != "statement_timeout") {
+            return NET::QueryResponse("Unknown setting: " + clause.column);
+        }
+        
+        const std::string& value = clause.value.value;
+        uint64_t millis = 0;
+        auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(), millis);
+        if (ec != std::errc() || end != value.data() + value.size()) {
+            return NET::QueryResponse("Invalid value for statement_timeout: " + value);
+        }
+        current_session->statementTimeout = std::chrono::milliseconds(millis);
+        std::cout << "[SESSION] statement_timeout = " << millis << " ms" << std::endl;
+    }
+    return NET::QueryResponse({}, {});
+}
+
+// 根据操作类型分派到 DDL/DML 接口
+NET::QueryResponse dispatchQuery(const NET::QueryRequest& request, const std::string& where_clause) {
     try {
         DDLOperations& ddl_ops = database_instance->getDDLOperations();
         DMLOperations& dml_ops = database_instance->getDMLOperations();
@@ -165,6 +730,12 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
             case NET::OperationType::DROP_DATABASE: {
                 bool success = ddl_ops.dropDatabase(request.getDatabaseName());
                 if (success) {
+                    if (active_database == request.getDatabaseName()) {
+                        active_database.clear();
+                    }
+                    if (current_session->database == request.getDatabaseName()) {
+                        current_session->database.clear();
+                    }
                     std::cout << "[DDL] Dropped database: " << request.getDatabaseName() << std::endl;
                     return NET::QueryResponse({}, {});
                 } else {
@@ -175,6 +746,7 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
             case NET::OperationType::USE_DATABASE: {
                 bool success = ddl_ops.useDatabase(request.getDatabaseName());
                 if (success) {
+                    active_database = current_session->database = request.getDatabaseName();
                     std::cout << "[DDL] Using database: " << request.getDatabaseName() << std::endl;
                     return NET::QueryResponse({}, {});
                 } else {
@@ -217,7 +789,11 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
                     values.push_back(insert_values[i].value);
                 }
                 
-                int affected_rows = dml_ops.insert(request.getTableName(), values);
+                int affected_rows = 0;
+                {
+                    TraceScope span("dml_execute");
+                    affected_rows = dml_ops.insert(request.getTableName(), values);
+                }
                 if (affected_rows > 0) {
                     std::cout << "[DML] Inserted " << affected_rows << " row(s) into " << request.getTableName() << std::endl;
                     
@@ -235,17 +811,16 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
             }
             
             case NET::OperationType::SELECT: {
-                std::string where_clause = "";
-                if (request.getWhereCondition().has_value()) {
-                    const auto& where = request.getWhereCondition().value();
-                    where_clause = where.column + " " + where.operator_str + " '" + where.value.value + "'";
+                std::unique_ptr<QueryResult> result;
+                {
+                    TraceScope span("dml_execute");
+                    result = dml_ops.select(request.getTableName(), where_clause);
                 }
-                
-                auto result = dml_ops.select(request.getTableName(), where_clause);
                 if (result && result->getRowCount() > 0) {
                     std::cout << "[DML] Selected " << result->getRowCount() << " row(s) from " << request.getTableName() << std::endl;
                     
                     // 构建响应
+                    TraceScope span("build_response");
                     std::vector<std::string> columns;
                     for (int i = 0; i < result->getColumnCount(); ++i) {
                         columns.push_back(result->getColumnName(i));
@@ -272,13 +847,11 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
                     updates[set_clause.column] = set_clause.value.value;
                 }
                 
-                std::string where_clause = "";
-                if (request.getWhereCondition().has_value()) {
-                    const auto& where = request.getWhereCondition().value();
-                    where_clause = where.column + " " + where.operator_str + " '" + where.value.value + "'";
+                int affected_rows = 0;
+                {
+                    TraceScope span("dml_execute");
+                    affected_rows = dml_ops.update(request.getTableName(), updates, where_clause);
                 }
-                
-                int affected_rows = dml_ops.update(request.getTableName(), updates, where_clause);
                 std::cout << "[DML] Updated " << affected_rows << " row(s) in " << request.getTableName() << std::endl;
                 
                 // 返回受影响行数
@@ -292,13 +865,11 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
             }
             
             case NET::OperationType::DELETE: {
-                std::string where_clause = "";
-                if (request.getWhereCondition().has_value()) {
-                    const auto& where = request.getWhereCondition().value();
-                    where_clause = where.column + " " + where.operator_str + " '" + where.value.value + "'";
+                int affected_rows = 0;
+                {
+                    TraceScope span("dml_execute");
+                    affected_rows = dml_ops.remove(request.getTableName(), where_clause);
                 }
-                
-                int affected_rows = dml_ops.remove(request.getTableName(), where_clause);
                 std::cout << "[DML] Deleted " << affected_rows << " row(s) from " << request.getTableName() << std::endl;
                 
                 // 返回受影响行数
@@ -311,53 +882,537 @@ NET::QueryResponse executeQuery(const NET::QueryRequest& request) {
                 return NET::QueryResponse(columns, rows);
             }
             
+            case NET::OperationType::SHOW_STATS:
+                return buildStatsResponse();
+            
+            case NET::OperationType::SHOW_TRACE:
+                return buildTraceResponse();
+            
+            case NET::OperationType::SHOW_MEMORY:
+                return buildMemoryResponse();
+            
+            case NET::OperationType::SHOW_ADMISSION:
+                return buildAdmissionResponse();
+            
+            case NET::OperationType::SET_OPTION:
+                return applySessionOption(request);
+            
             default:
                 return NET::QueryResponse("Unsupported operation type");
         }
         
+    } catch (const ResultLimitExceeded& e) {
+        admission->recordBudgetAbort();
+        std::cerr << "[ADMISSION] Query rejected: " << e.what() << std::endl;
+        return NET::QueryResponse("Query rejected: " + std::string(e.what()));
     } catch (const DatabaseException& e) {
         std::cerr << "[ERROR] Database exception: " << e.what() << std::endl;
         return NET::QueryResponse("Database error: " + std::string(e.what()));
+    } catch (const QueryCancelled& e) {
+        // 扫描在批边界中止，UPDATE/DELETE 不会留下部分修改
+        std::cout << "[CANCEL] " << e.what() << std::endl;
+        return NET::QueryResponse("Query canceled: " + std::string(e.what()));
+    } catch (const MemoryLimitExceeded& e) {
+        admission->recordBudgetAbort();
+        std::cerr << "[MEMORY] Query rejected: " << e.what() << std::endl;
+        return NET::QueryResponse("Query rejected: " + std::string(e.what()));
     } catch (const std::exception& e) {
         std::cerr << "[ERROR] General exception: " << e.what() << std::endl;
         return NET::QueryResponse("Internal error: " + std::string(e.what()));
     }
 }
 
-// 处理登录请求
-void handleLogin(NET::SocketServer& server, int client_fd, const NET::LoginRequest& request) {
-    std::cout << "[LOGIN] User: " << request.getUsername() << std::endl;
+// 执行查询的核心函数
+NET::QueryResponse executeQuery(const NET::QueryRequest& request, QueryTimings& timings) {
+    if (!database_instance) {
+        return NET::QueryResponse("Database not initialized");
+    }
     
-    if (request.getUsername() == USERNAME && request.getPassword() == PASSWORD) {
-        current_token = generateSimpleToken();
-        is_logged_in = true;
-        
-        std::cout << "[LOGIN] Success, Token: " << current_token << std::endl;
-        NET::LoginSuccess response(current_token, 1001);
-        server.sendMessage(client_fd, response);
+    std::string where_clause;
+    {
+        StageTimer timer(timings, QueryStage::PLAN);
+        where_clause = buildWhereClause(request);
+    }
+    
+    // 存储引擎只有一个 USE 上下文，另一个会话切换过数据库时先切回本会话的数据库；
+    // 切换只是换入换出内存中的表，不会从磁盘重新加载而丢掉未写回的修改
+    if (!current_session->database.empty() && current_session->database != active_database) {
+        if (database_instance->getDDLOperations().useDatabase(current_session->database)) {
+            active_database = current_session->database;
+        } else {
+            current_session->database.clear();  // 已被其他会话删除
+        }
+    }
+    
+    // 执行前估算：不带 WHERE 的 SELECT 返回整张表，超出行数或内存预算时不必开始扫描；
+    // 带条件的查询在执行期间由行数上限和查询内存上限中止
+    if (request.getOperation() == NET::OperationType::SELECT && where_clause.empty()) {
+        if (auto table = database_instance->getTableStatistics(request.getTableName())) {
+            if (auto reason = admission->checkEstimate({table->rowCount, table->bytesInUse})) {
+                std::cout << "[ADMISSION] Query rejected: " << reason.value() << std::endl;
+                return NET::QueryResponse("Query rejected: " + reason.value());
+            }
+        }
+    }
+    
+    // 每条查询的中间结果单独统计，并计入所属会话
+    TrackingMemoryResource query_memory("query", current_session->memory.get(), query_memory_limit);
+    database_instance->setQueryMemoryResource(&query_memory);
+    
+    uint64_t scanned_before = database_instance->getRowsScanned();
+    NET::QueryResponse response;
+    {
+        TraceScope span("dispatch");
+        StageTimer timer(timings, QueryStage::EXECUTE);
+        response = dispatchQuery(request, where_clause);
+    }
+    database_instance->setQueryMemoryResource(nullptr);
+    last_query_peak_bytes = query_memory.peakBytes();
+    timings.rowsScanned = database_instance->getRowsScanned() - scanned_before;
+    timings.rowsReturned = response.getRows().size();
+    
+    return response;
+}
+
+// 向连接发送一帧；共享内存连接在它的收发线程上写入环形缓冲区
+NET::Task<bool> sendFrame(Connection& conn, std::span<const std::byte> frame) {
+    std::expected<void, SocketError> sent;
+    if (conn.shm) {
+        sent = co_await conn.shm_io->run(*event_loop, [&] { return conn.shm->send(frame); });
     } else {
+        sent = co_await NET::writeAll(*event_loop, conn.fd, frame);
+    }
+    co_return sent.has_value();
+}
+
+NET::Task<bool> sendMessage(Connection& conn, const NET::Message& message) {
+    std::vector<std::byte> frame = message.serialize();
+    co_return co_await sendFrame(conn, frame);
+}
+
+// 序列化并发送响应，分别计入 SERIALIZE 和 SEND 阶段
+NET::Task<bool> sendResponse(Connection& conn, const NET::Message& response, QueryTimings& timings) {
+    std::vector<std::byte> frame;
+    {
+        TraceScope span("serialize");
+        StageTimer timer(timings, QueryStage::SERIALIZE);
+        frame = response.serialize();
+    }
+    timings.bytesSent += frame.size();
+    
+    StageTimer timer(timings, QueryStage::SEND);
+    co_return co_await sendFrame(conn, frame);
+}
+
+// 处理登录请求，返回要发送的响应
+std::unique_ptr<NET::Message> handleLogin(Connection& conn, const NET::LoginRequest& request) {
+    std::cout << "[LOGIN] User: " << request.getUsername() << std::endl;
+    
+    // Unix 域连接：对端进程与服务器同一用户（或 root）时免密码
+    bool peer_trusted = false;
+    if (unix_peer_auth) {
+        auto cred = conn.server.getPeerCredentials(conn.fd);
+        if (cred.has_value() && (cred->uid == geteuid() || cred->uid == 0)) {
+            std::cout << "[LOGIN] Peer credentials accepted: pid " << cred->pid
+                      << ", uid " << cred->uid << std::endl;
+            peer_trusted = true;
+        }
+    }
+    
+    if (!peer_trusted && (request.getUsername() != USERNAME || request.getPassword() != PASSWORD)) {
         std::cout << "[LOGIN] Failed: Invalid credentials" << std::endl;
-        NET::LoginFailure response("Invalid username or password");
-        server.sendMessage(client_fd, response);
+        return std::make_unique<NET::LoginFailure>("Invalid username or password");
     }
+    
+    auto session = session_manager->create(request.getUsername(), conn.id);
+    conn.tokens.push_back(session->token);
+    session->statementTimeout = default_statement_timeout;
+    
+    // 协商协议版本和能力位，旧版客户端回退到版本 1 的格式
+    session->protocolVersion = std::min(request.getProtocolVersion(), NET::PROTOCOL_VERSION);
+    session->capabilities = session->protocolVersion > NET::PROTOCOL_VERSION_LEGACY
+        ? request.getCapabilities() & NET::SUPPORTED_CAPABILITIES
+        : 0;
+    session->memory = std::make_unique<TrackingMemoryResource>(
+        "session:" + std::to_string(session->id), &database_instance->getMemoryRoot(), session_memory_limit);
+    
+    std::cout << "[LOGIN] Success, session " << session->id << " (" << session_manager->size()
+              << " active), protocol v" << session->protocolVersion
+              << ", capabilities 0x" << std::hex << session->capabilities << std::dec << std::endl;
+    auto response = std::make_unique<NET::LoginSuccess>(session->token, 1001);
+    response->setProtocol(session->protocolVersion, session->capabilities);
+    return response;
 }
 
-// 处理结构化查询请求
-void handleQuery(NET::SocketServer& server, int client_fd, const NET::QueryRequest& request) {
+// 语句执行以高优先级提交，持有存储引擎的语句不排在 SQL 文本的解析等普通任务之后
+struct StatementPool {
+    TaskScheduler& scheduler;
+    void submit(std::function<void()> fn) { scheduler.submit(std::move(fn), TaskPriority::HIGH); }
+};
+
+// 处理结构化查询请求：等存储引擎空闲后在工作线程上执行，
+// 等待和执行期间其他连接以及本连接上的 CANCEL 照常处理
+NET::Task<bool> handleQuery(Connection& conn, const NET::QueryRequest& request, QueryTimings& timings,
+                            AdmissionController::Clock::time_point arrived_at) {
     std::cout << "[QUERY] Operation: " << static_cast<int>(request.getOperation()) << std::endl;
     
-    if (!validateToken(request.getSessionToken())) {
+    std::shared_ptr<Session> session;
+    {
+        TraceScope span("validate_token");
+        session = validateToken(request.getSessionToken(), conn.id);
+    }
+    if (!session) {
         std::cout << "[QUERY] Token validation failed" << std::endl;
         NET::ErrorResponse response("Invalid or expired token", 401);
-        server.sendMessage(client_fd, response);
-        return;
+        co_return co_await sendMessage(conn, response);
     }
     
     std::cout << "[QUERY] Token validation successful" << std::endl;
     
-    // 执行查询
-    NET::QueryResponse response = executeQuery(request);
-    server.sendMessage(client_fd, response);
+    // 排队等待存储引擎：队列已满或排队超时的请求不执行，直接回复繁忙
+    if (!admission->enqueueRequest()) {
+        std::cout << "[ADMISSION] Request queue is full, rejected" << std::endl;
+        NET::ErrorResponse response("Server busy: request queue is full", 503);
+        co_return co_await sendMessage(conn, response);
+    }
+    // 排队最多等到 queue timeout：等不到存储引擎的请求到期即回复繁忙，不必等前面的语句执行完
+    auto engine = co_await engine_lock->lockUntil(admission->queueDeadline(arrived_at));
+    if (!admission->admitRequest(arrived_at) || !engine.ownsLock()) {
+        std::cout << "[ADMISSION] Request timed out in the queue, not executed" << std::endl;
+        engine.unlock();
+        NET::ErrorResponse response("Server busy: request timed out in the queue", 503);
+        co_return co_await sendMessage(conn, response);
+    }
+    // 解析或排队期间客户端发送了 CANCEL：与执行中被取消的语句回复相同，不再执行
+    if (conn.cancel_requested) {
+        engine.unlock();
+        QueryCancelled cancelled(QueryCancelled::Reason::USER_REQUEST);
+        std::cout << "[CANCEL] " << cancelled.what() << " before execution, not executed" << std::endl;
+        NET::QueryResponse response("Query canceled: " + std::string(cancelled.what()));
+        co_return co_await sendMessage(conn, response);
+    }
+    // 排队期间客户端已断开，结果无人接收，不必再执行
+    if (conn.closed) {
+        co_return false;
+    }
+    
+    // 在公开 running_* 之前开始计时并清除取消标记：此后到达的 CANCEL 或断开
+    // 即使发生在工作线程开始执行之前，也不会被 start() 清掉
+    query_interrupt.start(session->statementTimeout);
+    running_session_id = session->id;
+    running_connection_id = conn.id;
+    StatementPool statement_pool{*scheduler};
+    NET::QueryResponse response = co_await NET::runOn(statement_pool, *event_loop, [&] {
+        current_session = session;
+        return executeQuery(request, timings);
+    });
+    running_session_id = 0;
+    running_connection_id = 0;
+    engine.unlock();
+    
+    bool sent = co_await sendResponse(conn, response, timings);
+    server_stats.record(operationName(request.getOperation()), request.getTableName(), timings);
+    
+    if (slow_query_log && slow_query_log->isSlow(timings.totalNanos())) {
+        slow_query_log->submit({std::chrono::system_clock::now(), "session:" + std::to_string(session->id),
+                                describeRequest(request), timings});
+    }
     
     std::cout << "[QUERY] Response sent" << std::endl;
+    co_return sent;
+}
+
+// 处理 SQL 文本请求：解析（优先查缓存）为结构化请求后按 QUERY_REQUEST 执行
+NET::Task<bool> handleSqlText(Connection& conn, const NET::SqlTextRequest& request, QueryTimings& timings,
+                              AdmissionController::Clock::time_point arrived_at) {
+    std::cout << "[SQL] " << request.getSql() << std::endl;
+    
+    if (!validateToken(request.getSessionToken(), conn.id)) {
+        std::cout << "[SQL] Token validation failed" << std::endl;
+        NET::ErrorResponse response("Invalid or expired token", 401);
+        co_return co_await sendMessage(conn, response);
+    }
+    
+    // 解析缓存不是线程安全的，在事件循环线程上查找和写入；未命中的语句（包括从不缓存的
+    // 批量 INSERT）在调度器上解析，长语句的词法和语法分析不会阻塞其他连接的 I/O
+    std::expected<std::shared_ptr<const NET::QueryRequest>, std::string> parsed;
+    bool cache_hit = false;
+    {
+        StageTimer timer(timings, QueryStage::PARSE);
+        if (auto cached = parse_cache->lookup(request.getSql())) {
+            parsed = std::move(cached);
+            cache_hit = true;
+        } else {
+            parsed = co_await NET::runOn(*scheduler, *event_loop, [&] {
+                TraceScope span("parse_sql");
+                return NET::ParseCache::parseUncached(request.getSql());
+            });
+            if (parsed.has_value()) {
+                parse_cache->insert(request.getSql(), parsed.value());
+            }
+        }
+    }
+    if (!parsed.has_value()) {
+        std::cout << "[SQL] Parse failed: " << parsed.error() << std::endl;
+        NET::QueryResponse response(parsed.error());
+        co_return co_await sendResponse(conn, response, timings);
+    }
+    std::cout << (cache_hit ? "[SQL] Parse cache hit" : "[SQL] Parsed")
+              << std::endl;
+    
+    NET::QueryRequest query_request = *parsed.value();
+    query_request.setSessionToken(request.getSessionToken());
+    co_return co_await handleQuery(conn, query_request, timings, arrived_at);
+}
+
+// 共享内存升级：随后的 memfd 经 SCM_RIGHTS 到达，握手是阻塞的收发，放到 I/O 线程上执行；
+// 握手期间读协程暂停读取。握手失败时套接字上的数据已不同步，只能断开
+NET::Task<bool> upgradeToSharedMemory(Connection& conn) {
+    int flags = fcntl(conn.fd, F_GETFL);
+    fcntl(conn.fd, F_SETFL, flags & ~O_NONBLOCK);
+    auto attach_result = co_await io_executor->run(*event_loop, [&] {
+        return conn.server.attachSharedMemory(conn.fd, allow_shared_memory);
+    });
+    fcntl(conn.fd, F_SETFL, flags);
+    
+    bool ok = attach_result.has_value();
+    if (!ok) {
+        std::cout << "[CONNECTION] Shared memory handshake failed, closing connection" << std::endl;
+    } else if (attach_result.value()) {
+        // 环形缓冲区无法由 epoll 等待，阻塞的收发交给连接自己的两个线程
+        conn.shm = std::move(attach_result.value());
+        conn.shm_io = std::make_unique<NET::Executor>(2);
+        std::cout << "[CONNECTION] Switched to shared memory transport" << std::endl;
+    } else {
+        std::cout << "[CONNECTION] Shared memory request rejected" << std::endl;
+    }
+    conn.handshake_done.set();
+    co_return ok;
+}
+
+// 处理一条客户端请求，返回 false 表示需要断开连接
+NET::Task<bool> handleMessage(Connection& conn, PendingRequest& pending) {
+    const NET::Message& message = *pending.message;
+    switch (message.getType()) {
+        case NET::MessageType::SHM_ATTACH_REQUEST:
+            co_return co_await upgradeToSharedMemory(conn);
+        
+        case NET::MessageType::LOGIN_REQUEST: {
+            auto* login_req = dynamic_cast<const NET::LoginRequest*>(&message);
+            auto response = handleLogin(conn, *login_req);
+            co_return co_await sendMessage(conn, *response);
+        }
+        
+        case NET::MessageType::QUERY_REQUEST: {
+            auto* query_req = dynamic_cast<const NET::QueryRequest*>(&message);
+            co_return co_await handleQuery(conn, *query_req, pending.timings, pending.arrivedAt);
+        }
+        
+        case NET::MessageType::SQL_TEXT_REQUEST: {
+            auto* sql_req = dynamic_cast<const NET::SqlTextRequest*>(&message);
+            co_return co_await handleSqlText(conn, *sql_req, pending.timings, pending.arrivedAt);
+        }
+        
+        // 心跳无需登录，也不打印日志；回显客户端时间戳并附上服务端时间（微秒）
+        case NET::MessageType::PING_REQUEST: {
+            auto* ping = dynamic_cast<const NET::PingRequest*>(&message);
+            NET::PongResponse response(ping->getTimestamp(), NET::currentTimestampMicros());
+            co_return co_await sendMessage(conn, response);
+        }
+        
+        default: {
+            std::cout << "[ERROR] Unsupported message type" << std::endl;
+            NET::ErrorResponse response("Unsupported message type", 400);
+            co_return co_await sendMessage(conn, response);
+        }
+    }
+}
+
+// CANCEL 在到达时由读协程立即处理，只作用于本连接正在处理的请求：
+// 已开始执行的语句在下一个批边界中止，还在解析或排队的语句轮到时不再执行
+void handleCancel(Connection& conn, const NET::CancelRequest& request) {
+    auto session = validateToken(request.getSessionToken(), conn.id);
+    if (!session) {
+        std::cout << "[CANCEL] Invalid token, ignored" << std::endl;
+    } else if (session->id == running_session_id) {
+        std::cout << "[CANCEL] Cancel requested for the running statement" << std::endl;
+        query_interrupt.cancel();
+    } else if (conn.busy) {
+        std::cout << "[CANCEL] Cancel requested for the pending statement" << std::endl;
+        conn.cancel_requested = true;
+    } else {
+        std::cout << "[CANCEL] No statement running, ignored" << std::endl;
+    }
+}
+
+// 接收一条请求的完整帧（头部 + 载荷），载荷的接收计入 RECEIVE 阶段。
+// 等待下一条请求的时间不计入任何阶段；本连接的请求还在处理时客户端在等待响应，不算空闲
+NET::Task<std::expected<std::vector<std::byte>, SocketError>> receiveRequest(Connection& conn, QueryTimings& timings) {
+    constexpr size_t HEADER_SIZE = NET::MessageHeader::HEADER_SIZE;
+    std::vector<std::byte> frame(HEADER_SIZE);
+    std::expected<void, SocketError> received;
+    
+    if (conn.shm) {
+        do {
+            received = co_await conn.shm_io->run(*event_loop, [&] { return conn.shm->receive(frame.data(), HEADER_SIZE); });
+        } while (!received.has_value() && received.error() == SocketError::TIMEOUT &&
+                 (conn.busy || !conn.inbox.empty()));
+    } else {
+        while (!co_await event_loop->readable(conn.fd, idle_timeout)) {
+            if (!conn.busy && conn.inbox.empty()) {
+                co_return std::unexpected(SocketError::TIMEOUT);
+            }
+        }
+        received = co_await NET::readExact(*event_loop, conn.fd, frame.data(), HEADER_SIZE);
+    }
+    if (!received.has_value()) {
+        co_return std::unexpected(received.error());
+    }
+    
+    uint32_t payload_size;
+    {
+        NET::Deserializer deserializer(frame);
+        auto header = NET::MessageHeader::deserialize(deserializer);
+        if (!header.has_value()) {
+            co_return std::unexpected(SocketError::RECV_FAILED);
+        }
+        payload_size = header->getPayloadSize();
+    }
+    
+    StageTimer timer(timings, QueryStage::RECEIVE);
+    frame.resize(HEADER_SIZE + payload_size);
+    std::byte* payload = frame.data() + HEADER_SIZE;
+    if (conn.shm) {
+        received = co_await conn.shm_io->run(*event_loop, [&] { return conn.shm->receive(payload, payload_size); });
+    } else {
+        received = co_await NET::readExact(*event_loop, conn.fd, payload, payload_size, idle_timeout);
+    }
+    if (!received.has_value()) {
+        co_return std::unexpected(received.error());
+    }
+    co_return frame;
+}
+
+// 读协程：按顺序读出连接上的请求交给处理协程，预读的请求达到上限时暂停读取
+NET::Task<void> readRequests(std::shared_ptr<Connection> conn) {
+    while (true) {
+        if (conn->inbox.size() >= MAX_INBOX_REQUESTS) {
+            co_await conn->inbox_space.wait();
+            continue;
+        }
+        
+        PendingRequest pending;
+        auto frame_result = co_await receiveRequest(*conn, pending.timings);
+        if (!frame_result.has_value()) {
+            // 客户端心跳间隔小于空闲超时，超时说明客户端已失联
+            if (frame_result.error() == SocketError::TIMEOUT) {
+                std::cout << "[CONNECTION] Connection " << conn->id << " idle for "
+                          << std::chrono::duration_cast<std::chrono::seconds>(idle_timeout).count()
+                          << "s, closing connection" << std::endl;
+            } else {
+                std::cout << "[CONNECTION] Client disconnected (connection " << conn->id << ")" << std::endl;
+            }
+            break;
+        }
+        pending.arrivedAt = AdmissionController::Clock::now();
+        
+        std::expected<std::unique_ptr<NET::Message>, NET::ProtocolError> msg_result;
+        {
+            TraceScope span("deserialize");
+            StageTimer timer(pending.timings, QueryStage::PARSE);
+            msg_result = NET::Message::deserialize(frame_result.value());
+        }
+        if (!msg_result.has_value()) {
+            std::cout << "[CONNECTION] Malformed message, closing connection" << std::endl;
+            break;
+        }
+        
+        auto type = msg_result.value()->getType();
+        if (type == NET::MessageType::CANCEL_REQUEST) {
+            handleCancel(*conn, dynamic_cast<const NET::CancelRequest&>(*msg_result.value()));
+            continue;
+        }
+        
+        pending.message = std::move(msg_result.value());
+        conn->inbox.push_back(std::move(pending));
+        conn->inbox_ready.set();
+        
+        // 升级握手的后续数据由处理协程读取，完成后再继续
+        if (type == NET::MessageType::SHM_ATTACH_REQUEST) {
+            co_await conn->handshake_done.wait();
+        }
+    }
+    
+    conn->closed = true;
+    // 客户端已断开，正在执行的语句结果无人接收，不必再执行
+    if (running_connection_id == conn->id) {
+        query_interrupt.cancel();
+    }
+    conn->inbox_ready.set();
+}
+
+// 处理协程：按到达顺序逐条处理请求，同一连接上的响应与请求顺序一致
+NET::Task<void> processRequests(std::shared_ptr<Connection> conn) {
+    while (!conn->closed) {
+        if (conn->inbox.empty()) {
+            co_await conn->inbox_ready.wait();
+            continue;
+        }
+        
+        PendingRequest pending = std::move(conn->inbox.front());
+        conn->inbox.pop_front();
+        conn->inbox_space.set();
+        
+        conn->busy = true;
+        bool keep_open = co_await handleMessage(*conn, pending);
+        conn->busy = false;
+        conn->cancel_requested = false;
+        if (!keep_open) {
+            break;
+        }
+    }
+    
+    // 由处理协程决定断开时，关闭套接字唤醒仍在等待数据的读协程
+    if (!conn->closed) {
+        shutdown(conn->fd, SHUT_RDWR);
+    }
+    conn->inbox_space.set();
+    conn->handshake_done.set();
+}
+
+// 拒绝一个连接：回复繁忙（503）后关闭
+void rejectConnection(NET::SocketServer& server, int client_fd, const std::string& reason) {
+    std::cout << "[ADMISSION] Connection rejected: " << reason << std::endl;
+    NET::ErrorResponse response("Server busy: " + reason, 503);
+    server.rejectClient(client_fd, response);
+}
+
+// 接受协程：监听套接字可读时接受所有已到达的连接，每个连接启动一对读/处理协程
+NET::Task<void> acceptConnections(NET::SocketServer& server, int listen_fd) {
+    while (true) {
+        co_await event_loop->readable(listen_fd);
+        while (true) {
+            std::expected<int, SocketError> client_result;
+            {
+                TraceScope span("accept");
+                client_result = server.tryAcceptClient();
+            }
+            if (!client_result.has_value()) {
+                break;
+            }
+            
+            int client_fd = client_result.value();
+            if (!admission->admitConnection()) {
+                rejectConnection(server, client_fd, "too many connections");
+                continue;
+            }
+            fcntl(client_fd, F_SETFL, fcntl(client_fd, F_GETFL) | O_NONBLOCK);
+            
+            auto conn = std::make_shared<Connection>(server, client_fd, ++next_connection_id);
+            std::cout << "\n[CONNECTION] Client connected: " << client_fd << " (connection " << conn->id << ", "
+                      << admission->stats().activeConnections << " open)" << std::endl;
+            NET::spawn(processRequests(conn));
+            NET::spawn(readRequests(conn));
+        }
+    }
 }
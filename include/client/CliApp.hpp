@@ -2,11 +2,36 @@
 #define CLI_APP_HPP
 
 #include "Parser.hpp"
+#include "ResultRenderer.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <iosfwd>
 #include <string>
+#include <thread>
 
 #include "../network/socket_client.hpp"
 #include "../network/query.hpp"
 
+// 连接参数
+struct ConnectionOptions {
+    std::string server_ip = "127.0.0.1";
+    uint16_t server_port = 4399;
+    std::string unix_socket;  // 非空时通过 Unix 域套接字连接，忽略 ip/port
+    bool peer_auth = false;   // 先尝试以进程身份免密码登录（需服务端开启 --unix-peer-auth）
+    bool shared_memory = false; // 连接后升级为共享内存传输（需服务端开启 --shm）
+    std::chrono::seconds keepalive_interval{30}; // 空闲时的心跳间隔，需小于服务端 --idle-timeout；0 表示关闭
+    std::string username;     // 非空时直接用它和 password 登录，不再交互输入
+    std::string password;
+};
+
+// 批处理模式（-f）参数
+struct ScriptOptions {
+    std::string path;
+    OutputFormat format = OutputFormat::TABLE;
+    size_t pipeline_depth = 64;  // 已发送但未收到响应的语句上限，1 表示逐条等待
+};
+
 class CliApp {
 private:
     //当前数据库的上下文 
@@ -17,19 +42,31 @@ private:
     std::string password;
     // 登录状态  
     bool logged_in = false;
+    // 批处理模式：登录提示等状态信息写到 stderr，stdout 只留查询结果
+    bool batch_mode = false;
+    // 结果集输出格式，交互模式下可用 \a 在 TABLE 和 UNALIGNED 之间切换
+    OutputFormat output_format = OutputFormat::TABLE;
 
-    std::string server_ip = "127.0.0.1";
-    short server_port = 4399;
+    ConnectionOptions connection;
 
     // 网络相关
     NET::SocketClient client;
     NET::NetworkQueryExecutor query_executor;
     std::string session_token;
 
+    // Ctrl-C：语句执行中时请求服务端取消，否则退出
+    std::thread interrupt_thread;
+    std::atomic<bool> statement_running{false};
+    std::atomic<bool> interrupt_stop{false};
+    void start_interrupt_handler();
+    void stop_interrupt_handler();
+
     void execute(const std::string& line);
 
     bool login(const std::string& username, const std::string& password);
+    bool authenticate();
     void logout();
+    std::ostream& status_stream();
 
     void main_loop(int logged_in);
 
@@ -46,6 +83,14 @@ private:
     void handle_update(const UpdateCommand& cmd);
     void handle_delete(const DeleteCommand& cmd);
 
+    // Admin Handlers
+    void handle_show_stats(const ShowStatsCommand& cmd);
+    void handle_show_trace(const ShowTraceCommand& cmd);
+    void handle_show_memory(const ShowMemoryCommand& cmd);
+    void handle_show_admission(const ShowAdmissionCommand& cmd);
+    void handle_set_option(const SetOptionCommand& cmd);
+    void handle_ping();
+
     
     // 辅助方法
     bool executeQuery(const NET::QueryRequest& request);
@@ -53,7 +98,15 @@ private:
 
 public:
     CliApp() : query_executor(client) {}
+    explicit CliApp(ConnectionOptions options)
+        : connection(std::move(options)), query_executor(client) {}
+
+    void set_output_format(OutputFormat format) { output_format = format; }
 
     void run();
+
+    // 批处理：执行脚本中的语句（每行一条，忽略空行和 -- 注释），流水线发送，
+    // 结束时输出总耗时和每秒语句数。全部成功返回 0
+    int run_script(const ScriptOptions& options);
 };
 #endif // CLI_APP_HPP
\ No newline at end of file
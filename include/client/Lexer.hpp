@@ -2,22 +2,22 @@
 #define LEXER_HPP
 
 #include "Token.hpp"
-#include <string>
+#include <string_view>
 #include <vector>
 
+// 词法分析器：词元的 value 直接指向输入，不做拷贝
+// 输入必须在词元（以及由它们构造的 Parser）使用期间保持有效
 class Lexer {
 public:
-    explicit Lexer(const std::string& input);
+    explicit Lexer(std::string_view input);
     std::vector<Token> tokenize();
 
 private:
     Token next_token();
-    char peek();
-    char advance();
     void skip_whitespace();
 
-    std::string input_;
+    std::string_view input_;
     size_t position_ = 0;
 };
 
-#endif // LEXER_HPP
\ No newline at end of file
+#endif // LEXER_HPP
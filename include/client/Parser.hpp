@@ -15,9 +15,22 @@ struct Command { virtual ~Command() = default; };
 // 字面量
 struct LiteralValue { TokenType type; std::string value; };
 
-// WHERE 子句
-struct Condition { std::string column; std::string op; LiteralValue value; };
-using WhereClause = Condition;
+// WHERE 中的单个谓词：column op value（op 也可以是 "LIKE" / "ILIKE"），或 op 为 "IN" / "BETWEEN" 时使用 values
+struct Condition {
+    std::string column;
+    std::string op;
+    LiteralValue value;
+    std::vector<LiteralValue> values; // IN 的值列表，或 BETWEEN 的下界和上界
+};
+
+// WHERE 子句的表达式树：叶子为单个谓词，AND / OR 有两个以上子节点，NOT 有一个
+struct WhereExpr {
+    enum class Kind { CONDITION, AND, OR, NOT };
+    Kind kind = Kind::CONDITION;
+    Condition condition;             // 仅 CONDITION
+    std::vector<WhereExpr> children; // AND / OR / NOT 的操作数
+};
+using WhereClause = WhereExpr;
 
 // DDL 命令
 struct CreateDatabaseCommand : public Command { std::string db_name; };
@@ -46,6 +59,15 @@ struct SelectCommand : public Command {
     std::optional<WhereClause> where_clause;
 };
 
+// 管理命令
+struct ShowStatsCommand : public Command {};
+struct ShowTraceCommand : public Command {};
+struct ShowMemoryCommand : public Command {};
+struct ShowAdmissionCommand : public Command {};
+
+// 会话设置，如 SET statement_timeout = 5000
+struct SetOptionCommand : public Command { std::string name; LiteralValue value; };
+
 // --- 语法分析器 ---
 class Parser {
 public:
@@ -60,13 +82,21 @@ private:
     std::unique_ptr<Command> parse_delete();
     std::unique_ptr<Command> parse_update();
     std::unique_ptr<Command> parse_select();
+    std::unique_ptr<Command> parse_show();
+    std::unique_ptr<Command> parse_set();
     
     std::optional<WhereClause> parse_optional_where();
+    WhereExpr parse_or_expr();
+    WhereExpr parse_and_expr();
+    WhereExpr parse_not_expr();
+    WhereExpr parse_condition();
+    LiteralValue parse_literal();
 
     const Token& consume(TokenType expected);
     const Token& peek(int offset = 0);
     std::vector<Token> tokens_;
     size_t position_ = 0;
+    int where_depth_ = 0;  // WHERE 中括号和 NOT 的嵌套层数
 };
 
 #endif // PARSER_HPP
\ No newline at end of file
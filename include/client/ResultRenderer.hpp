@@ -0,0 +1,97 @@
+#ifndef RESULT_RENDERER_HPP
+#define RESULT_RENDERER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../network/protocol.hpp"
+
+// 结果集输出格式
+enum class OutputFormat {
+    TABLE,      // 带边框的对齐表格
+    UNALIGNED,  // 列之间以 | 分隔、不补空格，适合管道和分页器
+    TSV,        // 制表符分隔，首行为列名，单元格转义，不输出行数
+    QUIET       // 不输出结果集（批处理模式只报告错误）
+};
+
+/**
+ * @brief 流式结果输出
+ * 依次调用 begin()、若干次 addRows()、end()。每批行到达后立即写出并刷新，
+ * 不需要先拿到整个结果集，输出百万行时首屏也能马上出现。
+ */
+class ResultRenderer {
+public:
+    using Row = NET::QueryResponse::Row;
+
+    virtual ~ResultRenderer() = default;
+
+    virtual void begin(const std::vector<std::string>& columns) = 0;
+    virtual void addRows(std::span<const Row> rows) = 0;
+    virtual void end() = 0;
+
+    // QUIET 返回空指针
+    static std::unique_ptr<ResultRenderer> create(OutputFormat format, std::ostream& out);
+};
+
+/**
+ * @brief 对齐表格
+ * 列宽由列名和前 sample_rows 行决定：样本攒够（或结果结束）时输出表头和样本，
+ * 之后的行到达即输出。样本之后出现更宽的值时该列从这一行起加宽，已输出的行不再重排。
+ */
+class TableRenderer : public ResultRenderer {
+public:
+    static constexpr size_t DEFAULT_SAMPLE_ROWS = 1000;
+    static constexpr size_t MIN_COLUMN_WIDTH = 8;
+
+    explicit TableRenderer(std::ostream& out, size_t sample_rows = DEFAULT_SAMPLE_ROWS);
+
+    void begin(const std::vector<std::string>& columns) override;
+    void addRows(std::span<const Row> rows) override;
+    void end() override;
+
+private:
+    void printHeader();
+    void printRow(const std::vector<std::string>& cells);
+    void printBorder();
+
+    std::ostream& out;
+    size_t sample_rows;
+    std::vector<std::string> columns;
+    std::vector<size_t> widths;
+    std::vector<Row> sample;   // 表头输出前缓存的样本行
+    bool header_printed = false;
+    uint64_t row_count = 0;
+    std::string line;          // 复用的行缓冲，每行一次写出
+};
+
+/**
+ * @brief 分隔符输出（UNALIGNED / TSV）
+ * 不计算列宽，每行直接写出，内存占用与结果集大小无关。
+ */
+class DelimitedRenderer : public ResultRenderer {
+public:
+    // escape: 把单元格中的 \、制表符和换行写成转义序列；footer: 结尾输出行数
+    DelimitedRenderer(std::ostream& out, char separator, bool escape, bool footer);
+
+    void begin(const std::vector<std::string>& columns) override;
+    void addRows(std::span<const Row> rows) override;
+    void end() override;
+
+private:
+    void appendField(const std::string& value);
+
+    std::ostream& out;
+    char separator;
+    bool escape;
+    bool footer;
+    size_t column_count = 0;
+    uint64_t row_count = 0;
+    std::string line;
+};
+
+#endif // RESULT_RENDERER_HPP
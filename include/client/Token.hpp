@@ -2,6 +2,7 @@
 #define TOKEN_HPP
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 
@@ -15,6 +16,11 @@ enum class TokenType {
     KEYWORD_SELECT, KEYWORD_FROM, KEYWORD_WHERE,
     KEYWORD_UPDATE, KEYWORD_SET,
     KEYWORD_DELETE,
+    KEYWORD_IN, KEYWORD_BETWEEN, KEYWORD_AND, KEYWORD_OR, KEYWORD_NOT,
+    KEYWORD_LIKE, KEYWORD_ILIKE,
+
+    // Keywords for administration
+    KEYWORD_SHOW, KEYWORD_STATS, KEYWORD_TRACE, KEYWORD_MEMORY, KEYWORD_ADMISSION,
     
     // Data Types
     KEYWORD_INT, KEYWORD_STRING,
@@ -29,7 +35,7 @@ enum class TokenType {
     PAREN_CLOSE,        // )
     COMMA,              // ,
     SEMICOLON,          // ;
-    OPERATOR,           // =, >, <
+    OPERATOR,           // =, >, <, >=, <=, !=, <>
     ASTERISK,           // *
 
     // Control
@@ -40,9 +46,10 @@ enum class TokenType {
 // 用于调试时打印 TokenType
 std::string to_string(TokenType type);
 
+// value 指向 Lexer 的输入（字符串字面量不含引号），关键字保留原始大小写
 struct Token {
     TokenType type;
-    std::string value;
+    std::string_view value;
 };
 
 #endif // TOKEN_HPP
\ No newline at end of file
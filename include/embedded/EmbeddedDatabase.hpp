@@ -0,0 +1,82 @@
+#ifndef EMBEDDED_DATABASE_HPP
+#define EMBEDDED_DATABASE_HPP
+
+#include "../server/DatabaseAPI.hpp"
+#include <chrono>
+#include <memory>
+#include <string>
+
+/**
+ * @brief 一条语句的执行结果。
+ */
+struct StatementResult {
+  bool success = true;  // 语句是否执行成功
+  std::string message;  // 失败原因（成功时为空）
+  int affectedRows = 0; // INSERT/UPDATE/DELETE 影响的行数
+  std::unique_ptr<QueryResult> rows; // SELECT 的结果集，其他语句为空
+};
+
+/**
+ * @brief 进程内嵌入式数据库接口。
+ * 直接调用存储引擎执行 SQL，不经过网络、序列化和 NET::QueryResponse，
+ * 适合与数据库同机运行的批处理程序。语法与命令行客户端一致。
+ *
+ * 用法：
+ * @code
+ *   EmbeddedDatabase db("./db_root");
+ *   db.execute("use test");
+ *   auto result = db.execute("select * from users where id > 10");
+ *   while (result.rows && result.rows->next()) {
+ *     int id = result.rows->getInt(0);
+ *   }
+ * @endcode
+ *
+ * @note 非线程安全，同一实例只应由一个线程使用（cancel() 除外）。
+ */
+class EmbeddedDatabase {
+public:
+  /**
+   * @brief 打开（必要时创建）数据库根目录。
+   * @param rootPath 数据库存储的根目录。
+   */
+  explicit EmbeddedDatabase(const std::string &rootPath);
+  ~EmbeddedDatabase();
+
+  EmbeddedDatabase(const EmbeddedDatabase &) = delete;
+  EmbeddedDatabase &operator=(const EmbeddedDatabase &) = delete;
+
+  /**
+   * @brief 解析并执行一条 SQL 语句。
+   * @note SELECT 的结果集引用表的元数据，遍历结束前不要删除该表或切换数据库。
+   * @param sql SQL 语句，末尾的分号可选。
+   * @return 执行结果；DDL 失败、主键重复等情况以 success = false 返回。
+   * @throws SyntaxException 语句无法解析时抛出。
+   * @throws DatabaseException 表不存在等执行错误时抛出。
+   * @throws QueryCancelled 语句被 cancel() 取消或超过 statement_timeout 时抛出。
+   */
+  StatementResult execute(const std::string &sql);
+
+  /**
+   * @brief 取消正在执行的语句，可以从其他线程调用。
+   * @note 语句在下一个批边界中止，execute() 抛出 QueryCancelled，不留下部分修改。
+   */
+  void cancel();
+
+  /**
+   * @brief 设置语句的最长执行时间，超时的语句以 QueryCancelled 中止。
+   * @note 等价于执行 SET statement_timeout = <毫秒>。
+   * @param timeout 0 表示不限制（默认）。
+   */
+  void setStatementTimeout(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief 获取底层的 Database，可直接调用 DDL/DML 接口。
+   */
+  Database &getDatabase();
+
+private:
+  class Impl;
+  std::unique_ptr<Impl> pImpl;
+};
+
+#endif // EMBEDDED_DATABASE_HPP
@@ -0,0 +1,106 @@
+/**
+* @brief 异步客户端
+*
+* 后台 I/O 线程在非阻塞套接字上用 poll 同时收发，调用线程只负责序列化请求并放入发送队列，
+* 结果通过 std::future 或完成回调返回。一条连接上可以同时有任意多个未完成的请求。
+*
+* 服务端在一条连接上按到达顺序逐个处理请求并按同样的顺序回复，协议中没有请求 ID，
+* 因此响应按 FIFO 与请求对应。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <expected>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "protocol.hpp"
+#include "query.hpp"
+#include "socket_utils.hpp"
+
+namespace NET {
+
+class AsyncClient {
+public:
+    using MessageResult = std::expected<std::unique_ptr<Message>, SocketError>;
+    using QueryResult = std::expected<std::unique_ptr<QueryResponse>, SocketError>;
+    using MessageCallback = std::function<void(MessageResult)>;
+    using QueryCallback = std::function<void(QueryResult)>;
+
+    AsyncClient();
+    ~AsyncClient();
+
+    AsyncClient(const AsyncClient&) = delete;
+    AsyncClient& operator=(const AsyncClient&) = delete;
+
+    // 建立连接并启动 I/O 线程
+    std::expected<void, SocketError> connect(const std::string& ip, uint16_t port);
+    std::expected<void, SocketError> connectUnix(const std::string& path);
+
+    // 停止 I/O 线程并关闭连接，未完成的请求以 CONNECTION_CLOSED 结束
+    void disconnect();
+
+    bool isConnected() const;
+
+    // 登录并保存会话 token，之后的查询自动带上（阻塞直到收到响应）
+    // 返回 false 表示用户名或密码错误
+    std::expected<bool, SocketError> login(const std::string& username, const std::string& password);
+
+    void setSessionToken(const std::string& token);
+
+    // 登录时与服务端协商的能力位
+    bool hasCapability(Capability capability) const;
+
+    // 发送任意消息，响应到达时在 I/O 线程中调用回调
+    // 回调不应阻塞，也不能调用 disconnect()
+    void sendAsync(const Message& message, MessageCallback callback);
+
+    // 异步执行查询；服务端返回错误响应或连接断开时结果为错误
+    std::future<QueryResult> executeAsync(const QueryRequest& request);
+    void executeAsync(const QueryRequest& request, QueryCallback callback);
+
+    // 异步执行 SQL 文本，由服务端解析（需要 CAP_SQL_TEXT，否则结果为 UNSUPPORTED）
+    std::future<QueryResult> executeSqlAsync(const std::string& sql);
+    void executeSqlAsync(const std::string& sql, QueryCallback callback);
+
+    // 请求取消服务端正在执行的语句，被取消的请求以错误的 QueryResponse 完成
+    // CANCEL 没有响应，不占用 FIFO 中的位置；排在后面尚未开始执行的请求不受影响
+    // 未连接或服务端不支持 CANCEL 时返回 false
+    bool cancel();
+
+    // 已发送（或排队）但尚未收到响应的请求数
+    size_t pendingCount() const;
+
+private:
+    std::expected<void, SocketError> start(int fd);
+    void ioLoop();
+    bool flushOutput();
+    bool readInput();
+    void failPending(SocketError error);
+    void wakeIoThread();
+
+    int socket_fd = -1;
+    int wake_fd = -1;  // eventfd，有新请求或需要停止时唤醒 I/O 线程
+    std::thread io_thread;
+
+    mutable std::mutex mutex;
+    bool running = false;
+    std::string session_token;
+    uint32_t capabilities = 0;
+    std::vector<std::byte> queued_output;    // 调用线程追加的已序列化请求
+    std::deque<MessageCallback> pending;     // 按发送顺序等待响应的回调
+
+    // 以下只由 I/O 线程访问
+    std::vector<std::byte> writing;
+    size_t write_offset = 0;
+    std::vector<std::byte> input;
+};
+
+} // namespace NET
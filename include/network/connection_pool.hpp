@@ -0,0 +1,126 @@
+/**
+* @brief 客户端连接池
+*
+* 维护一组已登录的连接，借出时省去建连和 LOGIN 往返。线程安全。
+*  - 后台线程按 min_connections 预热连接，关闭空闲超过 idle_timeout 的多余连接，
+*    并对空闲超过 health_check_interval 的连接发送 PING 检查，失效的连接直接丢弃；
+*  - 借出空闲过久的连接前同样先 PING；
+*  - 连接达到 max_connections 时 acquire() 等待归还，超过 acquire_timeout 返回 TIMEOUT；
+*  - executeQuery() 在连接断开时换一条连接重试：请求未能发出时总是重试，
+*    已发出但未收到响应时只重试只读语句（SELECT / SHOW），避免写操作被执行两次。
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "query.hpp"
+#include "socket_client.hpp"
+#include "socket_utils.hpp"
+
+namespace NET {
+
+struct ConnectionPoolOptions {
+    std::string server_ip = "127.0.0.1";
+    uint16_t server_port = 4399;
+    std::string unix_socket;  // 非空时通过 Unix 域套接字连接，忽略 ip/port
+    std::string username;
+    std::string password;
+
+    size_t min_connections = 1;
+    size_t max_connections = 8;
+    std::chrono::milliseconds idle_timeout{60000};           // 多于 min 的空闲连接在此之后关闭
+    std::chrono::milliseconds health_check_interval{5000};   // 空闲超过该时长的连接需先 PING
+    std::chrono::milliseconds acquire_timeout{5000};         // 等待可用连接的上限
+    std::chrono::milliseconds io_timeout{5000};              // 建连后登录、PING、查询的收发超时
+    int max_retries = 2;                                     // executeQuery 换连接重试的次数
+};
+
+struct ConnectionPoolStats {
+    size_t open = 0;                     // 当前连接数（空闲 + 借出）
+    size_t idle = 0;
+    size_t in_use = 0;
+    uint64_t created = 0;                // 累计建立的连接
+    uint64_t closed = 0;                 // 累计关闭的连接（空闲超时、失效等）
+    uint64_t health_check_failures = 0;  // PING 失败的次数
+    uint64_t retries = 0;                // executeQuery 的重试次数
+};
+
+class ConnectionPool {
+private:
+    struct Connection {
+        SocketClient client;
+        NetworkQueryExecutor executor{client};
+        std::chrono::steady_clock::time_point last_used;     // 最近一次归还
+        std::chrono::steady_clock::time_point last_checked;  // 最近一次确认可用（使用或 PING）
+    };
+
+public:
+    // 借出的连接，析构时归还连接池
+    class Lease {
+    public:
+        Lease() = default;
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        ~Lease();
+
+        SocketClient& client() { return connection->client; }
+        NetworkQueryExecutor& executor() { return connection->executor; }
+
+        // 连接出错后调用，归还时直接关闭而不放回池中
+        void markBroken() { broken = true; }
+
+    private:
+        friend class ConnectionPool;
+        Lease(ConnectionPool* owner, std::unique_ptr<Connection> conn)
+            : pool(owner), connection(std::move(conn)) {}
+        void release();
+
+        ConnectionPool* pool = nullptr;
+        std::unique_ptr<Connection> connection;
+        bool broken = false;
+    };
+
+    explicit ConnectionPool(ConnectionPoolOptions options);
+    ~ConnectionPool();
+
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    // 借出一条可用的已登录连接
+    std::expected<Lease, SocketError> acquire();
+
+    // 借出连接执行一次查询并归还，连接断开时按上述规则重试
+    std::expected<std::unique_ptr<QueryResponse>, SocketError> executeQuery(const QueryRequest& request);
+
+    ConnectionPoolStats getStats() const;
+
+private:
+    std::expected<std::unique_ptr<Connection>, SocketError> openConnection();
+    bool ping(Connection& connection);
+    void release(std::unique_ptr<Connection> connection, bool broken);
+    void maintenanceLoop();
+    void maintain();
+
+    ConnectionPoolOptions options;
+
+    mutable std::mutex mutex;
+    std::condition_variable available;    // 有连接归还或名额释放
+    std::condition_variable stop_signal;
+    std::vector<std::unique_ptr<Connection>> idle;  // 末尾是最近归还的连接
+    size_t open_count = 0;                // 空闲 + 借出 + 正在建立/检查的连接
+    bool stopping = false;
+    ConnectionPoolStats stats;
+
+    std::thread maintenance_thread;
+};
+
+} // namespace NET
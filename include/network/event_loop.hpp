@@ -0,0 +1,352 @@
+/**
+* @brief 基于 epoll 的单线程事件循环和协程等待原语
+*
+* EventLoop 在一个线程上运行，所有协程都在这个线程上恢复：
+*  - readable() / writable() 挂起直到描述符可读/可写，可以带超时；
+*  - sleepFor() 挂起指定时长；
+*  - post() 可以从任意线程调用，把协程交回事件循环线程恢复。
+* AsyncMutex 和 AsyncEvent 只能在事件循环线程上使用，等待时挂起协程而不阻塞线程；
+* AsyncMutex::lockUntil() 超过截止时间仍未轮到时放弃等待。
+* Executor 是一组工作线程，co_await executor.run(loop, fn) 在工作线程上执行会阻塞的
+* 函数（磁盘 I/O、存储引擎调用），完成后回到事件循环线程继续；runOn() 对任何提供
+* submit() 的线程池做同样的事。
+ */
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <expected>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "coro.hpp"
+#include "socket_utils.hpp"
+
+namespace NET {
+
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    EventLoop();
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    // 在当前线程上运行，直到 stop() 被调用
+    void run();
+
+    // 请求 run() 返回，可以从任意线程调用
+    void stop();
+
+    // 把协程交给事件循环线程恢复，可以从任意线程调用
+    void post(std::coroutine_handle<> handle);
+
+private:
+    // 一次 I/O 等待，存放在等待者的协程帧中
+    struct IoWaiter {
+        std::coroutine_handle<> handle;
+        int fd = -1;
+        bool write = false;
+        bool timed_out = false;
+        std::pair<Clock::time_point, uint64_t> timer{};  // 超时定时器的键，未设置时 id 为 0
+    };
+
+    struct FdState {
+        IoWaiter* reader = nullptr;
+        IoWaiter* writer = nullptr;
+        uint32_t registered = 0;  // 已向 epoll 注册的事件
+    };
+
+    class IoAwaiter {
+    public:
+        IoAwaiter(EventLoop& owner, int fd, bool write, std::chrono::milliseconds timeout)
+            : loop(owner), wait_timeout(timeout) {
+            waiter.fd = fd;
+            waiter.write = write;
+        }
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) { loop.addWaiter(waiter, handle, wait_timeout); }
+        bool await_resume() const noexcept { return !waiter.timed_out; }
+
+    private:
+        EventLoop& loop;
+        std::chrono::milliseconds wait_timeout;
+        IoWaiter waiter;
+    };
+
+    class SleepAwaiter {
+    public:
+        SleepAwaiter(EventLoop& owner, std::chrono::milliseconds duration) : loop(owner), delay(duration) {}
+
+        bool await_ready() const noexcept { return delay.count() <= 0; }
+        void await_suspend(std::coroutine_handle<> handle) { loop.addTimer(Clock::now() + delay, [handle] { handle.resume(); }); }
+        void await_resume() const noexcept {}
+
+    private:
+        EventLoop& loop;
+        std::chrono::milliseconds delay;
+    };
+
+public:
+    // 等待 fd 可读（对端关闭或出错也算可读），timeout 为负表示不限时
+    // 返回 false 表示超时
+    IoAwaiter readable(int fd, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1)) {
+        return IoAwaiter(*this, fd, false, timeout);
+    }
+
+    // 等待 fd 可写，语义同 readable()
+    IoAwaiter writable(int fd, std::chrono::milliseconds timeout = std::chrono::milliseconds(-1)) {
+        return IoAwaiter(*this, fd, true, timeout);
+    }
+
+    SleepAwaiter sleepFor(std::chrono::milliseconds duration) { return SleepAwaiter(*this, duration); }
+
+private:
+    friend class AsyncMutex;
+
+    using TimerKey = std::pair<Clock::time_point, uint64_t>;
+
+    void addWaiter(IoWaiter& waiter, std::coroutine_handle<> handle, std::chrono::milliseconds timeout);
+    void removeWaiter(IoWaiter& waiter);
+    void updateInterest(int fd, FdState& state);
+    TimerKey addTimer(Clock::time_point deadline, std::function<void()> callback);
+    void cancelTimer(const TimerKey& key) { timers.erase(key); }
+    void runDueTimers();
+    void runPosted();
+
+    int epoll_fd = -1;
+    int wake_fd = -1;  // eventfd，post() 和 stop() 用它唤醒 epoll_wait
+    std::unordered_map<int, FdState> fds;
+    std::map<TimerKey, std::function<void()>> timers;
+    uint64_t next_timer_id = 1;
+
+    std::mutex posted_mutex;
+    std::vector<std::coroutine_handle<>> posted;
+    bool stopping = false;  // 由 posted_mutex 保护
+};
+
+// 协程互斥锁：lock() 挂起直到获得锁，按请求顺序交给等待者
+class AsyncMutex {
+    // 一个等待者，存放在等待者的协程帧中
+    struct Waiter {
+        std::coroutine_handle<> handle;
+        bool granted = false;
+        EventLoop::TimerKey timer{};  // 截止时间的定时器，未设置时 id 为 0
+    };
+
+public:
+    class Guard {
+    public:
+        Guard() = default;
+        explicit Guard(AsyncMutex* owner) : mutex(owner) {}
+        Guard(Guard&& other) noexcept : mutex(std::exchange(other.mutex, nullptr)) {}
+        Guard& operator=(Guard&& other) noexcept {
+            if (this != &other) {
+                unlock();
+                mutex = std::exchange(other.mutex, nullptr);
+            }
+            return *this;
+        }
+        ~Guard() { unlock(); }
+
+        void unlock() {
+            if (mutex) {
+                std::exchange(mutex, nullptr)->unlock();
+            }
+        }
+
+        // lockUntil() 超时返回的 Guard 不持有锁
+        bool ownsLock() const { return mutex != nullptr; }
+
+    private:
+        AsyncMutex* mutex = nullptr;
+    };
+
+    explicit AsyncMutex(EventLoop& owner) : loop(owner) {}
+
+    // 同 lock()，但到 deadline 仍未获得锁时放弃排队，返回不持有锁的 Guard
+    auto lockUntil(EventLoop::Clock::time_point deadline) {
+        struct Awaiter {
+            AsyncMutex& mutex;
+            EventLoop::Clock::time_point deadline;
+            Waiter waiter{};
+
+            bool await_ready() {
+                if (!mutex.locked) {
+                    mutex.locked = true;
+                    waiter.granted = true;
+                    return true;
+                }
+                return false;
+            }
+            void await_suspend(std::coroutine_handle<> handle) {
+                waiter.handle = handle;
+                mutex.waiters.push_back(&waiter);
+                if (deadline != EventLoop::Clock::time_point::max()) {
+                    Waiter* target = &waiter;
+                    AsyncMutex* owner = &mutex;
+                    waiter.timer = mutex.loop.addTimer(deadline, [owner, target] {
+                        target->timer = {};
+                        std::erase(owner->waiters, target);
+                        target->handle.resume();
+                    });
+                }
+            }
+            Guard await_resume() { return Guard(waiter.granted ? &mutex : nullptr); }
+        };
+        return Awaiter{*this, deadline};
+    }
+
+    auto lock() { return lockUntil(EventLoop::Clock::time_point::max()); }
+
+    bool isLocked() const { return locked; }
+
+    // 正在等待锁的协程数
+    size_t waiterCount() const { return waiters.size(); }
+
+private:
+    void unlock() {
+        if (waiters.empty()) {
+            locked = false;
+            return;
+        }
+        // 锁直接转交给下一个等待者；经事件循环恢复，避免在释放者的调用栈中执行
+        Waiter* next = waiters.front();
+        waiters.pop_front();
+        if (next->timer.second != 0) {
+            loop.cancelTimer(next->timer);
+            next->timer = {};
+        }
+        next->granted = true;
+        loop.post(next->handle);
+    }
+
+    EventLoop& loop;
+    bool locked = false;
+    std::deque<Waiter*> waiters;
+};
+
+// 单个等待者的事件：wait() 挂起直到 set()，之后自动复位
+class AsyncEvent {
+public:
+    auto wait() {
+        struct Awaiter {
+            AsyncEvent& event;
+
+            bool await_ready() const noexcept { return event.signaled; }
+            void await_suspend(std::coroutine_handle<> handle) noexcept { event.waiter = handle; }
+            void await_resume() noexcept { event.signaled = false; }
+        };
+        return Awaiter{*this};
+    }
+
+    // 唤醒等待者；没有等待者时下一次 wait() 立即返回
+    void set() {
+        signaled = true;
+        if (waiter) {
+            std::exchange(waiter, nullptr).resume();
+        }
+    }
+
+private:
+    bool signaled = false;
+    std::coroutine_handle<> waiter;
+};
+
+// 在 pool 的线程上执行 fn，完成后在 loop 的线程上恢复，返回 fn 的结果（或重新抛出其异常）。
+// pool 只需提供 submit(std::function<void()>)
+template <typename Pool, typename F>
+auto runOn(Pool& pool, EventLoop& loop, F fn) {
+    using Result = std::invoke_result_t<F&>;
+    using Stored = std::conditional_t<std::is_void_v<Result>, std::monostate, Result>;
+
+    struct Awaiter {
+        Pool& pool;
+        EventLoop& loop;
+        F fn;
+        std::variant<std::monostate, Stored, std::exception_ptr> outcome;
+
+        bool await_ready() const noexcept { return false; }
+
+        void await_suspend(std::coroutine_handle<> handle) {
+            pool.submit([this, handle] {
+                try {
+                    if constexpr (std::is_void_v<Result>) {
+                        fn();
+                        outcome.template emplace<1>();
+                    } else {
+                        outcome.template emplace<1>(fn());
+                    }
+                } catch (...) {
+                    outcome.template emplace<2>(std::current_exception());
+                }
+                loop.post(handle);
+            });
+        }
+
+        Result await_resume() {
+            if (outcome.index() == 2) {
+                std::rethrow_exception(std::get<2>(outcome));
+            }
+            if constexpr (!std::is_void_v<Result>) {
+                return std::move(std::get<1>(outcome));
+            }
+        }
+    };
+    return Awaiter{pool, loop, std::move(fn), {}};
+}
+
+// 工作线程池，执行会阻塞事件循环的函数
+class Executor {
+public:
+    explicit Executor(size_t thread_count);
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    // 提交一个函数，由某个工作线程执行
+    void submit(std::function<void()> job);
+
+    size_t threadCount() const { return threads.size(); }
+
+    // co_await executor.run(loop, fn)：见 runOn()
+    template <typename F>
+    auto run(EventLoop& loop, F fn) {
+        return runOn(*this, loop, std::move(fn));
+    }
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::function<void()>> jobs;
+    bool stopping = false;
+};
+
+// 在非阻塞套接字上读满 size 字节；每次等待数据超过 timeout 返回 TIMEOUT（负数表示不限时）
+Task<std::expected<void, SocketError>> readExact(EventLoop& loop, int fd, std::byte* dest, size_t size,
+                                                 std::chrono::milliseconds timeout = std::chrono::milliseconds(-1));
+
+// 在非阻塞套接字上写完 data
+Task<std::expected<void, SocketError>> writeAll(EventLoop& loop, int fd, std::span<const std::byte> data);
+
+} // namespace NET
@@ -0,0 +1,66 @@
+/**
+* @brief 服务端 SQL 文本的解析缓存
+*
+* SQL_TEXT_REQUEST 的语句经 Lexer -> Parser -> QueryBuilder 翻译为 QueryRequest，
+* 结果按语句文本缓存（LRU），重复的语句直接复用，跳过词法和语法分析。
+* 缓存的请求不含会话 token，使用前由调用方复制并填入。缓存本身非线程安全；
+* parseUncached() 不访问缓存，可以在其他线程上解析未命中的语句，再由 insert() 放入缓存。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "query.hpp"
+
+namespace NET {
+
+struct ParseCacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    size_t entries = 0;
+};
+
+class ParseCache {
+public:
+    // 超过该长度的语句（通常是批量 INSERT）不缓存，避免挤掉常用语句
+    static constexpr size_t MAX_CACHED_STATEMENT_BYTES = 4096;
+
+    // capacity 为 0 时不缓存，每次都重新解析
+    explicit ParseCache(size_t capacity = 256);
+
+    // 解析一条语句（先查缓存，未命中时解析并放入缓存），失败时返回语法错误信息
+    std::expected<std::shared_ptr<const QueryRequest>, std::string> parse(std::string_view sql);
+
+    // 只查缓存，未命中时返回空指针
+    std::shared_ptr<const QueryRequest> lookup(std::string_view sql);
+
+    // 放入一条已解析的语句；容量为 0 或语句超过 MAX_CACHED_STATEMENT_BYTES 时忽略
+    void insert(std::string_view sql, std::shared_ptr<const QueryRequest> request);
+
+    // 不经过缓存解析一条语句，线程安全
+    static std::expected<std::shared_ptr<const QueryRequest>, std::string> parseUncached(std::string_view sql);
+
+    void clear();
+    ParseCacheStats getStats() const;
+
+private:
+    struct Entry {
+        std::string sql;
+        std::shared_ptr<const QueryRequest> request;
+    };
+
+    size_t capacity;
+    std::list<Entry> entries;  // 头部是最近使用的语句
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index;  // 键指向 Entry::sql
+    ParseCacheStats stats;
+};
+
+} // namespace NET
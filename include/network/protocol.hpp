@@ -17,16 +17,40 @@ enum class MessageType : uint8_t {
     // From Client to Server
     LOGIN_REQUEST = 0x10,
     QUERY_REQUEST = 0x20,
+    SQL_TEXT_REQUEST = 0x22,
     PING_REQUEST = 0x30,
+    SHM_ATTACH_REQUEST = 0x40,
+    CANCEL_REQUEST = 0x50,
 
     // From Server to Client
     LOGIN_SUCCESS = 0x11,
     LOGIN_FAILURE = 0x12,
     QUERY_RESPONSE = 0x21,
     PONG_RESPONSE = 0x31,
+    SHM_ATTACH_RESPONSE = 0x41,
     ERROR_RESPONSE = 0x99,
 };
 
+// 协议版本：登录时协商，取双方的较小值
+// 版本 1 是不带握手字段的旧格式，与旧版客户端/服务端通信时回退到它
+constexpr uint16_t PROTOCOL_VERSION_LEGACY = 1;
+constexpr uint16_t PROTOCOL_VERSION = 2;
+
+// 能力位：登录时双方各自声明，取交集；新的编码和消息只在双方都支持时使用
+enum Capability : uint32_t {
+    CAP_CANCEL = 1u << 0,           // CANCEL_REQUEST
+    CAP_SESSION_OPTIONS = 1u << 1,  // SET 会话设置
+    CAP_SQL_TEXT = 1u << 2,         // SQL_TEXT_REQUEST
+    CAP_SET_PREDICATES = 1u << 3,   // WHERE 中的 IN 列表和 BETWEEN
+    CAP_BOOLEAN_WHERE = 1u << 4,    // WHERE 表达式树（AND / OR / NOT 和括号）
+    CAP_LIKE = 1u << 5,             // WHERE 中的 LIKE / ILIKE
+};
+
+// 本端实现的全部能力
+constexpr uint32_t SUPPORTED_CAPABILITIES =
+    CAP_CANCEL | CAP_SESSION_OPTIONS | CAP_SQL_TEXT | CAP_SET_PREDICATES | CAP_BOOLEAN_WHERE |
+    CAP_LIKE;
+
 enum class ProtocolError {
     INVALID_MAGIC_NUMBER,
     INVALID_MESSAGE_TYPE,
@@ -98,10 +122,13 @@ public:
 // ========== 具体消息类型 ==========
 
 // 登录请求
+// 版本 2 起在用户名、密码之后附加协议版本和能力位；旧版客户端不带这两个字段，按版本 1 处理
 class LoginRequest : public Message {
 private:
     std::string username;
     std::string password;
+    uint16_t protocol_version = PROTOCOL_VERSION;
+    uint32_t capabilities = SUPPORTED_CAPABILITIES;
 
 public:
     LoginRequest();
@@ -112,15 +139,22 @@ public:
     
     const std::string& getUsername() const { return username; }
     const std::string& getPassword() const { return password; }
+    uint16_t getProtocolVersion() const { return protocol_version; }
+    uint32_t getCapabilities() const { return capabilities; }
     
     void setCredentials(std::string user, std::string pass);
+    // 以 PROTOCOL_VERSION_LEGACY 发送时不附加握手字段
+    void setProtocol(uint16_t version, uint32_t caps);
 };
 
 // 登录成功响应
+// 版本 2 起附加协商结果（双方版本的较小值、能力位的交集）；回复旧版客户端时不带
 class LoginSuccess : public Message {
 private:
     std::string session_token;
     uint32_t user_id;
+    uint16_t protocol_version = PROTOCOL_VERSION_LEGACY;
+    uint32_t capabilities = 0;
 
 public:
     LoginSuccess();
@@ -131,8 +165,11 @@ public:
     
     const std::string& getSessionToken() const { return session_token; }
     uint32_t getUserId() const { return user_id; }
+    uint16_t getProtocolVersion() const { return protocol_version; }
+    uint32_t getCapabilities() const { return capabilities; }
     
     void setSessionInfo(std::string token, uint32_t uid);
+    void setProtocol(uint16_t version, uint32_t caps);
 };
 
 // 登录失败响应
@@ -180,7 +217,10 @@ public:
     void setError(std::string error);
 };
 
-// Ping请求（心跳）
+// 心跳消息使用的时间戳：系统时钟自 epoch 起的微秒数
+uint64_t currentTimestampMicros();
+
+// Ping请求（心跳），timestamp 为客户端发送时刻
 class PingRequest : public Message {
 private:
     uint64_t timestamp;
@@ -196,7 +236,7 @@ public:
     void setTimestamp(uint64_t ts) { timestamp = ts; }
 };
 
-// Pong响应（心跳响应）
+// Pong响应（心跳响应），回显请求的时间戳并附上服务端收到请求的时刻
 class PongResponse : public Message {
 private:
     uint64_t original_timestamp;
@@ -215,6 +255,74 @@ public:
     void setTimestamps(uint64_t orig_ts, uint64_t server_ts);
 };
 
+// 共享内存升级请求（仅 Unix 域连接）
+// 发送后紧跟一个通过 SCM_RIGHTS 携带 memfd 的 1 字节消息
+class ShmAttachRequest : public Message {
+private:
+    uint64_t ring_capacity;
+
+public:
+    ShmAttachRequest();
+    explicit ShmAttachRequest(uint64_t capacity);
+    
+    void serializePayload(Serializer& serializer) const override;
+    std::expected<void, ProtocolError> deserializePayload(Deserializer& deserializer) override;
+    
+    uint64_t getRingCapacity() const { return ring_capacity; }
+};
+
+// 共享内存升级响应（总是经由套接字发送），accepted 之后的消息改走共享内存
+class ShmAttachResponse : public Message {
+private:
+    bool accepted;
+    std::string message;
+
+public:
+    ShmAttachResponse();
+    ShmAttachResponse(bool accepted, std::string message);
+    
+    void serializePayload(Serializer& serializer) const override;
+    std::expected<void, ProtocolError> deserializePayload(Deserializer& deserializer) override;
+    
+    bool isAccepted() const { return accepted; }
+    const std::string& getMessage() const { return message; }
+};
+
+// 取消请求：中止该会话正在执行的语句，被取消的语句以错误的 QUERY_RESPONSE 结束
+// 服务端不对 CANCEL 本身回复，没有语句在执行时直接忽略
+class CancelRequest : public Message {
+private:
+    std::string session_token;
+
+public:
+    CancelRequest();
+    explicit CancelRequest(std::string token);
+    
+    void serializePayload(Serializer& serializer) const override;
+    std::expected<void, ProtocolError> deserializePayload(Deserializer& deserializer) override;
+    
+    const std::string& getSessionToken() const { return session_token; }
+};
+
+// SQL 文本请求：由服务端解析，响应与 QUERY_REQUEST 相同（QUERY_RESPONSE）
+// 一次只含一条语句，语法错误以错误的 QUERY_RESPONSE 返回
+class SqlTextRequest : public Message {
+private:
+    std::string session_token;
+    std::string sql;
+
+public:
+    SqlTextRequest();
+    SqlTextRequest(std::string token, std::string statement);
+    
+    void serializePayload(Serializer& serializer) const override;
+    std::expected<void, ProtocolError> deserializePayload(Deserializer& deserializer) override;
+    
+    const std::string& getSessionToken() const { return session_token; }
+    const std::string& getSql() const { return sql; }
+    void setSessionToken(const std::string& token) { session_token = token; }
+};
+
 // 错误响应
 class ErrorResponse : public Message {
 private:
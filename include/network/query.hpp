@@ -6,6 +6,7 @@
 #include <expected>
 #include "serializer.hpp"
 #include "protocol.hpp"
+#include "result_set.hpp"
 #include "../client/Parser.hpp"
 #include "socket_client.hpp"
 
@@ -24,7 +25,16 @@ enum class OperationType : uint8_t {
     INSERT = 0x10,
     SELECT = 0x11,
     UPDATE = 0x12,
-    DELETE = 0x13
+    DELETE = 0x13,
+
+    // 管理操作
+    SHOW_STATS = 0x20,
+    SHOW_TRACE = 0x21,
+    SHOW_MEMORY = 0x22,
+    SHOW_ADMISSION = 0x23,
+
+    // 会话设置
+    SET_OPTION = 0x30
 };
 
 // 数据类型枚举（与服务端保持一致）
@@ -64,17 +74,57 @@ struct ColumnDefinition {
 // WHERE条件
 struct WhereCondition {
     std::string column;
-    std::string operator_str; // "=", ">", "<", ">=", "<=", "!="
+    std::string operator_str; // "=", ">", "<", ">=", "<=", "!="，或 "IN" / "BETWEEN" / "LIKE" / "ILIKE"
     LiteralValue value;
+    std::vector<LiteralValue> values; // IN 的值列表，或 BETWEEN 的下界和上界
     
     WhereCondition() = default;
     WhereCondition(std::string col, std::string op, LiteralValue val)
         : column(std::move(col)), operator_str(std::move(op)), value(std::move(val)) {}
+    WhereCondition(std::string col, std::string op, std::vector<LiteralValue> vals)
+        : column(std::move(col)), operator_str(std::move(op)), values(std::move(vals)) {}
+    
+    // IN / BETWEEN 使用 values（需要 CAP_SET_PREDICATES），其余操作符使用 value
+    bool hasValueList() const { return operator_str == "IN" || operator_str == "BETWEEN"; }
+    // 服务端需要支持的能力位：IN / BETWEEN 为 CAP_SET_PREDICATES，LIKE / ILIKE 为 CAP_LIKE
+    uint32_t requiredCapabilities() const;
     
+    // 编码：IN / BETWEEN 在 value 之后附加 values，其余操作符的编码与旧版相同
+
     void serialize(Serializer& serializer) const;
     static std::expected<WhereCondition, ProtocolError> deserialize(Deserializer& deserializer);
 };
 
+// WHERE表达式树：叶子为单个条件，AND / OR 有两个以上子节点，NOT 有一个
+struct WhereExpression {
+    enum class Kind : uint8_t {
+        CONDITION = 0x00,
+        AND = 0x01,
+        OR = 0x02,
+        NOT = 0x03
+    };
+    
+    // 反序列化时允许的最大嵌套层数，防止恶意构造的请求耗尽栈
+    static constexpr int MAX_DEPTH = 64;
+    
+    Kind kind = Kind::CONDITION;
+    WhereCondition condition;               // 仅 CONDITION
+    std::vector<WhereExpression> children;  // AND / OR / NOT 的操作数
+    
+    WhereExpression() = default;
+    explicit WhereExpression(WhereCondition cond) : condition(std::move(cond)) {}
+    WhereExpression(Kind k, std::vector<WhereExpression> operands)
+        : kind(k), children(std::move(operands)) {}
+    
+    bool isCondition() const { return kind == Kind::CONDITION; }
+    // 各条件需要的能力位，表达式树另需 CAP_BOOLEAN_WHERE
+    uint32_t requiredCapabilities() const;
+    
+    // 编码：kind，CONDITION 后接 WhereCondition，其余后接子节点数和各子节点
+    void serialize(Serializer& serializer) const;
+    static std::expected<WhereExpression, ProtocolError> deserialize(Deserializer& deserializer, int depth = 0);
+};
+
 // SET子句（用于UPDATE）
 struct SetClause {
     std::string column;
@@ -101,8 +151,8 @@ private:
     // DML参数
     std::vector<std::string> select_columns;  // 用于SELECT，空表示SELECT *
     std::vector<LiteralValue> insert_values;  // 用于INSERT
-    std::vector<SetClause> update_clauses;    // 用于UPDATE
-    std::optional<WhereCondition> where_condition; // 用于SELECT/UPDATE/DELETE
+    std::vector<SetClause> update_clauses;    // 用于UPDATE，以及SET（设置项名 = 值）
+    std::optional<WhereExpression> where_expression; // 用于SELECT/UPDATE/DELETE
 
 public:
     explicit QueryRequest(OperationType op = OperationType::SELECT);
@@ -134,9 +184,14 @@ public:
     void setUpdateClauses(const std::vector<SetClause>& clauses) { update_clauses = clauses; }
     const std::vector<SetClause>& getUpdateClauses() const { return update_clauses; }
     
-    void setWhereCondition(const WhereCondition& condition) { where_condition = condition; }
-    const std::optional<WhereCondition>& getWhereCondition() const { return where_condition; }
-    void clearWhereCondition() { where_condition.reset(); }
+    // 单个条件按旧版编码发送，复合表达式需要 CAP_BOOLEAN_WHERE
+    void setWhereCondition(const WhereCondition& condition) { where_expression = WhereExpression(condition); }
+    void setWhereExpression(const WhereExpression& expression) { where_expression = expression; }
+    const std::optional<WhereExpression>& getWhereExpression() const { return where_expression; }
+    void clearWhereCondition() { where_expression.reset(); }
+    
+    // 发送本请求需要对端支持的能力位（如 IN / BETWEEN 需要 CAP_SET_PREDICATES）
+    uint32_t requiredCapabilities() const;
     
     // 实现基类方法
     void serializePayload(Serializer& serializer) const override;
@@ -159,12 +214,23 @@ public:
     static QueryRequest buildUpdate(const UpdateCommand& cmd);
     static QueryRequest buildDelete(const DeleteCommand& cmd);
 
+    // 管理命令转换
+    static QueryRequest buildShowStats(const ShowStatsCommand& cmd);
+    static QueryRequest buildShowTrace(const ShowTraceCommand& cmd);
+    static QueryRequest buildShowMemory(const ShowMemoryCommand& cmd);
+    static QueryRequest buildShowAdmission(const ShowAdmissionCommand& cmd);
+    static QueryRequest buildSetOption(const SetOptionCommand& cmd);
+
+    // 按命令的实际类型分派到上面的 build 函数，不支持的命令返回 nullopt
+    static std::optional<QueryRequest> build(const Command& cmd);
+
 private:
     // 类型转换辅助函数
     static DataType convertTokenType(TokenType token_type);
     static LiteralValue convertLiteralValue(const ::LiteralValue& client_value);
     static ColumnDefinition convertColumnDef(const ColumnDef& client_col);
-    static WhereCondition convertWhereClause(const WhereClause& client_where);
+    static WhereCondition convertCondition(const Condition& client_condition);
+    static WhereExpression convertWhereClause(const WhereClause& client_where);
     static SetClause convertSetClause(const ::SetClause& client_set);
 };
 
@@ -172,6 +238,13 @@ class NetworkQueryExecutor {
 private:
     SocketClient& client;
     std::string session_token;
+    uint16_t protocol_version = PROTOCOL_VERSION_LEGACY;
+    uint32_t capabilities = 0;
+    
+    // 发送 QUERY_REQUEST / SQL_TEXT_REQUEST 并等待 QUERY_RESPONSE
+    std::expected<std::unique_ptr<QueryResponse>, SocketError> sendRequest(const Message& request);
+    // 同上，响应不解码，直接包装为 ResultSet
+    std::expected<ResultSet, SocketError> sendRequestLazy(const Message& request);
 
 public:
     explicit NetworkQueryExecutor(SocketClient& client_ref);
@@ -180,8 +253,26 @@ public:
     bool isAuthenticated() const;
     void clearAuthentication();
     
+    // 记录登录时协商的协议版本和能力位（取自 LoginSuccess）
+    void setProtocol(uint16_t version, uint32_t caps);
+    uint16_t getProtocolVersion() const { return protocol_version; }
+    bool hasCapability(Capability capability) const { return (capabilities & capability) != 0; }
+    uint32_t getCapabilities() const { return capabilities; }
+    
     std::expected<std::unique_ptr<QueryResponse>, SocketError> 
     executeQuery(const QueryRequest& request);
+    
+    // 发送 SQL 文本由服务端解析执行（需要 CAP_SQL_TEXT，否则返回 UNSUPPORTED）
+    std::expected<std::unique_ptr<QueryResponse>, SocketError> 
+    executeSql(const std::string& sql);
+    
+    // 与 executeQuery / executeSql 相同，但结果按需解码：单元格在读取时才转换为所需类型
+    std::expected<ResultSet, SocketError> fetch(const QueryRequest& request);
+    std::expected<ResultSet, SocketError> fetchSql(const std::string& sql);
+    
+    // 请求服务端取消本会话正在执行的语句，可在 executeQuery 阻塞期间从其他线程调用
+    // 服务端不支持 CANCEL 时返回 UNSUPPORTED
+    std::expected<void, SocketError> cancel();
 };
 
 } // namespace NET
\ No newline at end of file
@@ -0,0 +1,87 @@
+/**
+* @brief 按需解码的查询结果
+*
+* 直接持有 QUERY_RESPONSE 的原始帧，构造时只扫描一遍长度前缀、记录每个单元格的偏移，
+* 不为单元格分配字符串。读取时才把对应的字节解码为所需类型：
+*  - getStringView() 返回指向帧内数据的视图，ResultSet 销毁后失效；
+*  - getInt64() / getDouble() 用 std::from_chars 解析，整个单元格都必须是合法数字；
+*  - getBool() 接受 1/0 和 true/false（不区分大小写）。
+* 只读取少数几列的应用不必为其余列付出解码和分配的开销。
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "protocol.hpp"
+
+namespace NET {
+
+enum class FieldError {
+    NO_SUCH_FIELD,       // 行号或列号越界
+    INVALID_VALUE,       // 单元格内容不是所请求的类型
+    VALUE_OUT_OF_RANGE   // 数值超出目标类型的范围
+};
+
+class ResultSet {
+public:
+    // 结果集中一行的轻量视图，不拷贝数据
+    class RowView {
+    public:
+        size_t size() const;
+
+        std::expected<std::string_view, FieldError> getStringView(size_t column) const;
+        std::expected<int64_t, FieldError> getInt64(size_t column) const;
+        std::expected<double, FieldError> getDouble(size_t column) const;
+        std::expected<bool, FieldError> getBool(size_t column) const;
+
+    private:
+        friend class ResultSet;
+        RowView(const ResultSet& owner, size_t row_index) : result(&owner), row(row_index) {}
+
+        const ResultSet* result;
+        size_t row;
+    };
+
+    ResultSet() = default;
+
+    // 解析完整的 QUERY_RESPONSE 帧（头部 + 载荷），只校验结构、建立单元格索引
+    static std::expected<ResultSet, ProtocolError> fromFrame(std::vector<std::byte> frame);
+
+    bool isSuccess() const { return success; }
+    const std::string& getErrorMessage() const { return error_message; }
+
+    size_t getColumnCount() const { return column_offsets.size(); }
+    std::string_view getColumnName(size_t column) const;
+    std::optional<size_t> findColumn(std::string_view name) const;
+
+    size_t getRowCount() const { return row_begin.empty() ? 0 : row_begin.size() - 1; }
+    RowView getRow(size_t row) const { return RowView(*this, row); }
+
+    std::expected<std::string_view, FieldError> getStringView(size_t row, size_t column) const;
+    std::expected<int64_t, FieldError> getInt64(size_t row, size_t column) const;
+    std::expected<double, FieldError> getDouble(size_t row, size_t column) const;
+    std::expected<bool, FieldError> getBool(size_t row, size_t column) const;
+
+    // 全部解码为 QueryResponse，供仍使用按行字符串接口的代码
+    QueryResponse materialize() const;
+
+private:
+    // offset 处是一个长度前缀字符串
+    std::string_view stringAt(uint32_t offset) const;
+    std::expected<std::string_view, FieldError> cell(size_t row, size_t column) const;
+
+    std::vector<std::byte> frame;
+    bool success = true;
+    std::string error_message;
+    std::vector<uint32_t> column_offsets;        // 每个列名长度前缀在 frame 中的偏移
+    std::vector<uint32_t> cells;                 // 每个单元格长度前缀在 frame 中的偏移
+    std::vector<uint32_t> row_begin;             // 第 i 行的单元格为 cells[row_begin[i], row_begin[i+1])
+};
+
+} // namespace NET
@@ -0,0 +1,105 @@
+/**
+* @brief 共享内存传输
+*
+* 同机客户端可在 Unix 域套接字连接建立后升级为共享内存传输：客户端创建一个 memfd，
+* 其中包含两个方向的单生产者/单消费者字节环，通过 SCM_RIGHTS 把描述符交给服务端。
+* 升级后帧格式不变（MessageHeader + 载荷），只是收发不再经过内核套接字。
+*
+* 等待策略：环空（或满）时先自旋一小段时间，仍未就绪再以 futex 睡眠；
+* 睡眠带超时，醒来后检查对端是否已关闭通道或断开套接字。
+ */
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <expected>
+#include <memory>
+#include <span>
+
+#include "socket_utils.hpp"
+
+namespace NET {
+
+struct ShmLayout;
+
+// 一个方向的环的控制字段，位于共享内存中
+// head 只由写端推进，tail 只由读端推进，二者都是单调递增的字节计数；
+// 对端在睡眠时，推进方递增对应的 seq 并 futex 唤醒
+struct ShmRingHeader {
+    alignas(64) std::atomic<uint64_t> head;
+    std::atomic<uint32_t> data_seq;
+    std::atomic<uint32_t> reader_sleeping;
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> space_seq;
+    std::atomic<uint32_t> writer_sleeping;
+};
+
+// 共享内存中的一个方向的字节环（不拥有内存）
+struct ShmRing {
+    ShmRingHeader* header = nullptr;
+    std::byte* data = nullptr;
+    uint64_t capacity = 0;  // 2 的幂
+};
+
+class ShmChannel {
+public:
+    static constexpr size_t DEFAULT_RING_CAPACITY = 1 << 20;
+
+    // 客户端：创建并初始化 memfd（大小被密封，服务端映射后不会因截断而 SIGBUS）
+    // socket_fd 为已建立的 Unix 域连接，用于探测对端是否断开
+    static std::expected<std::unique_ptr<ShmChannel>, SocketError>
+    create(int socket_fd, size_t ring_capacity = DEFAULT_RING_CAPACITY);
+
+    // 服务端：校验并映射客户端传来的 memfd，接管该描述符
+    static std::expected<std::unique_ptr<ShmChannel>, SocketError>
+    attach(int socket_fd, int memfd);
+
+    ~ShmChannel();
+
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+
+    int getMemfd() const { return memfd; }
+    uint64_t getRingCapacity() const;
+
+    // 阻塞写入全部数据，环满时等待对端消费
+    std::expected<void, SocketError> send(std::span<const std::byte> data);
+
+    // 阻塞读取恰好 size 字节
+    std::expected<void, SocketError> receive(std::byte* dest, size_t size);
+
+    // 入站环中是否有未读的数据（不阻塞）
+    bool hasData() const;
+
+    // 接收等待超过 timeout 时 receive() 返回 TIMEOUT，0 表示不限制（默认）
+    void setReceiveTimeout(std::chrono::milliseconds timeout) { receive_timeout = timeout; }
+
+    // 环空/满时的自旋时长，之后转入 futex 睡眠
+    // 默认 50us；单核机器上自旋只会占住对端需要的 CPU，默认为 0
+    static void setSpinDuration(std::chrono::nanoseconds duration);
+
+private:
+    ShmChannel(int socket_fd, int memfd, void* mapping, size_t mapping_size, bool is_server);
+
+    template <typename Ready>
+    std::expected<void, SocketError> waitFor(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& sleeping,
+                                             Ready ready, std::chrono::steady_clock::time_point deadline);
+    bool peerGone() const;
+
+    int socket_fd;
+    int memfd;
+    void* mapping;
+    size_t mapping_size;
+    ShmLayout* layout;
+    ShmRing outbound;  // 本端写入的环
+    ShmRing inbound;   // 本端读取的环
+    std::chrono::milliseconds receive_timeout{0};
+};
+
+// 通过 Unix 域套接字传递文件描述符（SCM_RIGHTS，附带 1 字节数据）
+std::expected<void, SocketError> sendFileDescriptor(int socket_fd, int fd);
+std::expected<int, SocketError> receiveFileDescriptor(int socket_fd);
+
+} // namespace NET
@@ -1,26 +1,62 @@
 #pragma once
 
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 #include <memory>
 #include <expected>
 
 #include "protocol.hpp"
+#include "shm_transport.hpp"
 #include "socket_utils.hpp"
 
 namespace NET {
 
+// PING 往返统计，时间单位为微秒
+struct PingStats {
+    uint64_t samples = 0;
+    uint64_t failures = 0;
+    double last_rtt_us = 0;
+    double min_rtt_us = 0;
+    double max_rtt_us = 0;
+    double avg_rtt_us = 0;
+    // 服务端时钟减本地时钟的估计值，取 RTT 最小的样本（排队最少，误差最小）
+    double clock_offset_us = 0;
+    double last_clock_offset_us = 0;
+};
+
 class SocketClient {
 private:
     int socket_fd = -1;
     sockaddr_in server_addr{};
     bool connected = false;
+    std::unique_ptr<ShmChannel> shm_channel;  // 升级为共享内存传输后非空
+
+    // request()/ping() 在一次往返期间持有，避免心跳插入查询的请求与响应之间
+    std::mutex io_mutex;
+    // 每条消息发送期间持有，使 CANCEL 可以在另一线程等待响应时插入发送
+    std::mutex send_mutex;
+    std::atomic<int64_t> last_activity_ns{0};  // 最近一次成功往返（steady_clock）
+
+    mutable std::mutex stats_mutex;
+    PingStats ping_stats;
+
+    // 心跳线程
+    std::thread keepalive_thread;
+    std::mutex keepalive_mutex;
+    std::condition_variable keepalive_cv;
+    bool keepalive_running = false;
 
 public:
     SocketClient();
@@ -28,16 +64,47 @@ public:
 
     // 连接到服务器
     std::expected<void, SocketError> connect(const std::string& ip, uint16_t port);
+
+    // 通过 Unix 域套接字连接到同机的服务器
+    std::expected<void, SocketError> connectUnix(const std::string& path);
+    
+    // 将当前 Unix 域连接升级为共享内存传输，之后的消息改走共享内存环
+    // TCP 连接或服务端拒绝时返回 UNSUPPORTED，连接保持在套接字上可继续使用
+    std::expected<void, SocketError> enableSharedMemory(size_t ring_capacity = ShmChannel::DEFAULT_RING_CAPACITY);
+    bool isSharedMemory() const { return shm_channel != nullptr; }
+    
+    // 设置套接字收发超时，超时返回 TIMEOUT；0 表示一直阻塞（默认）
+    // 对共享内存传输无效
+    std::expected<void, SocketError> setTimeout(std::chrono::milliseconds timeout);
     
     // 断开连接
     void disconnect();
     
-    // 发送消息
+    // 发送消息（线程安全，整条消息连续写出）
     std::expected<void, SocketError> sendMessage(const Message& message);
     
     // 接收消息
     std::expected<std::unique_ptr<Message>, SocketError> receiveMessage();
     
+    // 接收一帧原始消息（头部 + 载荷），不反序列化
+    std::expected<std::vector<std::byte>, SocketError> receiveFrame();
+    
+    // 发送请求并等待响应；开启心跳后必须通过它收发
+    std::expected<std::unique_ptr<Message>, SocketError> request(const Message& message);
+    
+    // 同 request()，但返回未反序列化的响应帧，由调用方按需解码
+    std::expected<std::vector<std::byte>, SocketError> requestFrame(const Message& message);
+    
+    // 发送一次 PING，记录往返时间和时钟偏差；timeout 内没有响应返回 TIMEOUT
+    std::expected<void, SocketError> ping(std::chrono::milliseconds timeout = std::chrono::seconds(5));
+    
+    // 后台心跳：连接空闲达到 interval 时发送 PING，连续 max_failures 次失败后
+    // 判定连接已失效并关闭套接字，之后的请求立即返回错误
+    void startKeepalive(std::chrono::milliseconds interval, int max_failures = 3);
+    void stopKeepalive();
+    
+    PingStats getPingStats() const;
+    
     // 检查连接状态
     bool isConnected() const { return connected; }
 
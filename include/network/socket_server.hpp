@@ -1,46 +1,107 @@
 #pragma once
 
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <unistd.h>
 #include <fcntl.h>
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
 #include <expected>
+#include <unordered_map>
 
 #include "protocol.hpp"
+#include "shm_transport.hpp"
 #include "socket_utils.hpp"
 
 namespace NET {
 
+// Unix 域套接字对端进程的身份（SO_PEERCRED）
+struct PeerCredentials {
+    pid_t pid;
+    uid_t uid;
+    gid_t gid;
+};
+
 class SocketServer {
 private:
-    int server_fd = -1;
+    int server_fd = -1;             // TCP 监听套接字
     sockaddr_in server_addr{};
+    int unix_fd = -1;               // Unix 域监听套接字
+    std::string unix_path;
     bool running = false;
+    // 已升级为共享内存传输的连接，收发改走对应通道
+    std::unordered_map<int, std::unique_ptr<ShmChannel>> shm_channels;
+    std::chrono::milliseconds idle_timeout{0};
+    int listen_backlog = 128;
 
 public:
     SocketServer();
     ~SocketServer();
 
-    // 启动服务器
+    // 启动服务器（TCP）
     std::expected<void, SocketError> start(const std::string& ip, uint16_t port);
+
+    // 在指定路径上监听 Unix 域套接字，可与 TCP 同时使用
+    // 路径上残留的旧套接字文件会被删除，stop() 时同样会删除
+    std::expected<void, SocketError> startUnix(const std::string& path);
     
     // 停止服务器
     void stop();
     
-    // 等待客户端连接
+    // 之后接受的连接在等待数据超过 timeout 时接收返回 TIMEOUT，用于回收失联客户端占用的连接
+    // 0 表示一直等待（默认）
+    void setIdleTimeout(std::chrono::milliseconds timeout) { idle_timeout = timeout; }
+    
+    // 内核中等待 accept 的连接队列长度，须在 start()/startUnix() 之前设置
+    void setListenBacklog(int backlog) { listen_backlog = backlog; }
+    
+    // 等待客户端连接（同时监听 TCP 和 Unix 域套接字时，哪个先就绪就接受哪个）
     std::expected<int, SocketError> acceptClient();
+
+    // 不阻塞地接受一个已到达的连接，没有时返回 TIMEOUT
+    std::expected<int, SocketError> tryAcceptClient();
+
+    // 正在监听的套接字（TCP 和/或 Unix 域），供事件循环等待新连接
+    std::vector<int> listeningSockets() const;
+
+    // 拒绝连接：发送 message 后关闭，关闭前丢弃对端已发来的数据，
+    // 避免未读数据使内核回复 RST 而让对端读不到 message
+    void rejectClient(int client_fd, const Message& message);
+
+    // 获取 Unix 域连接对端的进程凭据，TCP 连接返回 INVALID_ADDRESS
+    std::expected<PeerCredentials, SocketError> getPeerCredentials(int client_fd) const;
     
+    // 处理 SHM_ATTACH_REQUEST：接收随后通过 SCM_RIGHTS 传来的 memfd 并回复 SHM_ATTACH_RESPONSE
+    // 返回 true 表示已升级，此后该连接的收发改走共享内存；allowed 为 false 或校验失败时
+    // 回复拒绝并继续使用套接字。只有接收描述符或发送回复失败时返回错误
+    std::expected<bool, SocketError> acceptSharedMemory(int client_fd, bool allowed);
+
+    // 同 acceptSharedMemory()，但升级后的通道交给调用方持有，收发由调用方直接使用通道
+    // 拒绝升级时返回空指针
+    std::expected<std::unique_ptr<ShmChannel>, SocketError> attachSharedMemory(int client_fd, bool allowed);
+
     // 接收消息
     std::expected<std::unique_ptr<Message>, SocketError> receiveMessage(int client_fd);
+
+    // 不阻塞地检查连接上是否有待读的数据（对端断开也视为可读，随后的接收会返回错误）
+    bool hasPendingInput(int client_fd) const;
+
+    // 分步接收：先阻塞等待消息头，再接收载荷并返回完整帧（头部 + 载荷）
+    // 便于调用方分别统计等待、接收与反序列化的耗时
+    std::expected<MessageHeader, SocketError> receiveHeader(int client_fd);
+    std::expected<std::vector<std::byte>, SocketError> receiveFrame(int client_fd, const MessageHeader& header);
     
     // 发送消息
     std::expected<void, SocketError> sendMessage(int client_fd, const Message& message);
+
+    // 发送已序列化的完整帧
+    std::expected<void, SocketError> sendFrame(int client_fd, std::span<const std::byte> frame);
     
     // 断开客户端
     void disconnectClient(int client_fd);
@@ -49,8 +110,11 @@ public:
     bool isRunning() const { return running; }
 
 private:
+    // 按 idle_timeout 设置新连接的接收超时
+    void configureClient(int client_fd);
     std::expected<std::vector<std::byte>, SocketError> receiveBytes(int fd, size_t size);
-    std::expected<void, SocketError> sendBytes(int fd, const std::vector<std::byte>& data);
+    std::expected<void, SocketError> receiveInto(int fd, std::byte* dest, size_t size);
+    std::expected<void, SocketError> sendBytes(int fd, std::span<const std::byte> data);
 };
 
 } // namespace NET
\ No newline at end of file
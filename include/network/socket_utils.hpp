@@ -8,5 +8,7 @@ enum class SocketError {
     SEND_FAILED,
     RECV_FAILED,
     CONNECTION_CLOSED,
-    INVALID_ADDRESS
+    INVALID_ADDRESS,
+    UNSUPPORTED,        // 对端拒绝或当前连接不支持该操作
+    TIMEOUT             // 超过设定的收发超时
 };
\ No newline at end of file
@@ -0,0 +1,120 @@
+#ifndef ADMISSION_CONTROLLER_HPP
+#define ADMISSION_CONTROLLER_HPP
+
+#include "ServerStats.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+/**
+ * @brief 准入控制的配置。
+ */
+struct AdmissionConfig {
+  size_t maxConnections = 1024;    // 同时打开的连接数上限，超出的新连接立即被拒绝
+  size_t maxQueuedRequests = 1024; // 等待存储引擎的请求数上限，超出时立即拒绝
+  std::chrono::milliseconds queueTimeout{30000}; // 请求从到达到开始执行的最长等待，0 表示不限制
+  uint64_t maxResultRows = 0; // 单条查询最多返回的行数，0 表示不限制
+  uint64_t maxQueryBytes = 0; // 单条查询中间结果的内存预算，0 表示不限制
+};
+
+/**
+ * @brief 执行前对一条查询的估算。
+ * 只记录能在执行前确定的下限（例如不带 WHERE 的 SELECT 返回整张表），
+ * 带条件的查询由执行期间的行数和内存上限兜底。
+ */
+struct QueryEstimate {
+  uint64_t rows = 0;  // 至少返回的行数
+  uint64_t bytes = 0; // 这些行占用的内存（按表的平均行大小估算）
+};
+
+/**
+ * @brief 准入控制的计数快照。
+ */
+struct AdmissionStats {
+  size_t activeConnections = 0;
+  size_t peakConnections = 0;
+  uint64_t admittedConnections = 0;
+  uint64_t rejectedConnections = 0; // 连接数已达上限，立即拒绝
+  size_t queuedRequests = 0;
+  size_t peakQueuedRequests = 0;
+  uint64_t rejectedQueueFull = 0;  // 请求队列已满，立即拒绝
+  uint64_t expiredRequests = 0;    // 请求排队超时，未执行
+  uint64_t rejectedByEstimate = 0; // 执行前估算超出预算
+  uint64_t abortedOverBudget = 0;  // 执行期间超出行数或内存预算
+  LatencySummary requestWait;
+};
+
+/**
+ * @brief 服务端的准入控制：连接数上限、有界且限时的请求队列和单条查询的资源预算。
+ * 连接在事件循环上并发服务，存储引擎一次只执行一条语句，
+ * 请求在等待存储引擎时排队：队列已满时立即拒绝，排队超过 queueTimeout 的请求不再执行。
+ * 各方法可以从事件循环线程和执行语句的工作线程调用。
+ */
+class AdmissionController {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit AdmissionController(const AdmissionConfig &config = {});
+
+  const AdmissionConfig &config() const { return config_; }
+
+  // ---------- 连接 ----------
+
+  /**
+   * @brief 新连接到达时调用。
+   * @return 连接数已达上限时返回 false，调用方应拒绝该连接。
+   */
+  bool admitConnection();
+
+  void connectionClosed();
+
+  // ---------- 请求队列 ----------
+
+  /**
+   * @brief 请求开始等待存储引擎时调用。
+   * @return 队列已满时返回 false，调用方应直接回复繁忙。
+   */
+  bool enqueueRequest();
+
+  /**
+   * @brief 请求轮到执行时调用：出队并记录从到达开始的等待时间。
+   * @return 等待超过 queueTimeout 时返回 false，调用方应直接回复繁忙而不执行。
+   */
+  bool admitRequest(Clock::time_point arrivedAt, Clock::time_point now = Clock::now());
+
+  /**
+   * @brief 到达时刻为 arrivedAt 的请求最晚可以开始执行的时刻，不限制时为 Clock::time_point::max()。
+   */
+  Clock::time_point queueDeadline(Clock::time_point arrivedAt) const {
+    return config_.queueTimeout.count() > 0 ? arrivedAt + config_.queueTimeout
+                                            : Clock::time_point::max();
+  }
+
+  // ---------- 查询预算 ----------
+
+  /**
+   * @brief 执行前按估算检查预算。
+   * @return 超出预算时返回拒绝原因，否则返回 std::nullopt。
+   */
+  std::optional<std::string> checkEstimate(const QueryEstimate &estimate);
+
+  /**
+   * @brief 查询在执行期间因超出行数或内存预算而中止。
+   */
+  void recordBudgetAbort();
+
+  AdmissionStats stats() const;
+
+private:
+  static uint64_t elapsedNanos(Clock::time_point since, Clock::time_point now);
+
+  const AdmissionConfig config_;
+  mutable std::mutex mutex_;
+  AdmissionStats counters_; // 不含 requestWait，由 requestWait_ 汇总
+  LatencyHistogram requestWait_;
+};
+
+#endif // ADMISSION_CONTROLLER_HPP
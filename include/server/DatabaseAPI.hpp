@@ -1,13 +1,20 @@
 #ifndef DATABASE_API_HPP
 #define DATABASE_API_HPP
 
+#include "MemoryTracker.hpp"
+#include "QueryInterrupt.hpp"
 #include <algorithm> // For std::sort
+#include <cstdint>
 #include <map>
 #include <memory> // For std::unique_ptr
+#include <memory_resource>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+class TaskScheduler;
+
 /**
  * @brief 数据库中支持的数据类型枚举
  */
@@ -37,16 +44,27 @@ struct ColumnDefinition {
 
 /**
  * @brief 表示一行数据，每个元素是列值的字符串表示。
+ * @note 使用 pmr 容器，行和字符串从所在容器的内存资源分配，便于按表、按查询统计内存。
  */
-using Row = std::vector<std::string>;
+using Row = std::pmr::vector<std::pmr::string>;
 
 /**
  * @brief 内存中表示的表数据和元数据。
+ * @note 持有自己的内存资源，不可复制；请通过 DatabaseCoreImpl::addTable 创建。
  */
 struct TableData {
   std::string name;                      // 表名
   std::vector<ColumnDefinition> columns; // 列定义
-  std::vector<Row> rows;                 // 表的实际数据
+  std::unique_ptr<TrackingMemoryResource> memory; // 该表数据的内存统计节点
+  std::pmr::vector<Row> rows;                     // 表的实际数据
+
+  TableData() = default;
+  TableData(const std::string &tableName, TrackingMemoryResource *parent,
+            uint64_t limitBytes)
+      : name(tableName),
+        memory(std::make_unique<TrackingMemoryResource>("table:" + tableName,
+                                                        parent, limitBytes)),
+        rows(memory.get()) {}
 
   // 辅助函数：获取列的索引
   int getColumnIndex(const std::string &colName) const {
@@ -77,7 +95,38 @@ struct DatabaseCoreImpl {
   std::string currentDbName;        // 当前 'USE' 的数据库名
   bool isTransactionActive = false; // 标记当前是否有事务正在进行
   std::string transactionLogPath;   // 事务日志文件的路径
-  std::map<std::string, TableData> tables; // 内存中的表数据
+  TrackingMemoryResource memoryRoot{"server"}; // 内存统计的根节点，须先于 tables 声明
+  uint64_t tableMemoryLimit = 0;               // 每张表的内存上限，0 表示不限制
+  std::pmr::memory_resource *queryMemory = nullptr; // 当前查询的中间结果内存
+  QueryInterrupt *interrupt = nullptr; // 当前语句的取消状态，为空时不可取消
+  std::map<std::string, TableData> tables; // 内存中的表数据（当前数据库）
+  // 其他已加载过的数据库的表，USE 切换时与 tables 整体换入换出，
+  // 切换数据库不会丢弃尚未写回磁盘的修改
+  std::map<std::string, std::map<std::string, TableData>> inactiveDatabases;
+  uint64_t rowsScanned = 0; // DML 累计扫描的行数（供统计使用）
+  uint64_t queryRowLimit = 0; // 单条 SELECT 最多返回的行数，0 表示不限制
+  TaskScheduler *scheduler = nullptr; // 大表的扫描和排序在这里并行执行，为空时串行
+
+  /**
+   * @brief 在内存中创建一张空表（挂在 memoryRoot 下统计），已存在时先替换。
+   */
+  TableData &addTable(const std::string &tableName);
+
+  /**
+   * @brief 获取当前查询使用的内存资源，未设置时返回默认资源。
+   */
+  std::pmr::memory_resource *queryResource() const {
+    return queryMemory ? queryMemory : std::pmr::get_default_resource();
+  }
+
+  /**
+   * @brief 批边界处检查当前语句是否已被取消或超时，是则抛出 QueryCancelled。
+   */
+  void checkInterrupt() const {
+    if (interrupt) {
+      interrupt->check();
+    }
+  }
 };
 
 // 前向声明 QueryResult 类
@@ -123,6 +172,15 @@ public:
       : DatabaseException(message) {}
 };
 
+/**
+ * @brief 查询结果超过 setQueryRowLimit() 设置的行数上限时抛出的异常。
+ */
+class ResultLimitExceeded : public DatabaseException {
+public:
+  explicit ResultLimitExceeded(const std::string &message)
+      : DatabaseException(message) {}
+};
+
 /**
  * @brief 抽象基类，表示数据库查询的结果集。
  * 客户端通过此接口遍历和访问查询结果。
@@ -246,6 +304,7 @@ public:
 
 /**
  * @brief 负责数据操作语言 (DML) 操作，如插入、更新、删除和查询数据。
+ * 条件字符串的语法见 RowFilter.hpp，在扫描前编译一次，无法解析时抛出 SyntaxException。
  */
 class DMLOperations {
 public:
@@ -344,6 +403,14 @@ public:
  * @brief 数据库操作核心类。
  * 作为所有数据库功能的统一入口。
  */
+/**
+ * @brief 一张表的统计信息。
+ */
+struct TableStatistics {
+  uint64_t rowCount = 0;
+  uint64_t bytesInUse = 0; // 表数据占用的内存
+};
+
 class Database {
 public:
   /**
@@ -375,6 +442,67 @@ public:
    */
   TransactionManager &getTransactionManager();
 
+  /**
+   * @brief 获取 DML 操作累计扫描的行数。
+   * @note 调用方可以在执行前后各取一次，差值即为该次操作扫描的行数。
+   * @return 累计扫描行数。
+   */
+  uint64_t getRowsScanned() const;
+
+  /**
+   * @brief 获取内存统计的根节点（整个服务器的用量和上限）。
+   * @note 会话、查询的统计节点应以它为父节点。
+   */
+  TrackingMemoryResource &getMemoryRoot();
+
+  /**
+   * @brief 设置每张表的内存上限。
+   * @note 对已加载的表立即生效，之后创建或加载的表也会使用该上限。
+   * @param limitBytes 上限字节数，0 表示不限制。
+   */
+  void setTableMemoryLimit(uint64_t limitBytes);
+
+  /**
+   * @brief 设置当前查询的内存资源，查询结果集等中间数据从这里分配。
+   * @param resource 内存资源，传 nullptr 恢复为默认资源。
+   * @return 之前设置的资源。
+   */
+  std::pmr::memory_resource *
+  setQueryMemoryResource(std::pmr::memory_resource *resource);
+
+  /**
+   * @brief 设置语句的中断状态，之后的扫描和排序在批边界检查它。
+   * @note 由调用方在每条语句开始前调用 QueryInterrupt::start()。
+   * @param interrupt 中断状态，传 nullptr 表示语句不可取消。
+   * @return 之前设置的中断状态。
+   */
+  QueryInterrupt *setQueryInterrupt(QueryInterrupt *interrupt);
+
+  /**
+   * @brief 获取当前数据库中各表的内存使用情况（按表名排序）。
+   */
+  std::vector<MemoryUsage> getTableMemoryUsage() const;
+
+  /**
+   * @brief 获取当前数据库中某张表的行数和内存用量，供执行前估算查询的代价。
+   * @return 表不存在或未加载时返回 std::nullopt。
+   */
+  std::optional<TableStatistics>
+  getTableStatistics(const std::string &tableName) const;
+
+  /**
+   * @brief 设置单条 SELECT 最多返回的行数，超出时抛出 ResultLimitExceeded。
+   * @param maxRows 行数上限，0 表示不限制。
+   */
+  void setQueryRowLimit(uint64_t maxRows);
+
+  /**
+   * @brief 设置并行执行使用的调度器，之后对大表的 SELECT 扫描和排序拆分成任务并行执行。
+   * @note 调度器由调用方持有，须比 Database 活得久。
+   * @param scheduler 调度器，传 nullptr 恢复为串行执行。
+   */
+  void setTaskScheduler(TaskScheduler *scheduler);
+
 private:
   // Database 现在直接管理 DatabaseCoreImpl，而不是通过一个嵌套的 Impl 类
   std::unique_ptr<DatabaseCoreImpl> core_state_pImpl; // 命名更清晰
@@ -0,0 +1,72 @@
+#ifndef LIKE_PATTERN_HPP
+#define LIKE_PATTERN_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief 编译后的 LIKE / ILIKE 模式。
+ *
+ * % 匹配任意长度（可以为空）的字符序列，_ 匹配一个字符（按 UTF-8 编码计），
+ * 反斜杠转义其后的一个字符。ILIKE 只对 ASCII 字母忽略大小写。
+ *
+ * 编译时按模式的形状选择匹配方式：
+ *   abc     EXACT          整体比较
+ *   abc%    PREFIX         比较开头
+ *   %abc    SUFFIX         比较结尾
+ *   ab%yz   PREFIX_SUFFIX  分别比较开头和结尾
+ *   %abc%   CONTAINS       子串查找：x86 上用 SSE2 / AVX2 一次比较 16 / 32 个位置的
+ *                          首尾字节筛出候选位置，再逐个比较中间部分
+ *   %       ANY            匹配所有值
+ *   其他    NFA            位并行（Shift-And）的 NFA，每个输入字节几条位运算；
+ *                          去掉 % 后超过 63 个元素的模式改用回溯匹配
+ * 编译后只读，可以被多个线程同时使用。
+ */
+class LikePattern {
+public:
+  enum class Strategy {
+    EXACT,
+    PREFIX,
+    SUFFIX,
+    PREFIX_SUFFIX,
+    CONTAINS,
+    ANY,
+    NFA
+  };
+
+  LikePattern(std::string_view pattern, bool caseInsensitive);
+
+  bool matches(std::string_view text) const;
+
+  Strategy strategy() const { return strategy_; }
+
+private:
+  // 模式去掉转义后的元素序列，连续的 % 合并为一个
+  struct Element {
+    enum class Kind : uint8_t { LITERAL, ANY_CHAR, ANY_SEQUENCE };
+    Kind kind;
+    char byte = 0; // 仅 LITERAL；ILIKE 时已转为小写
+  };
+
+  void compileNfa();
+  bool matchNfa(std::string_view text) const;
+  bool matchBacktracking(std::string_view text) const;
+
+  Strategy strategy_ = Strategy::NFA;
+  bool caseInsensitive_;
+  std::string prefix_; // EXACT、PREFIX、PREFIX_SUFFIX 的开头；CONTAINS 的子串
+  std::string suffix_; // SUFFIX、PREFIX_SUFFIX 的结尾
+  std::vector<Element> elements_;
+
+  // NFA：状态 j 表示已匹配去掉 % 之后的前 j 个元素
+  bool useNfa_ = false;
+  std::array<uint64_t, 256> accepts_{}; // accepts_[c] 的第 j 位：第 j 个元素接受字节 c
+  uint64_t loops_ = 0;     // 其后有 % 的状态，读入任意字节后保持
+  uint64_t anyChars_ = 0;  // 刚匹配了 _ 的状态，读入 UTF-8 后续字节后保持
+  uint64_t accepting_ = 0; // 匹配完所有元素的状态
+};
+
+#endif // LIKE_PATTERN_HPP
@@ -0,0 +1,95 @@
+#ifndef MEMORY_TRACKER_HPP
+#define MEMORY_TRACKER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <utility>
+
+/**
+ * @brief 分配会超出某个统计节点的内存上限时抛出。
+ * 继承 std::bad_alloc，使标准容器按分配失败处理（强异常保证的操作不会改动数据）。
+ */
+class MemoryLimitExceeded : public std::bad_alloc {
+public:
+  explicit MemoryLimitExceeded(std::string message)
+      : message_(std::move(message)) {}
+
+  const char *what() const noexcept override { return message_.c_str(); }
+
+private:
+  std::string message_;
+};
+
+/**
+ * @brief 某个统计节点的内存使用快照。
+ */
+struct MemoryUsage {
+  std::string name;
+  uint64_t bytesInUse = 0;  // 当前占用的字节数
+  uint64_t peakBytes = 0;   // 历史峰值
+  uint64_t allocations = 0; // 累计分配次数
+  uint64_t limitBytes = 0;  // 上限，0 表示不限制
+};
+
+/**
+ * @brief 带统计和上限的 pmr 内存资源。
+ * 节点之间组成一棵统计树（服务器 -> 表 / 会话 -> 查询），每次分配都会计入
+ * 自身及所有祖先节点；任何一个节点超出上限时回滚计数并抛出
+ * MemoryLimitExceeded。实际的内存由 upstream 提供，父节点只参与统计。
+ */
+class TrackingMemoryResource : public std::pmr::memory_resource {
+public:
+  /**
+   * @param name 节点名称（出现在错误信息和 SHOW MEMORY 中）。
+   * @param parent 统计上的父节点，可为空。
+   * @param limitBytes 内存上限，0 表示不限制。
+   * @param upstream 实际分配内存的资源。
+   */
+  explicit TrackingMemoryResource(
+      std::string name, TrackingMemoryResource *parent = nullptr,
+      uint64_t limitBytes = 0,
+      std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+
+  TrackingMemoryResource(const TrackingMemoryResource &) = delete;
+  TrackingMemoryResource &operator=(const TrackingMemoryResource &) = delete;
+
+  const std::string &name() const { return name_; }
+
+  uint64_t bytesInUse() const {
+    return bytesInUse_.load(std::memory_order_relaxed);
+  }
+  uint64_t peakBytes() const {
+    return peakBytes_.load(std::memory_order_relaxed);
+  }
+  uint64_t limit() const { return limitBytes_.load(std::memory_order_relaxed); }
+  void setLimit(uint64_t limitBytes) {
+    limitBytes_.store(limitBytes, std::memory_order_relaxed);
+  }
+
+  MemoryUsage usage() const;
+
+private:
+  void *do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void *p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(
+      const std::pmr::memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  // 计入自身及祖先节点，超限时回滚并抛出异常
+  void charge(size_t bytes);
+  void release(size_t bytes);
+
+  std::string name_;
+  TrackingMemoryResource *parent_;
+  std::pmr::memory_resource *upstream_;
+  std::atomic<uint64_t> limitBytes_;
+  std::atomic<uint64_t> bytesInUse_{0};
+  std::atomic<uint64_t> peakBytes_{0};
+  std::atomic<uint64_t> allocations_{0};
+};
+
+#endif // MEMORY_TRACKER_HPP
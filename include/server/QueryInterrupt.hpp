@@ -0,0 +1,65 @@
+#ifndef QUERY_INTERRUPT_HPP
+#define QUERY_INTERRUPT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+/**
+ * @brief 语句被取消或超过 statement_timeout 时由 QueryInterrupt::check() 抛出。
+ * 抛出时语句尚未产生任何可见的修改（UPDATE/DELETE 会先撤销已做的改动）。
+ */
+class QueryCancelled : public std::runtime_error {
+public:
+  enum class Reason {
+    USER_REQUEST,     // 客户端发送了 CANCEL
+    STATEMENT_TIMEOUT // 超过 statement_timeout
+  };
+
+  explicit QueryCancelled(Reason reason);
+
+  Reason reason() const { return reason_; }
+
+private:
+  Reason reason_;
+};
+
+/**
+ * @brief 当前语句的中断状态。
+ * 扫描和排序在每批行的边界调用 check()，已取消或超时则抛出 QueryCancelled。
+ * 服务端的事件循环线程在收到 CANCEL 或连接断开时、嵌入式接口在 cancel() 中调用
+ * cancel()，语句在执行它的线程上于下一个批边界中止。cancel() 可以从其他线程调用，
+ * check() 可以由并行执行同一语句的多个线程同时调用；start() 只应在语句开始执行
+ * 之前调用。
+ */
+class QueryInterrupt {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * @brief 开始执行一条新语句：清除取消标记并设置截止时间。
+   * 应在可以对该语句调用 cancel() 之前调用，否则更早到达的取消会被清除。
+   * @param timeout 语句的最长执行时间，0 表示不限制。
+   */
+  void start(std::chrono::milliseconds timeout);
+
+  /**
+   * @brief 请求取消当前语句，在下一个批边界生效。线程安全。
+   */
+  void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  bool isCancelled() const {
+    return cancelled_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief 批边界处调用：已取消或超时则抛出 QueryCancelled。
+   */
+  void check();
+
+private:
+  std::atomic<bool> cancelled_{false};
+  Clock::time_point deadline_ = Clock::time_point::max();
+};
+
+#endif // QUERY_INTERRUPT_HPP
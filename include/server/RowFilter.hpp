@@ -0,0 +1,57 @@
+#ifndef ROW_FILTER_HPP
+#define ROW_FILTER_HPP
+
+#include "DatabaseAPI.hpp"
+#include <memory>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief 编译后的 WHERE 条件。
+ *
+ * 条件字符串（例如 "age > 30 AND city = 'New York'"）在语句开始时解析一次：
+ * 列名解析为下标，字面量按列的类型转换好，扫描时每行只做类型化的比较。
+ * 支持的谓词：
+ *   col op value              op 为 =、!=、<>、<、<=、>、>=
+ *   col IN (v1, v2, ...)      列表较长时在预先构建的哈希集合中查找
+ *   col BETWEEN low AND high  闭区间，一次范围检查
+ *   col LIKE / ILIKE pattern  按列中保存的文本匹配，模式的编译见 LikePattern
+ *   col NOT IN (...)、col NOT BETWEEN low AND high、col NOT LIKE / NOT ILIKE pattern
+ * 谓词之间用 NOT / AND / OR 组合，优先级依次降低，可以用括号改变结合顺序（最多嵌套 64 层）；
+ * 关键字不区分大小写。
+ * 字符串字面量用单引号括起，内部的单引号写成两个（见 quote()），数字可以不加引号。
+ *
+ * 引用不存在的列、字面量无法转换为列类型的比较不匹配任何行；NOT 只是对结果取反，
+ * 因此对这类谓词取 NOT 会匹配所有行。
+ * 编译后只读，并行扫描的各个任务可以共用同一个 RowFilter。
+ */
+class RowFilter {
+public:
+  /**
+   * @brief 编译条件字符串，空字符串匹配所有行。
+   * @throws SyntaxException 条件字符串无法解析。
+   */
+  RowFilter(const TableData &table, const std::string &condition);
+  ~RowFilter();
+
+  RowFilter(const RowFilter &) = delete;
+  RowFilter &operator=(const RowFilter &) = delete;
+
+  bool matches(const Row &row) const { return !root_ || root_->matches(row); }
+
+  /**
+   * @brief 把值写成条件字符串中的字符串字面量：加单引号，内部的单引号写成两个。
+   */
+  static std::string quote(std::string_view value);
+
+  // 条件树的节点，具体的谓词和逻辑运算在 RowFilter.cpp 中实现
+  struct Node {
+    virtual ~Node() = default;
+    virtual bool matches(const Row &row) const = 0;
+  };
+
+private:
+  std::unique_ptr<Node> root_;
+};
+
+#endif // ROW_FILTER_HPP
@@ -0,0 +1,185 @@
+#ifndef SERVER_STATS_HPP
+#define SERVER_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief 一次请求在服务端经历的各个阶段。
+ */
+enum class QueryStage : uint8_t {
+  RECEIVE,   // 接收消息载荷
+  PARSE,     // 反序列化请求
+  PLAN,      // 将请求翻译为存储层调用参数
+  EXECUTE,   // 执行 DDL/DML 并构建结果
+  SERIALIZE, // 序列化响应
+  SEND,      // 发送响应
+  TOTAL,     // 以上阶段之和
+  COUNT
+};
+
+constexpr size_t QUERY_STAGE_COUNT = static_cast<size_t>(QueryStage::COUNT);
+
+/**
+ * @brief 获取阶段名称（用于 SHOW STATS 输出）。
+ */
+const char *queryStageName(QueryStage stage);
+
+/**
+ * @brief 单个请求的分阶段耗时与计数，由请求处理流程逐步填充。
+ */
+struct QueryTimings {
+  std::array<uint64_t, QUERY_STAGE_COUNT> stageNanos{};
+  uint64_t rowsScanned = 0;
+  uint64_t rowsReturned = 0;
+  uint64_t bytesSent = 0;
+
+  void add(QueryStage stage, std::chrono::steady_clock::duration elapsed) {
+    stageNanos[static_cast<size_t>(stage)] += static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+  uint64_t get(QueryStage stage) const {
+    return stageNanos[static_cast<size_t>(stage)];
+  }
+
+  // 汇总除 TOTAL 外的所有阶段
+  uint64_t totalNanos() const;
+};
+
+/**
+ * @brief RAII 计时器，析构时把经过的时间累加到指定阶段。
+ */
+class StageTimer {
+public:
+  StageTimer(QueryTimings &timings, QueryStage stage)
+      : timings_(timings), stage_(stage),
+        start_(std::chrono::steady_clock::now()) {}
+  ~StageTimer() {
+    timings_.add(stage_, std::chrono::steady_clock::now() - start_);
+  }
+
+  StageTimer(const StageTimer &) = delete;
+  StageTimer &operator=(const StageTimer &) = delete;
+
+private:
+  QueryTimings &timings_;
+  QueryStage stage_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * @brief 直方图的只读汇总（微秒）。
+ */
+struct LatencySummary {
+  uint64_t count = 0;
+  double meanMicros = 0;
+  double p50Micros = 0;
+  double p90Micros = 0;
+  double p99Micros = 0;
+  double maxMicros = 0;
+};
+
+/**
+ * @brief HDR 风格的延迟直方图（单位：纳秒）。
+ * 每个 2 的幂区间再线性划分为 16 个子桶，相对误差不超过 1/16。
+ * 记录操作只有一次 relaxed 原子自增，可以常开。
+ */
+class LatencyHistogram {
+public:
+  static constexpr unsigned SUB_BUCKET_BITS = 4;
+  static constexpr uint64_t SUB_BUCKET_COUNT = 1ull << SUB_BUCKET_BITS;
+  static constexpr size_t BUCKET_COUNT =
+      (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  void record(uint64_t nanos);
+
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 估算给定分位点的值。
+   * @param quantile 取值范围 [0, 1]，例如 0.99。
+   * @return 所在桶的中点（纳秒），无数据时返回 0。
+   */
+  uint64_t percentile(double quantile) const;
+
+  /**
+   * @brief 汇总为均值、分位点和最大值（微秒）。
+   */
+  LatencySummary summary() const;
+
+  static size_t bucketIndex(uint64_t value);
+  static uint64_t bucketLowerBound(size_t index);
+  static uint64_t bucketUpperBound(size_t index);
+
+private:
+  std::array<std::atomic<uint64_t>, BUCKET_COUNT> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+  std::atomic<uint64_t> max_{0};
+};
+
+/**
+ * @brief 某个（操作类型, 表）组合的累计统计快照。
+ */
+struct OperationStatsSnapshot {
+  std::string operation;
+  std::string table;
+  std::array<LatencySummary, QUERY_STAGE_COUNT> stages;
+  uint64_t rowsScanned = 0;
+  uint64_t rowsReturned = 0;
+  uint64_t bytesSent = 0;
+};
+
+/**
+ * @brief 服务端统计中心，按操作类型和表聚合请求的阶段耗时和计数器。
+ * 读多写少：已有条目在共享锁下查找，只有首次出现的组合才需要独占锁。
+ */
+class ServerStats {
+public:
+  /**
+   * @brief 记录一次完成的请求。
+   * @param operation 操作类型名称（例如 "SELECT"）。
+   * @param table 表名，非表操作可传空字符串。
+   * @param timings 该请求的分阶段耗时与计数。
+   */
+  void record(const std::string &operation, const std::string &table,
+              const QueryTimings &timings);
+
+  /**
+   * @brief 获取所有条目的快照，按操作类型和表名排序。
+   */
+  std::vector<OperationStatsSnapshot> snapshot() const;
+
+  /**
+   * @brief 清空所有统计。
+   */
+  void reset();
+
+private:
+  struct OperationStats {
+    std::string operation;
+    std::string table;
+    std::array<LatencyHistogram, QUERY_STAGE_COUNT> stages;
+    std::atomic<uint64_t> rowsScanned{0};
+    std::atomic<uint64_t> rowsReturned{0};
+    std::atomic<uint64_t> bytesSent{0};
+  };
+
+  OperationStats &lookup(const std::string &operation,
+                         const std::string &table);
+
+  mutable std::shared_mutex mutex_;
+  std::unordered_map<std::string, std::unique_ptr<OperationStats>> entries_;
+};
+
+#endif // SERVER_STATS_HPP
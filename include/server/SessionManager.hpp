@@ -0,0 +1,108 @@
+#ifndef SESSION_MANAGER_HPP
+#define SESSION_MANAGER_HPP
+
+#include "MemoryTracker.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief 一个登录会话的状态。
+ * 令牌只用于认证，日志、统计和内存节点名中使用 id，避免泄露令牌。
+ * 除 lastActiveNanos 外的字段只由处理该会话请求的线程访问。
+ */
+struct Session {
+  uint64_t id = 0;
+  std::string token;
+  std::string username;
+  uint64_t connectionId = 0;     // 登录所在的连接，令牌只在该连接上有效
+  uint16_t protocolVersion = 1;  // 登录时协商的协议版本
+  uint32_t capabilities = 0;     // 登录时协商的能力位
+  std::string database;          // 会话 USE 的数据库，为空表示尚未选择
+  std::chrono::milliseconds statementTimeout{0}; // SET statement_timeout
+  std::unique_ptr<TrackingMemoryResource> memory; // 会话内存统计节点
+  std::atomic<int64_t> lastActiveNanos{0};       // 最近一次请求（steady_clock）
+};
+
+/**
+ * @brief 会话管理：令牌到会话的并发哈希表。
+ * 令牌为 128 位密码学随机数的十六进制形式。表按令牌哈希分成 SHARD_COUNT 个分片，
+ * 每个分片各自加锁，认证一次请求只锁一个分片、做一次哈希查找，没有全局锁。
+ * 空闲超过 idleTimeout 的会话在下一次查找时失效，create() 顺带清理所在分片。
+ */
+class SessionManager {
+public:
+  static constexpr size_t SHARD_COUNT = 64;
+  static constexpr size_t TOKEN_BYTES = 16;
+
+  /**
+   * @param idleTimeout 会话空闲超过该时长即失效，0 表示不限制。
+   */
+  explicit SessionManager(std::chrono::seconds idleTimeout = std::chrono::seconds(0));
+
+  SessionManager(const SessionManager &) = delete;
+  SessionManager &operator=(const SessionManager &) = delete;
+
+  /**
+   * @brief 创建会话并分配新令牌。
+   * @throws std::runtime_error 系统随机数源不可用。
+   */
+  std::shared_ptr<Session> create(const std::string &username,
+                                  uint64_t connectionId);
+
+  /**
+   * @brief 按令牌查找会话并刷新活跃时间。
+   * @return 令牌无效、已过期或不属于该连接时返回空指针。
+   */
+  std::shared_ptr<Session> find(std::string_view token, uint64_t connectionId);
+
+  /**
+   * @brief 注销会话，令牌立即失效。
+   */
+  bool remove(std::string_view token);
+
+  /**
+   * @brief 清理所有分片中已过期的会话，返回清理的数量。
+   */
+  size_t removeExpired();
+
+  size_t size() const;
+
+  /**
+   * @brief 生成一个新的随机令牌（getrandom）。
+   */
+  static std::string generateToken();
+
+private:
+  struct TokenHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view token) const {
+      return std::hash<std::string_view>{}(token);
+    }
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, std::shared_ptr<Session>, TokenHash,
+                       std::equal_to<>>
+        sessions;
+  };
+
+  Shard &shardFor(std::string_view token);
+  bool expired(const Session &session, int64_t nowNanos) const;
+  size_t removeExpiredLocked(Shard &shard, int64_t nowNanos);
+
+  std::array<Shard, SHARD_COUNT> shards_;
+  int64_t idleTimeoutNanos_;
+  std::atomic<uint64_t> nextId_{1};
+};
+
+#endif // SESSION_MANAGER_HPP
@@ -0,0 +1,96 @@
+#ifndef SLOW_QUERY_LOG_HPP
+#define SLOW_QUERY_LOG_HPP
+
+#include "ServerStats.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief 慢查询日志配置。
+ */
+struct SlowQueryLogConfig {
+  std::string path = "slow_query.log"; // 日志文件路径
+  int64_t thresholdMicros = -1;        // 阈值（微秒），小于 0 表示关闭
+  uint64_t maxFileBytes = 64ull * 1024 * 1024; // 单个文件达到该大小后轮转
+  unsigned maxFiles = 5;       // 保留的历史文件数量（path.1 ~ path.N）
+  size_t maxQueueSize = 10000; // 待写队列上限，写满后丢弃新条目
+};
+
+/**
+ * @brief 一条慢查询记录。
+ */
+struct SlowQueryEntry {
+  std::chrono::system_clock::time_point timestamp;
+  std::string session;
+  std::string statement;
+  QueryTimings timings;
+};
+
+/**
+ * @brief 慢查询日志。
+ * 请求线程只负责判断阈值并入队，格式化、写文件和轮转都在后台线程完成，
+ * 因此可以在生产环境常开。
+ */
+class SlowQueryLog {
+public:
+  explicit SlowQueryLog(SlowQueryLogConfig config = {});
+  ~SlowQueryLog(); // 写完剩余条目后退出后台线程
+
+  SlowQueryLog(const SlowQueryLog &) = delete;
+  SlowQueryLog &operator=(const SlowQueryLog &) = delete;
+
+  /**
+   * @brief 是否启用慢查询日志。
+   */
+  bool enabled() const { return config_.thresholdMicros >= 0; }
+
+  /**
+   * @brief 判断总耗时是否超过阈值。
+   * @param totalNanos 请求总耗时（纳秒）。
+   */
+  bool isSlow(uint64_t totalNanos) const {
+    return enabled() &&
+           totalNanos >= static_cast<uint64_t>(config_.thresholdMicros) * 1000;
+  }
+
+  /**
+   * @brief 提交一条记录，不阻塞调用方。
+   * @return 成功入队返回 true；队列已满被丢弃时返回 false。
+   */
+  bool submit(SlowQueryEntry entry);
+
+  /**
+   * @brief 获取因队列已满而丢弃的条目数。
+   */
+  uint64_t droppedCount() const {
+    return dropped_.load(std::memory_order_relaxed);
+  }
+
+  const SlowQueryLogConfig &config() const { return config_; }
+
+private:
+  void run();
+  void write(const SlowQueryEntry &entry);
+  void rotate();
+  void openFile();
+
+  SlowQueryLogConfig config_;
+  std::ofstream file_;
+  uint64_t fileBytes_ = 0;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<SlowQueryEntry> queue_;
+  bool stopping_ = false;
+  std::atomic<uint64_t> dropped_{0};
+  std::thread worker_;
+};
+
+#endif // SLOW_QUERY_LOG_HPP
@@ -0,0 +1,187 @@
+#ifndef TASK_SCHEDULER_HPP
+#define TASK_SCHEDULER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief 任务优先级。工作线程总是先找高优先级的任务（包括从其他线程窃取），
+ * 没有时才执行低一级的任务；已经开始执行的任务不会被抢占。
+ */
+enum class TaskPriority {
+  HIGH,      // 请求处理路径上的工作，例如语句执行和并行扫描
+  NORMAL,    // 默认
+  BACKGROUND // 后台维护，只在没有其他任务时执行
+};
+
+/**
+ * @brief 调度器的配置。
+ */
+struct SchedulerConfig {
+  size_t threads = 0;      // 工作线程数，0 表示与可用的 CPU 数相同
+  bool pinThreads = false; // 把工作线程依次绑定到 CPU，按 NUMA 节点分组
+};
+
+/**
+ * @brief 调度器的计数快照。
+ */
+struct SchedulerStats {
+  size_t threads = 0;
+  size_t numaNodes = 0;           // 工作线程分布的 NUMA 节点数（未绑定时为 1）
+  uint64_t tasksExecuted = 0;     // 执行完成的任务数
+  uint64_t tasksStolen = 0;       // 从其他工作线程窃取后执行的任务数
+  uint64_t tasksCancelled = 0;    // 所属任务组已取消、未执行就丢弃的任务数
+  uint64_t externalSubmissions = 0; // 从工作线程以外提交的任务数
+};
+
+class TaskGroup;
+
+/**
+ * @brief 工作窃取的线程池，服务端所有 CPU 并行工作都提交到这里。
+ *
+ * 每个工作线程为每个优先级持有一个 Chase-Lev 双端队列：本线程提交的任务压入
+ * 自己的队列底部并从底部取出（后进先出，缓存友好），空闲的线程从其他线程队列的
+ * 顶部窃取（先进先出，窃取到的通常是较大的任务）。工作线程以外提交的任务进入
+ * 按优先级划分的共享队列。开启绑定时窃取优先选择同一 NUMA 节点上的线程。
+ *
+ * 任务按 TaskGroup 组织：组可以等待、取消，并把任务抛出的第一个异常交给等待者。
+ * 取消是协作式的：尚未开始的任务被丢弃，正在执行的任务通过
+ * TaskGroup::isCancelled() 或 TaskScheduler::cancellationRequested() 自行检查并提前返回。
+ */
+class TaskScheduler {
+public:
+  explicit TaskScheduler(const SchedulerConfig &config = {});
+
+  /**
+   * @brief 执行完已提交的任务后停止工作线程。
+   */
+  ~TaskScheduler();
+
+  TaskScheduler(const TaskScheduler &) = delete;
+  TaskScheduler &operator=(const TaskScheduler &) = delete;
+
+  /**
+   * @brief 提交一个不属于任何组的任务。任务抛出的异常被记录到标准错误后丢弃。
+   * @note 可以从任意线程调用。
+   */
+  void submit(std::function<void()> fn,
+              TaskPriority priority = TaskPriority::NORMAL);
+
+  size_t threadCount() const { return workers_.size(); }
+
+  /**
+   * @brief 当前线程是否为本调度器的工作线程。
+   */
+  bool onWorkerThread() const;
+
+  /**
+   * @brief 当前正在执行的任务所属的组是否已被取消；不在任务中时返回 false。
+   */
+  static bool cancellationRequested();
+
+  SchedulerStats stats() const;
+
+private:
+  friend class TaskGroup;
+
+  struct Task {
+    std::function<void()> fn;
+    TaskGroup *group = nullptr;
+    TaskPriority priority = TaskPriority::NORMAL;
+  };
+  struct Worker;
+
+  static constexpr size_t PRIORITY_LEVELS = 3;
+
+  void enqueue(Task *task);
+  // 找一个任务并执行，没有任务时返回 false；self 为当前工作线程的下标，其他线程传 -1
+  bool runOne(int self);
+  Task *findTask(int self);
+  Task *stealFrom(int self, size_t level);
+  void execute(Task *task, bool stolen);
+  void workerLoop(size_t index);
+  void pinWorkers();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  size_t numaNodes_ = 1;
+
+  // 工作线程以外提交的任务
+  std::mutex mutex_;
+  std::deque<Task *> injected_[PRIORITY_LEVELS];
+  std::atomic<size_t> injectedCount_{0}; // injected_ 中的任务数，为 0 时不必加锁查看
+  std::condition_variable wakeup_;
+  std::atomic<size_t> queued_{0};   // 已提交、尚未被取走的任务数
+  std::atomic<size_t> sleeping_{0}; // 正在 wakeup_ 上等待的工作线程数
+  bool stopping_ = false;           // 由 mutex_ 保护
+
+  std::atomic<uint64_t> cancelled_{0};
+  std::atomic<uint64_t> external_{0};
+};
+
+/**
+ * @brief 一组相关的任务，可以一起等待和取消。
+ *
+ * @code
+ *   TaskGroup group(scheduler);
+ *   for (auto &chunk : chunks) {
+ *     group.run([&chunk] { process(chunk); });
+ *   }
+ *   group.wait(); // 重新抛出第一个失败任务的异常
+ * @endcode
+ *
+ * 任务可以在组内继续提交任务。任何任务抛出异常时组被取消，尚未开始的任务不再执行。
+ */
+class TaskGroup {
+public:
+  explicit TaskGroup(TaskScheduler &scheduler,
+                     TaskPriority priority = TaskPriority::HIGH);
+
+  /**
+   * @brief 仍有未完成的任务时取消并等待它们结束，忽略它们的异常。
+   */
+  ~TaskGroup();
+
+  TaskGroup(const TaskGroup &) = delete;
+  TaskGroup &operator=(const TaskGroup &) = delete;
+
+  void run(std::function<void()> fn);
+
+  /**
+   * @brief 等待组内所有任务结束。等待期间当前线程也执行调度器中的任务，
+   * 因此可以在任务内部等待嵌套的组而不会耗尽工作线程。
+   * @throws 组内第一个失败任务抛出的异常。
+   */
+  void wait();
+
+  /**
+   * @brief 请求取消：尚未开始的任务被丢弃，正在执行的任务应检查 isCancelled()。
+   */
+  void cancel() { cancelled_.store(true, std::memory_order_relaxed); }
+
+  bool isCancelled() const { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+  friend class TaskScheduler;
+
+  void taskFinished(std::exception_ptr error);
+  // 等待 pending_ 归零（期间帮忙执行任务），不抛出异常
+  void join();
+
+  TaskScheduler &scheduler_;
+  const TaskPriority priority_;
+  std::atomic<size_t> pending_{0};
+  std::atomic<bool> cancelled_{false};
+  std::mutex mutex_;
+  std::condition_variable finished_;
+  std::exception_ptr error_; // 由 mutex_ 保护
+};
+
+#endif // TASK_SCHEDULER_HPP
@@ -0,0 +1,143 @@
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // 用于 __rdtsc
+#endif
+
+/**
+ * @brief 读取高精度时钟计数。
+ * x86 上使用 RDTSC（只需几个周期），其他平台退化为 steady_clock 纳秒。
+ */
+inline uint64_t readTraceTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return static_cast<uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/**
+ * @brief 单线程写、任意线程读的定长环形缓冲区，写满后覆盖最旧的 span。
+ * 槽位字段使用 relaxed 原子量，读者通过写指针前后两次比对丢弃被覆盖的数据。
+ */
+class TraceBuffer {
+public:
+  struct Span {
+    const char *name;
+    uint64_t startTicks;
+    uint64_t endTicks;
+  };
+
+  TraceBuffer(uint32_t threadId, size_t capacity);
+
+  void push(const char *name, uint64_t startTicks, uint64_t endTicks);
+
+  /**
+   * @brief 复制当前仍有效的 span（按写入顺序）。
+   */
+  std::vector<Span> snapshot() const;
+
+  uint32_t threadId() const { return threadId_; }
+
+private:
+  struct Slot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<uint64_t> startTicks{0};
+    std::atomic<uint64_t> endTicks{0};
+  };
+
+  uint32_t threadId_;
+  std::unique_ptr<Slot[]> slots_;
+  size_t capacity_;
+  std::atomic<uint64_t> writeIndex_{0};
+};
+
+/**
+ * @brief 全局追踪器，管理所有线程的环形缓冲区并导出 Chrome trace-event JSON。
+ * 关闭时 TraceScope 只有一次 relaxed 读和一次分支。
+ */
+class Tracer {
+public:
+  static Tracer &instance();
+
+  /**
+   * @brief 开启或关闭追踪。
+   * @param spansPerThread 每个线程环形缓冲区的容量，仅对之后新注册的线程生效。
+   */
+  void setEnabled(bool enabled, size_t spansPerThread = 65536);
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief 获取当前线程的缓冲区（首次调用时注册）。
+   */
+  TraceBuffer &threadBuffer();
+
+  /**
+   * @brief 以 Chrome trace-event 格式（chrome://tracing、Perfetto 可直接打开）导出。
+   * @return 导出的 span 数量。
+   */
+  size_t exportChromeJson(std::ostream &out) const;
+
+  /**
+   * @brief 导出到文件。
+   * @param path 目标文件路径（覆盖写）。
+   * @param spanCount 输出参数，导出的 span 数量。
+   * @return 无法打开文件时返回 false。
+   */
+  bool exportChromeJson(const std::string &path, size_t &spanCount) const;
+
+  size_t threadCount() const;
+
+private:
+  Tracer();
+
+  // 每微秒的计数值：用构造以来经过的时间校准，每次导出只估算一次
+  double ticksPerMicro() const;
+  // 计数值到微秒的换算，以构造时刻为基准
+  double ticksToMicros(uint64_t ticks, double ticksPerMicro) const;
+
+  std::atomic<bool> enabled_{false};
+  size_t spansPerThread_ = 65536;
+  uint64_t baseTicks_;
+  std::chrono::steady_clock::time_point baseTime_;
+
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<TraceBuffer>> buffers_;
+};
+
+/**
+ * @brief RAII span：构造时记下起点，析构时写入当前线程的缓冲区。
+ * @note name 必须是静态生命周期的字符串（通常是字面量）。
+ */
+class TraceScope {
+public:
+  explicit TraceScope(const char *name)
+      : name_(Tracer::instance().enabled() ? name : nullptr),
+        start_(name_ ? readTraceTicks() : 0) {}
+
+  ~TraceScope() {
+    if (name_) {
+      Tracer::instance().threadBuffer().push(name_, start_, readTraceTicks());
+    }
+  }
+
+  TraceScope(const TraceScope &) = delete;
+  TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+  const char *name_;
+  uint64_t start_;
+};
+
+#endif // TRACE_HPP
@@ -6,22 +6,71 @@
 #include "../../include/network/socket_client.hpp"
 #include "../../include/network/query.hpp"
 #include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+#include <csignal>
+#include <deque>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <pthread.h>
+
+namespace {
+
+// 批处理模式下已发送但未收到响应的请求字节数上限：保持在套接字缓冲区之内，
+// 服务端写响应时不会因为我们还在发送而互相阻塞
+constexpr size_t MAX_IN_FLIGHT_BYTES = 64 * 1024;
+
+// 结果集每批输出的行数
+constexpr size_t RENDER_BATCH_ROWS = 1024;
+
+// 回显 WHERE 条件
+std::string describeCondition(const Condition& where) {
+    if (where.op == "BETWEEN" && where.values.size() == 2) {
+        return where.column + " BETWEEN " + where.values[0].value + " AND " + where.values[1].value;
+    }
+    if (where.op == "IN") {
+        std::string text = where.column + " IN (";
+        for (size_t i = 0; i < where.values.size(); ++i) {
+            text += (i > 0 ? ", " : "") + where.values[i].value;
+        }
+        return text + ")";
+    }
+    return where.column + " " + where.op + " " + where.value.value;
+}
+
+std::string describeWhere(const WhereClause& where) {
+    if (where.kind == WhereExpr::Kind::CONDITION) {
+        return describeCondition(where.condition);
+    }
+    if (where.kind == WhereExpr::Kind::NOT) {
+        return "NOT (" + describeWhere(where.children.front()) + ")";
+    }
+    const char* separator = where.kind == WhereExpr::Kind::AND ? " AND " : " OR ";
+    std::string text;
+    for (size_t i = 0; i < where.children.size(); ++i) {
+        const auto& child = where.children[i];
+        std::string operand = describeWhere(child);
+        // 只给复合的操作数加括号，保持常见的单层条件易读
+        if (child.kind == WhereExpr::Kind::AND || child.kind == WhereExpr::Kind::OR) {
+            operand = "(" + operand + ")";
+        }
+        text += (i > 0 ? separator : "") + operand;
+    }
+    return text;
+}
+
+} // namespace
 
 void CliApp::run() {
     std::string line;
     // --- 初始化当前数据库上下文 ---
-    std::cout << "Type 'exit' or 'quit' to exit." << std::endl;
+    std::cout << "Type 'exit' or 'quit' to exit, 'ping' to measure latency, '\\a' to toggle aligned output." << std::endl;
+    start_interrupt_handler();
 
-    while (!logged_in)
-    {
-        std::cout << "Enter username: ";
-        std::getline(std::cin, username);
-        std::cout << "Enter password: ";
-        std::getline(std::cin, password);
-        logged_in = login(username, password);
-        if (logged_in){
-        break; 
-        }
+    if (!authenticate()) {
+        stop_interrupt_handler();
+        return;
     }
     
     while (logged_in) {
@@ -33,12 +82,99 @@ void CliApp::run() {
         std::cout << "> ";
         
         if (!std::getline(std::cin, line) || line == "exit" || line == "quit") break;
+        if (line == "ping") {
+            handle_ping();
+            continue;
+        }
+        if (line == "\\a") {
+            output_format = output_format == OutputFormat::UNALIGNED ? OutputFormat::TABLE : OutputFormat::UNALIGNED;
+            std::cout << "Output format is " << (output_format == OutputFormat::UNALIGNED ? "unaligned" : "aligned") << "." << std::endl;
+            continue;
+        }
         execute(line);
     }
     logout();
+    stop_interrupt_handler();
     std::cout << "\nGoodbye!" << std::endl;
 }
 
+// 依次尝试免密码登录、命令行给定的用户名密码，都没有时交互输入直到成功（输入结束则放弃）
+bool CliApp::authenticate() {
+    // 免密码登录：服务端按 SO_PEERCRED 校验进程身份，失败时回退到输入密码
+    if (connection.peer_auth && !connection.unix_socket.empty()) {
+        const char* user = std::getenv("USER");
+        username = user ? user : "";
+        logged_in = login(username, "");
+    }
+    
+    if (!logged_in && !connection.username.empty()) {
+        username = connection.username;
+        password = connection.password;
+        logged_in = login(username, password);
+        return logged_in;
+    }
+
+    while (!logged_in)
+    {
+        status_stream() << "Enter username: ";
+        if (!std::getline(std::cin, username)) {
+            return false;
+        }
+        status_stream() << "Enter password: ";
+        if (!std::getline(std::cin, password)) {
+            return false;
+        }
+        logged_in = login(username, password);
+    }
+    return true;
+}
+
+std::ostream& CliApp::status_stream() {
+    return batch_mode ? std::cerr : std::cout;
+}
+
+// SIGINT 由专门的线程用 sigwait 接收：须在创建其他线程（如心跳线程）之前屏蔽，
+// 让它们都继承屏蔽字，信号才只会交给这个线程
+void CliApp::start_interrupt_handler() {
+    sigset_t set;
+    sigemptyset(&set);
+    sigaddset(&set, SIGINT);
+    if (pthread_sigmask(SIG_BLOCK, &set, nullptr) != 0) {
+        return;
+    }
+
+    interrupt_thread = std::thread([this, set] {
+        int signal_number = 0;
+        while (sigwait(&set, &signal_number) == 0 && !interrupt_stop) {
+            if (statement_running) {
+                // 被取消的语句照常返回（错误）响应，由主线程输出
+                auto result = query_executor.cancel();
+                if (result.has_value()) {
+                    std::cerr << "\nCancel request sent." << std::endl;
+                } else if (result.error() == SocketError::UNSUPPORTED) {
+                    std::cerr << "\n✗ Server does not support cancel." << std::endl;
+                } else {
+                    std::cerr << "\n✗ Failed to send cancel request." << std::endl;
+                }
+                continue;
+            }
+            // 没有语句在执行：恢复默认行为并终止进程
+            std::signal(SIGINT, SIG_DFL);
+            pthread_sigmask(SIG_UNBLOCK, &set, nullptr);
+            std::raise(SIGINT);
+        }
+    });
+}
+
+void CliApp::stop_interrupt_handler() {
+    if (!interrupt_thread.joinable()) {
+        return;
+    }
+    interrupt_stop = true;
+    pthread_kill(interrupt_thread.native_handle(), SIGINT);
+    interrupt_thread.join();
+}
+
 void CliApp::execute(const std::string& line) {
     if (line.empty()) return;
     try {
@@ -59,6 +195,11 @@ void CliApp::execute(const std::string& line) {
         else if (auto* cmd = dynamic_cast<SelectCommand*>(command_obj.get())) handle_select(*cmd);
         else if (auto* cmd = dynamic_cast<UpdateCommand*>(command_obj.get())) handle_update(*cmd);
         else if (auto* cmd = dynamic_cast<DeleteCommand*>(command_obj.get())) handle_delete(*cmd);
+        else if (auto* cmd = dynamic_cast<ShowStatsCommand*>(command_obj.get())) handle_show_stats(*cmd);
+        else if (auto* cmd = dynamic_cast<ShowTraceCommand*>(command_obj.get())) handle_show_trace(*cmd);
+        else if (auto* cmd = dynamic_cast<ShowMemoryCommand*>(command_obj.get())) handle_show_memory(*cmd);
+        else if (auto* cmd = dynamic_cast<ShowAdmissionCommand*>(command_obj.get())) handle_show_admission(*cmd);
+        else if (auto* cmd = dynamic_cast<SetOptionCommand*>(command_obj.get())) handle_set_option(*cmd);
         else std::cerr << "✗ Error: Unhandled command type." << std::endl;
         
     } catch (const std::exception& e) {
@@ -82,88 +223,55 @@ bool CliApp::executeQuery(const NET::QueryRequest& request) {
         return false;
     }
     
+    statement_running = true;
     auto result = query_executor.executeQuery(request);
+    statement_running = false;
     if (result.has_value()) {
         if (!handleQueryResponse(*result.value())) {
             return false;
         }
         return true;
+    } else if (result.error() == SocketError::UNSUPPORTED) {
+        std::cerr << "✗ Error: Server does not support this statement." << std::endl;
+        return false;
     } else {
         std::cerr << "✗ Error: Failed to execute query." << std::endl;
         return false;
     }
 }
 
-// 格式化显示查询结果
+// 格式化显示查询结果：按批交给流式输出器，每批写出后立即刷新
 bool CliApp::handleQueryResponse(const NET::QueryResponse& response) {
-    if (response.isSuccess()) {
-        const auto& columns = response.getColumnNames();
-        const auto& rows = response.getRows();
-        
-        if (columns.empty()) {
-            // DDL操作或无结果集的DML操作
+    if (!response.isSuccess()) {
+        std::cerr << "✗ Error: " << response.getErrorMessage() << std::endl;
+        return false;
+    }
+    
+    const auto& columns = response.getColumnNames();
+    const auto& rows = response.getRows();
+    if (columns.empty()) {
+        // DDL操作或无结果集的DML操作；TSV 只输出结果集
+        if (output_format == OutputFormat::TABLE || output_format == OutputFormat::UNALIGNED) {
             std::cout << "✓ Command executed successfully." << std::endl;
             if (!rows.empty()) {
                 std::cout << "Affected rows: " << rows.size() << std::endl;
             }
-            return true;
-        }
-        
-        // 计算每列的最大宽度
-        std::vector<size_t> column_widths;
-        for (size_t i = 0; i < columns.size(); ++i) {
-            size_t max_width = columns[i].length();
-            for (const auto& row : rows) {
-                if (i < row.columns.size()) {
-                    max_width = std::max(max_width, row.columns[i].length());
-                }
-            }
-            column_widths.push_back(std::max(max_width, size_t(8))); // 最小宽度为8
-        }
-        
-        // 打印表格头部边框
-        std::cout << "+";
-        for (size_t width : column_widths) {
-            std::cout << std::string(width + 2, '-') << "+";
-        }
-        std::cout << std::endl;
-        
-        // 打印列名
-        std::cout << "|";
-        for (size_t i = 0; i < columns.size(); ++i) {
-            std::cout << " " << std::setw(column_widths[i]) << std::left << columns[i] << " |";
-        }
-        std::cout << std::endl;
-        
-        // 打印分隔线
-        std::cout << "+";
-        for (size_t width : column_widths) {
-            std::cout << std::string(width + 2, '-') << "+";
-        }
-        std::cout << std::endl;
-        
-        // 打印数据行
-        for (const auto& row : rows) {
-            std::cout << "|";
-            for (size_t i = 0; i < columns.size(); ++i) {
-                std::string cell = (i < row.columns.size()) ? row.columns[i] : "";
-                std::cout << " " << std::setw(column_widths[i]) << std::left << cell << " |";
-            }
-            std::cout << std::endl;
         }
-        
-        // 打印底部边框
-        std::cout << "+";
-        for (size_t width : column_widths) {
-            std::cout << std::string(width + 2, '-') << "+";
-        }
-        std::cout << std::endl;
-        
-        std::cout << "(" << rows.size() << " row" << (rows.size() != 1 ? "s" : "") << ")" << std::endl;
-    } else {
-        std::cerr << "✗ Error: " << response.getErrorMessage() << std::endl;
-        return false;
+        return true;
     }
+    
+    auto renderer = ResultRenderer::create(output_format, std::cout);
+    if (!renderer) {
+        return true;
+    }
+    renderer->begin(columns);
+    std::span<const NET::QueryResponse::Row> remaining(rows);
+    while (!remaining.empty()) {
+        size_t batch = std::min(remaining.size(), RENDER_BATCH_ROWS);
+        renderer->addRows(remaining.first(batch));
+        remaining = remaining.subspan(batch);
+    }
+    renderer->end();
     return true;
 }
 
@@ -314,7 +422,7 @@ void CliApp::handle_select(const SelectCommand& cmd) {
     
     if (cmd.where_clause.has_value()) {
         const auto& where = cmd.where_clause.value();
-        std::cout << "  WHERE: " << where.column << " " << where.op << " " << where.value.value << std::endl;
+        std::cout << "  WHERE: " << describeWhere(where) << std::endl;
     }
     
     auto request = NET::QueryBuilder::buildSelect(cmd);
@@ -345,7 +453,7 @@ void CliApp::handle_update(const UpdateCommand& cmd) {
     
     if (cmd.where_clause.has_value()) {
         const auto& where = cmd.where_clause.value();
-        std::cout << "  WHERE: " << where.column << " " << where.op << " " << where.value.value << std::endl;
+        std::cout << "  WHERE: " << describeWhere(where) << std::endl;
     }
     
     auto request = NET::QueryBuilder::buildUpdate(cmd);
@@ -367,7 +475,7 @@ void CliApp::handle_delete(const DeleteCommand& cmd) {
     
     if (cmd.where_clause.has_value()) {
         const auto& where = cmd.where_clause.value();
-        std::cout << "  WHERE: " << where.column << " " << where.op << " " << where.value.value << std::endl;
+        std::cout << "  WHERE: " << describeWhere(where) << std::endl;
     } else {
         std::cout << "  WARNING: This will delete ALL records from the table!" << std::endl;
     }
@@ -380,15 +488,86 @@ void CliApp::handle_delete(const DeleteCommand& cmd) {
     }
 }
 
+// --- 管理命令处理函数 ---
+void CliApp::handle_show_stats(const ShowStatsCommand& cmd) {
+    auto request = NET::QueryBuilder::buildShowStats(cmd);
+    request.setSessionToken(session_token);
+    
+    executeQuery(request);
+}
+
+void CliApp::handle_show_trace(const ShowTraceCommand& cmd) {
+    auto request = NET::QueryBuilder::buildShowTrace(cmd);
+    request.setSessionToken(session_token);
+    
+    executeQuery(request);
+}
+
+void CliApp::handle_show_memory(const ShowMemoryCommand& cmd) {
+    auto request = NET::QueryBuilder::buildShowMemory(cmd);
+    request.setSessionToken(session_token);
+    
+    executeQuery(request);
+}
+
+void CliApp::handle_show_admission(const ShowAdmissionCommand& cmd) {
+    auto request = NET::QueryBuilder::buildShowAdmission(cmd);
+    request.setSessionToken(session_token);
+    
+    executeQuery(request);
+}
+
+void CliApp::handle_set_option(const SetOptionCommand& cmd) {
+    if (!query_executor.hasCapability(NET::CAP_SESSION_OPTIONS)) {
+        std::cerr << "✗ Error: Server does not support SET." << std::endl;
+        return;
+    }
+    auto request = NET::QueryBuilder::buildSetOption(cmd);
+    request.setSessionToken(session_token);
+    
+    executeQuery(request);
+}
+
+// 测量到服务器的往返时间：与查询耗时对比可区分网络延迟和服务端耗时
+void CliApp::handle_ping() {
+    auto result = client.ping();
+    if (!result.has_value()) {
+        std::cerr << "✗ Ping failed." << std::endl;
+        return;
+    }
+    
+    NET::PingStats stats = client.getPingStats();
+    std::cout << std::fixed << std::setprecision(1)
+              << "✓ RTT " << stats.last_rtt_us << " us (min " << stats.min_rtt_us
+              << ", avg " << stats.avg_rtt_us << ", max " << stats.max_rtt_us
+              << " over " << stats.samples << " pings), server clock offset "
+              << stats.clock_offset_us << " us" << std::endl;
+    std::cout.unsetf(std::ios::fixed);
+}
+
 // --- 登录和登出功能 ---
 bool CliApp::login(const std::string& username, const std::string& password) {
     // 连接服务器
-    auto connect_result = client.connect(server_ip, server_port);
+    auto connect_result = connection.unix_socket.empty()
+        ? client.connect(connection.server_ip, connection.server_port)
+        : client.connectUnix(connection.unix_socket);
     if (!connect_result.has_value()) {
         std::cerr << "✗ Failed to connect to server." << std::endl;
         return false;
     }
     
+    // 升级失败不影响使用，继续走套接字
+    if (connection.shared_memory && !client.isSharedMemory()) {
+        if (client.enableSharedMemory().has_value()) {
+            status_stream() << "✓ Using shared memory transport." << std::endl;
+        } else if (!client.isConnected()) {
+            std::cerr << "✗ Failed to connect to server." << std::endl;
+            return false;
+        } else {
+            std::cerr << "Shared memory transport unavailable, using the socket." << std::endl;
+        }
+    }
+    
     // 发送登录请求
     NET::LoginRequest request(username, password);
     auto send_result = client.sendMessage(request);
@@ -409,8 +588,19 @@ bool CliApp::login(const std::string& username, const std::string& password) {
         auto* login_success = dynamic_cast<NET::LoginSuccess*>(response.get());
         session_token = login_success->getSessionToken();
         query_executor.setSessionToken(session_token);
-        std::cout << "✓ Login successful! Welcome, " << username << "!" << std::endl;
+        query_executor.setProtocol(login_success->getProtocolVersion(), login_success->getCapabilities());
+        // 批处理模式下连接一直在收发，不需要心跳；PONG 也会打乱流水线中响应的顺序
+        if (!batch_mode) {
+            client.startKeepalive(connection.keepalive_interval);
+        }
+        status_stream() << "✓ Login successful! Welcome, " << username << "!" << std::endl;
         return true;
+    } else if (response->getType() == NET::MessageType::ERROR_RESPONSE) {
+        // 服务器繁忙时在登录前就拒绝连接
+        auto* error = dynamic_cast<NET::ErrorResponse*>(response.get());
+        std::cerr << "✗ Login failed: " << error->getErrorMessage() << std::endl;
+        client.disconnect();
+        return false;
     } else {
         auto* login_failure = dynamic_cast<NET::LoginFailure*>(response.get());
         std::cerr << "✗ Login failed: " << login_failure->getErrorMessage() << std::endl;
@@ -425,5 +615,131 @@ void CliApp::logout() {
     query_executor.clearAuthentication();
     client.disconnect();
     
-    std::cout << "Logged out successfully." << std::endl; 
+    status_stream() << "Logged out successfully." << std::endl; 
+}
+
+// --- 批处理模式 ---
+int CliApp::run_script(const ScriptOptions& options) {
+    batch_mode = true;
+    output_format = options.format;
+    std::ifstream script(options.path);
+    if (!script) {
+        std::cerr << "✗ Cannot open script: " << options.path << std::endl;
+        return 1;
+    }
+    if (!authenticate()) {
+        return 1;
+    }
+    
+    struct InFlight {
+        size_t line_number;
+        size_t bytes;
+    };
+    std::deque<InFlight> in_flight;  // 按发送顺序排列，服务端按同样的顺序响应
+    size_t in_flight_bytes = 0;
+    const size_t depth = std::max<size_t>(1, options.pipeline_depth);
+    uint64_t executed = 0;
+    uint64_t failed = 0;
+    bool connection_lost = false;
+    
+    auto report_error = [&](size_t line_number, const std::string& message) {
+        ++failed;
+        std::cerr << "✗ Line " << line_number << ": " << message << std::endl;
+    };
+    
+    // 接收最早发出的语句的响应并输出，连接断开时返回 false
+    auto receive_one = [&]() {
+        InFlight pending = in_flight.front();
+        in_flight.pop_front();
+        in_flight_bytes -= pending.bytes;
+        ++executed;
+        
+        auto message = client.receiveMessage();
+        if (!message.has_value()) {
+            report_error(pending.line_number, "Connection lost");
+            return false;
+        }
+        if (auto* response = dynamic_cast<NET::QueryResponse*>(message.value().get())) {
+            if (!response->isSuccess()) {
+                report_error(pending.line_number, response->getErrorMessage());
+            } else {
+                handleQueryResponse(*response);
+            }
+        } else if (auto* error = dynamic_cast<NET::ErrorResponse*>(message.value().get())) {
+            report_error(pending.line_number, error->getErrorMessage());
+        } else {
+            report_error(pending.line_number, "Unexpected response type");
+        }
+        return true;
+    };
+    auto drain = [&]() {
+        while (!in_flight.empty() && !connection_lost) {
+            connection_lost = !receive_one();
+        }
+    };
+    
+    auto start = std::chrono::steady_clock::now();
+    std::string line;
+    size_t line_number = 0;
+    while (!connection_lost && std::getline(script, line)) {
+        ++line_number;
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line.compare(begin, 2, "--") == 0) {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r");
+        std::string_view statement(line.data() + begin, end + 1 - begin);
+        if (statement == "exit" || statement == "quit") {
+            break;
+        }
+        
+        std::optional<NET::QueryRequest> request;
+        try {
+            Lexer lexer(statement);
+            Parser parser(lexer.tokenize());
+            std::unique_ptr<Command> command = parser.parse();
+            if (command) {
+                request = NET::QueryBuilder::build(*command);
+            }
+            if (!request.has_value()) {
+                throw std::runtime_error("Unsupported statement");
+            }
+            if ((request->requiredCapabilities() & ~query_executor.getCapabilities()) != 0) {
+                throw std::runtime_error("Server does not support this statement");
+            }
+        } catch (const std::exception& e) {
+            drain();  // 先输出前面语句的结果，保持输出顺序与脚本一致
+            ++executed;
+            report_error(line_number, e.what());
+            continue;
+        }
+        request->setSessionToken(session_token);
+        
+        // 流水线已满时先收回最早的响应；单条超过字节上限的语句在流水线清空后单独发送
+        size_t bytes = statement.size() + 64;  // 请求编码后的大小与语句文本相近
+        while (!in_flight.empty() && !connection_lost &&
+               (in_flight.size() >= depth || in_flight_bytes + bytes > MAX_IN_FLIGHT_BYTES)) {
+            connection_lost = !receive_one();
+        }
+        if (connection_lost) {
+            break;
+        }
+        if (!client.sendMessage(*request).has_value()) {
+            ++executed;
+            report_error(line_number, "Failed to send request");
+            connection_lost = true;
+            break;
+        }
+        in_flight.push_back({line_number, bytes});
+        in_flight_bytes += bytes;
+    }
+    drain();
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << executed << " statement" << (executed != 1 ? "s" : "") << " (" << failed << " failed) in "
+              << std::fixed << std::setprecision(3) << seconds << " s, " << std::setprecision(0)
+              << (seconds > 0 ? executed / seconds : 0.0) << " statements/s" << std::endl;
+    
+    logout();
+    return failed == 0 && !connection_lost ? 0 : 1;
 }
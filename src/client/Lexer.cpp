@@ -1,9 +1,16 @@
 #include "../../include/client/Lexer.hpp"
-#include <cctype>
-#include <unordered_map>
+#include <array>
+#include <cstdint>
 
-// 完整关键字映射表
-const std::unordered_map<std::string, TokenType> KEYWORDS = {
+namespace {
+
+struct KeywordEntry {
+    std::string_view text;  // 大写
+    TokenType type;
+};
+
+// 完整关键字表
+constexpr KeywordEntry KEYWORDS[] = {
     {"CREATE", TokenType::KEYWORD_CREATE}, {"DROP", TokenType::KEYWORD_DROP},
     {"TABLE", TokenType::KEYWORD_TABLE}, {"DATABASE", TokenType::KEYWORD_DATABASE},
     {"PRIMARY", TokenType::KEYWORD_PRIMARY}, {"USE", TokenType::KEYWORD_USE},
@@ -12,19 +19,105 @@ const std::unordered_map<std::string, TokenType> KEYWORDS = {
     {"FROM", TokenType::KEYWORD_FROM}, {"WHERE", TokenType::KEYWORD_WHERE},
     {"UPDATE", TokenType::KEYWORD_UPDATE}, {"SET", TokenType::KEYWORD_SET},
     {"DELETE", TokenType::KEYWORD_DELETE}, {"INT", TokenType::KEYWORD_INT},
-    {"STRING", TokenType::KEYWORD_STRING}
+    {"STRING", TokenType::KEYWORD_STRING},
+    {"IN", TokenType::KEYWORD_IN}, {"BETWEEN", TokenType::KEYWORD_BETWEEN},
+    {"AND", TokenType::KEYWORD_AND}, {"OR", TokenType::KEYWORD_OR},
+    {"NOT", TokenType::KEYWORD_NOT}, {"LIKE", TokenType::KEYWORD_LIKE},
+    {"ILIKE", TokenType::KEYWORD_ILIKE},
+    {"SHOW", TokenType::KEYWORD_SHOW}, {"STATS", TokenType::KEYWORD_STATS},
+    {"TRACE", TokenType::KEYWORD_TRACE}, {"MEMORY", TokenType::KEYWORD_MEMORY},
+    {"ADMISSION", TokenType::KEYWORD_ADMISSION}
+};
+
+// ========== 字符分类 ==========
+// 只处理 ASCII，不依赖 locale；非 ASCII 字节按 UNKNOWN 处理（与 std::isalpha 在 "C" locale 下一致）
+
+enum CharClass : uint8_t {
+    CHAR_SPACE = 1 << 0,
+    CHAR_ALPHA = 1 << 1,
+    CHAR_DIGIT = 1 << 2,
+    CHAR_WORD = 1 << 3,  // 标识符的后续字符：字母、数字、下划线
+};
+
+constexpr std::array<uint8_t, 256> CHAR_CLASSES = [] {
+    std::array<uint8_t, 256> classes{};
+    for (unsigned char c : {' ', '\t', '\n', '\v', '\f', '\r'}) classes[c] = CHAR_SPACE;
+    for (int c = 'a'; c <= 'z'; ++c) classes[c] = CHAR_ALPHA | CHAR_WORD;
+    for (int c = 'A'; c <= 'Z'; ++c) classes[c] = CHAR_ALPHA | CHAR_WORD;
+    for (int c = '0'; c <= '9'; ++c) classes[c] = CHAR_DIGIT | CHAR_WORD;
+    classes['_'] = CHAR_WORD;
+    return classes;
+}();
+
+constexpr bool is_class(char c, uint8_t mask) {
+    return (CHAR_CLASSES[static_cast<unsigned char>(c)] & mask) != 0;
+}
+
+constexpr char to_upper(char c) { return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c; }
+
+// ========== 关键字完美哈希 ==========
+// 编译期寻找一个种子，使所有关键字的哈希值落在互不相同的槽里，
+// 查找时只需算一次哈希、做一次不区分大小写的比较
+
+constexpr size_t KEYWORD_TABLE_SIZE = 128;  // 2 的幂
+constexpr size_t MAX_KEYWORD_LENGTH = [] {
+    size_t length = 0;
+    for (const auto& keyword : KEYWORDS) length = keyword.text.size() > length ? keyword.text.size() : length;
+    return length;
+}();
+
+constexpr uint32_t keyword_hash(std::string_view word, uint32_t seed) {
+    uint32_t hash = seed ^ static_cast<uint32_t>(word.size());
+    for (char c : word) hash = (hash ^ static_cast<unsigned char>(to_upper(c))) * 16777619u;  // FNV-1a
+    return hash ^ (hash >> 15);
+}
+
+struct KeywordTable {
+    uint32_t seed = 0;
+    std::array<int8_t, KEYWORD_TABLE_SIZE> slots{};  // KEYWORDS 下标，-1 表示空槽
 };
 
+constexpr KeywordTable KEYWORD_TABLE = [] {
+    static_assert(std::size(KEYWORDS) < KEYWORD_TABLE_SIZE / 2, "keyword table too small");
+    for (uint32_t seed = 2166136261u;; ++seed) {
+        KeywordTable table{seed, {}};
+        table.slots.fill(-1);
+        bool collision = false;
+        for (size_t i = 0; i < std::size(KEYWORDS) && !collision; ++i) {
+            auto& slot = table.slots[keyword_hash(KEYWORDS[i].text, seed) & (KEYWORD_TABLE_SIZE - 1)];
+            collision = slot >= 0;
+            slot = static_cast<int8_t>(i);
+        }
+        if (!collision) return table;
+    }
+}();
+
+// 返回 word 对应的关键字类型，不是关键字时返回 IDENTIFIER
+TokenType lookup_keyword(std::string_view word) {
+    if (word.size() > MAX_KEYWORD_LENGTH) return TokenType::IDENTIFIER;
+    int8_t index = KEYWORD_TABLE.slots[keyword_hash(word, KEYWORD_TABLE.seed) & (KEYWORD_TABLE_SIZE - 1)];
+    if (index < 0) return TokenType::IDENTIFIER;
+    const auto& keyword = KEYWORDS[index];
+    if (keyword.text.size() != word.size()) return TokenType::IDENTIFIER;
+    for (size_t i = 0; i < word.size(); ++i) {
+        if (to_upper(word[i]) != keyword.text[i]) return TokenType::IDENTIFIER;
+    }
+    return keyword.type;
+}
+
+} // namespace
+
 // to_string 实现，用于调试
 std::string to_string(TokenType type) {
     // ... 此处省略了完整的实现，可以根据 Token.hpp 自行补全，不影响功能 ...
     return "TokenType";
 }
 
-Lexer::Lexer(const std::string& input) : input_(input) {}
+Lexer::Lexer(std::string_view input) : input_(input) {}
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    tokens.reserve(input_.size() / 4 + 1);  // 粗略估计，避免长脚本反复扩容
     Token token;
     do {
         token = next_token();
@@ -33,43 +126,47 @@ std::vector<Token> Lexer::tokenize() {
     return tokens;
 }
 
-char Lexer::peek() { if (position_ >= input_.length()) return '\0'; return input_[position_]; }
-char Lexer::advance() { if (position_ >= input_.length()) return '\0'; return input_[position_++]; }
-void Lexer::skip_whitespace() { while (position_ < input_.length() && std::isspace(peek())) advance(); }
+void Lexer::skip_whitespace() { while (position_ < input_.size() && is_class(input_[position_], CHAR_SPACE)) ++position_; }
 
 Token Lexer::next_token() {
     skip_whitespace();
-    if (position_ >= input_.length()) return {TokenType::END_OF_INPUT, ""};
-    char current_char = peek();
-
-    if (std::isalpha(current_char)) {
-        std::string word;
-        while (position_ < input_.length() && (std::isalnum(peek()) || peek() == '_')) word += advance();
-        std::string upper_word = word;
-        for(auto &c : upper_word) c = toupper(c);
-        if (KEYWORDS.count(upper_word)) return {KEYWORDS.at(upper_word), upper_word};
-        return {TokenType::IDENTIFIER, word};
+    if (position_ >= input_.size()) return {TokenType::END_OF_INPUT, {}};
+    size_t start = position_;
+    char current_char = input_[position_];
+
+    if (is_class(current_char, CHAR_ALPHA)) {
+        while (position_ < input_.size() && is_class(input_[position_], CHAR_WORD)) ++position_;
+        std::string_view word = input_.substr(start, position_ - start);
+        return {lookup_keyword(word), word};
     }
-    if (std::isdigit(current_char)) {
-        std::string num_str;
-        while (position_ < input_.length() && std::isdigit(peek())) num_str += advance();
-        return {TokenType::NUMERIC_LITERAL, num_str};
+    if (is_class(current_char, CHAR_DIGIT)) {
+        while (position_ < input_.size() && is_class(input_[position_], CHAR_DIGIT)) ++position_;
+        return {TokenType::NUMERIC_LITERAL, input_.substr(start, position_ - start)};
     }
     if (current_char == '"') {
-        advance();
-        std::string str_literal;
-        while (position_ < input_.length() && peek() != '"') str_literal += advance();
-        if (peek() == '"') advance();
-        return {TokenType::STRING_LITERAL, str_literal};
+        size_t close = input_.find('"', start + 1);
+        size_t end = close == std::string_view::npos ? input_.size() : close;
+        position_ = close == std::string_view::npos ? end : end + 1;  // 未闭合时读到输入末尾
+        return {TokenType::STRING_LITERAL, input_.substr(start + 1, end - start - 1)};
     }
+    ++position_;
+    std::string_view symbol = input_.substr(start, 1);
     switch (current_char) {
-        case '(': advance(); return {TokenType::PAREN_OPEN, "("};
-        case ')': advance(); return {TokenType::PAREN_CLOSE, ")"};
-        case ',': advance(); return {TokenType::COMMA, ","};
-        case ';': advance(); return {TokenType::SEMICOLON, ";"};
-        case '*': advance(); return {TokenType::ASTERISK, "*"};
-        case '=': case '>': case '<': advance(); return {TokenType::OPERATOR, std::string(1, current_char)};
+        case '(': return {TokenType::PAREN_OPEN, symbol};
+        case ')': return {TokenType::PAREN_CLOSE, symbol};
+        case ',': return {TokenType::COMMA, symbol};
+        case ';': return {TokenType::SEMICOLON, symbol};
+        case '*': return {TokenType::ASTERISK, symbol};
+        case '=': return {TokenType::OPERATOR, symbol};
+        case '>': case '<': case '!': {
+            char next = position_ < input_.size() ? input_[position_] : '\0';
+            if (next == '=' || (current_char == '<' && next == '>')) {
+                ++position_;
+                return {TokenType::OPERATOR, input_.substr(start, 2)};
+            }
+            if (current_char != '!') return {TokenType::OPERATOR, symbol};
+            break;
+        }
     }
-    advance();
-    return {TokenType::UNKNOWN, std::string(1, current_char)};
-}
\ No newline at end of file
+    return {TokenType::UNKNOWN, symbol};
+}
@@ -1,9 +1,12 @@
 #include "../../include/client/Parser.hpp"
+#include <algorithm>
+#include <cctype>
 #include <stdexcept>
 
 Parser::Parser(std::vector<Token> tokens) : tokens_(std::move(tokens)) {}
 
-const Token& Parser::peek(int offset) { return tokens_[position_ + offset]; }
+// 越过末尾时返回 END_OF_INPUT，残缺的语句（如 "create table t(id"）只会报语法错误
+const Token& Parser::peek(int offset) { return tokens_[std::min(position_ + offset, tokens_.size() - 1)]; }
 const Token& Parser::consume(TokenType expected) {
     if (peek().type == expected) return tokens_[position_++];
     throw std::runtime_error("Syntax Error: Expected different token.");
@@ -20,7 +23,9 @@ std::unique_ptr<Command> Parser::parse() {
         case TokenType::KEYWORD_DELETE: return parse_delete();
         case TokenType::KEYWORD_UPDATE: return parse_update();
         case TokenType::KEYWORD_SELECT: return parse_select();
-        default: throw std::runtime_error("Unsupported command: " + peek().value);
+        case TokenType::KEYWORD_SHOW: return parse_show();
+        case TokenType::KEYWORD_SET: return parse_set();
+        default: throw std::runtime_error("Unsupported command: " + std::string(peek().value));
     }
 }
 
@@ -92,7 +97,7 @@ std::unique_ptr<Command> Parser::parse_insert() {
 
         do {
             const Token& column_token = consume(TokenType::IDENTIFIER);
-            cmd->columns->push_back(column_token.value);  // 添加列名到命令对象
+            cmd->columns->push_back(std::string(column_token.value));  // 添加列名到命令对象
 
         } while (peek().type == TokenType::COMMA && consume(TokenType::COMMA).type == TokenType::COMMA);
 
@@ -104,7 +109,7 @@ std::unique_ptr<Command> Parser::parse_insert() {
 
     do {
         const auto& token = peek();
-        cmd->values.push_back({token.type, consume(token.type).value});
+        cmd->values.push_back({token.type, std::string(consume(token.type).value)});
     } while (peek().type == TokenType::COMMA && consume(TokenType::COMMA).type == TokenType::COMMA);
 
     consume(TokenType::PAREN_CLOSE);
@@ -114,12 +119,107 @@ std::unique_ptr<Command> Parser::parse_insert() {
 std::optional<WhereClause> Parser::parse_optional_where() {
     if (peek().type != TokenType::KEYWORD_WHERE) return std::nullopt;
     consume(TokenType::KEYWORD_WHERE);
-    Condition cond;
+    where_depth_ = 0;
+    return parse_or_expr();
+}
+
+// 优先级从低到高：OR、AND、NOT、括号和单个谓词
+WhereExpr Parser::parse_or_expr() {
+    WhereExpr left = parse_and_expr();
+    if (peek().type != TokenType::KEYWORD_OR) return left;
+    WhereExpr expr;
+    expr.kind = WhereExpr::Kind::OR;
+    expr.children.push_back(std::move(left));
+    while (peek().type == TokenType::KEYWORD_OR) {
+        consume(TokenType::KEYWORD_OR);
+        expr.children.push_back(parse_and_expr());
+    }
+    return expr;
+}
+
+WhereExpr Parser::parse_and_expr() {
+    WhereExpr left = parse_not_expr();
+    if (peek().type != TokenType::KEYWORD_AND) return left;
+    WhereExpr expr;
+    expr.kind = WhereExpr::Kind::AND;
+    expr.children.push_back(std::move(left));
+    while (peek().type == TokenType::KEYWORD_AND) {
+        consume(TokenType::KEYWORD_AND);
+        expr.children.push_back(parse_not_expr());
+    }
+    return expr;
+}
+
+WhereExpr Parser::parse_not_expr() {
+    constexpr int MAX_WHERE_DEPTH = 64;
+    if (peek().type != TokenType::KEYWORD_NOT && peek().type != TokenType::PAREN_OPEN) {
+        return parse_condition();
+    }
+    if (++where_depth_ > MAX_WHERE_DEPTH) {
+        throw std::runtime_error("Syntax Error: WHERE expression is nested too deeply.");
+    }
+    WhereExpr expr;
+    if (peek().type == TokenType::KEYWORD_NOT) {
+        consume(TokenType::KEYWORD_NOT);
+        expr.kind = WhereExpr::Kind::NOT;
+        expr.children.push_back(parse_not_expr());
+    } else {
+        consume(TokenType::PAREN_OPEN);
+        expr = parse_or_expr();
+        consume(TokenType::PAREN_CLOSE);
+    }
+    --where_depth_;
+    return expr;
+}
+
+// column op value、column [NOT] IN (...)、column [NOT] BETWEEN a AND b、column [NOT] LIKE | ILIKE pattern
+WhereExpr Parser::parse_condition() {
+    WhereExpr expr;
+    Condition& cond = expr.condition;
     cond.column = consume(TokenType::IDENTIFIER).value;
-    cond.op = consume(TokenType::OPERATOR).value;
+    bool negated = false;
+    if (peek().type == TokenType::KEYWORD_NOT &&
+        (peek(1).type == TokenType::KEYWORD_IN || peek(1).type == TokenType::KEYWORD_BETWEEN ||
+         peek(1).type == TokenType::KEYWORD_LIKE || peek(1).type == TokenType::KEYWORD_ILIKE)) {
+        consume(TokenType::KEYWORD_NOT);
+        negated = true;
+    }
+    if (peek().type == TokenType::KEYWORD_IN) {
+        cond.op = consume(TokenType::KEYWORD_IN).value;
+        consume(TokenType::PAREN_OPEN);
+        do {
+            cond.values.push_back(parse_literal());
+        } while (peek().type == TokenType::COMMA && consume(TokenType::COMMA).type == TokenType::COMMA);
+        consume(TokenType::PAREN_CLOSE);
+    } else if (peek().type == TokenType::KEYWORD_BETWEEN) {
+        cond.op = consume(TokenType::KEYWORD_BETWEEN).value;
+        cond.values.push_back(parse_literal());
+        consume(TokenType::KEYWORD_AND);
+        cond.values.push_back(parse_literal());
+    } else if (peek().type == TokenType::KEYWORD_LIKE || peek().type == TokenType::KEYWORD_ILIKE) {
+        cond.op = consume(peek().type).value;
+        cond.value = parse_literal();
+    } else {
+        cond.op = consume(TokenType::OPERATOR).value;
+        cond.value = parse_literal();
+        return expr;
+    }
+    // 关键字保留原始大小写，统一为大写便于后续比较
+    std::transform(cond.op.begin(), cond.op.end(), cond.op.begin(), ::toupper);
+    if (!negated) return expr;
+    WhereExpr negation;
+    negation.kind = WhereExpr::Kind::NOT;
+    negation.children.push_back(std::move(expr));
+    return negation;
+}
+
+LiteralValue Parser::parse_literal() {
     const auto& token = peek();
-    cond.value = {token.type, consume(token.type).value};
-    return cond;
+    if (token.type != TokenType::NUMERIC_LITERAL && token.type != TokenType::STRING_LITERAL &&
+        token.type != TokenType::IDENTIFIER) {
+        throw std::runtime_error("Syntax Error: Expected a value.");
+    }
+    return {token.type, std::string(consume(token.type).value)};
 }
 
 std::unique_ptr<Command> Parser::parse_delete() {
@@ -141,7 +241,7 @@ std::unique_ptr<Command> Parser::parse_update() {
         set.column = consume(TokenType::IDENTIFIER).value;
         consume(TokenType::OPERATOR); // consume =
         const auto& token = peek();
-        set.value = {token.type, consume(token.type).value};
+        set.value = {token.type, std::string(consume(token.type).value)};
         cmd->set_clauses.push_back(set);
     } while (peek().type == TokenType::COMMA && consume(TokenType::COMMA).type == TokenType::COMMA);
     cmd->where_clause = parse_optional_where();
@@ -156,11 +256,45 @@ std::unique_ptr<Command> Parser::parse_select() {
         cmd->select_all = true;
     } else {
         do {
-            cmd->columns.push_back(consume(TokenType::IDENTIFIER).value);
+            cmd->columns.push_back(std::string(consume(TokenType::IDENTIFIER).value));
         } while (peek().type == TokenType::COMMA && consume(TokenType::COMMA).type == TokenType::COMMA);
     }
     consume(TokenType::KEYWORD_FROM);
     cmd->table_name = consume(TokenType::IDENTIFIER).value;
     cmd->where_clause = parse_optional_where();
     return cmd;
+}
+
+std::unique_ptr<Command> Parser::parse_show() {
+    consume(TokenType::KEYWORD_SHOW);
+    if (peek().type == TokenType::KEYWORD_STATS) {
+        consume(TokenType::KEYWORD_STATS);
+        return std::make_unique<ShowStatsCommand>();
+    }
+    if (peek().type == TokenType::KEYWORD_TRACE) {
+        consume(TokenType::KEYWORD_TRACE);
+        return std::make_unique<ShowTraceCommand>();
+    }
+    if (peek().type == TokenType::KEYWORD_MEMORY) {
+        consume(TokenType::KEYWORD_MEMORY);
+        return std::make_unique<ShowMemoryCommand>();
+    }
+    if (peek().type == TokenType::KEYWORD_ADMISSION) {
+        consume(TokenType::KEYWORD_ADMISSION);
+        return std::make_unique<ShowAdmissionCommand>();
+    }
+    throw std::runtime_error("Syntax Error: Expected STATS, TRACE, MEMORY or ADMISSION after SHOW.");
+}
+
+std::unique_ptr<Command> Parser::parse_set() {
+    auto cmd = std::make_unique<SetOptionCommand>();
+    consume(TokenType::KEYWORD_SET);
+    cmd->name = consume(TokenType::IDENTIFIER).value;
+    consume(TokenType::OPERATOR); // consume =
+    cmd->value = parse_literal();
+    // 值只能是一个词元：否则 "1.5"、"-1" 会被截成 "1"、"-" 交给服务端
+    if (peek().type != TokenType::END_OF_INPUT && peek().type != TokenType::SEMICOLON) {
+        throw std::runtime_error("Syntax Error: SET expects a single value.");
+    }
+    return cmd;
 }
\ No newline at end of file
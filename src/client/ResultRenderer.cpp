@@ -0,0 +1,171 @@
+#include "../../include/client/ResultRenderer.hpp"
+
+#include <algorithm>
+#include <ostream>
+
+namespace {
+
+void writeRowCount(std::ostream& out, uint64_t rows) {
+    out << "(" << rows << " row" << (rows != 1 ? "s" : "") << ")" << std::endl;
+}
+
+const std::string& cellAt(const std::vector<std::string>& cells, size_t index) {
+    static const std::string empty;
+    return index < cells.size() ? cells[index] : empty;
+}
+
+} // namespace
+
+std::unique_ptr<ResultRenderer> ResultRenderer::create(OutputFormat format, std::ostream& out) {
+    switch (format) {
+        case OutputFormat::TABLE:
+            return std::make_unique<TableRenderer>(out);
+        case OutputFormat::UNALIGNED:
+            return std::make_unique<DelimitedRenderer>(out, '|', false, true);
+        case OutputFormat::TSV:
+            return std::make_unique<DelimitedRenderer>(out, '\t', true, false);
+        case OutputFormat::QUIET:
+        default:
+            return nullptr;
+    }
+}
+
+// ========== TableRenderer ==========
+
+TableRenderer::TableRenderer(std::ostream& output, size_t sample_size)
+    : out(output), sample_rows(sample_size) {}
+
+void TableRenderer::begin(const std::vector<std::string>& column_names) {
+    columns = column_names;
+    widths.clear();
+    for (const auto& column : columns) {
+        widths.push_back(std::max(column.length(), MIN_COLUMN_WIDTH));
+    }
+    sample.clear();
+    header_printed = false;
+    row_count = 0;
+}
+
+void TableRenderer::addRows(std::span<const Row> rows) {
+    row_count += rows.size();
+
+    size_t next = 0;
+    if (!header_printed) {
+        // 样本阶段：只记录列宽，攒够后连同表头一起输出
+        for (; next < rows.size() && sample.size() < sample_rows; ++next) {
+            for (size_t i = 0; i < widths.size(); ++i) {
+                widths[i] = std::max(widths[i], cellAt(rows[next].columns, i).length());
+            }
+            sample.push_back(rows[next]);
+        }
+        if (sample.size() < sample_rows) {
+            return;
+        }
+        printHeader();
+    }
+
+    for (; next < rows.size(); ++next) {
+        printRow(rows[next].columns);
+    }
+    out.flush();
+}
+
+void TableRenderer::end() {
+    if (!header_printed) {
+        printHeader();
+    }
+    printBorder();
+    writeRowCount(out, row_count);
+}
+
+void TableRenderer::printHeader() {
+    printBorder();
+    printRow(columns);
+    printBorder();
+    for (const auto& row : sample) {
+        printRow(row.columns);
+    }
+    sample.clear();
+    sample.shrink_to_fit();
+    header_printed = true;
+}
+
+void TableRenderer::printRow(const std::vector<std::string>& cells) {
+    line.assign(1, '|');
+    for (size_t i = 0; i < widths.size(); ++i) {
+        const std::string& cell = cellAt(cells, i);
+        widths[i] = std::max(widths[i], cell.length());
+        line += ' ';
+        line += cell;
+        line.append(widths[i] - cell.length(), ' ');
+        line += " |";
+    }
+    line += '\n';
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+void TableRenderer::printBorder() {
+    line.assign(1, '+');
+    for (size_t width : widths) {
+        line.append(width + 2, '-');
+        line += '+';
+    }
+    line += '\n';
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+// ========== DelimitedRenderer ==========
+
+DelimitedRenderer::DelimitedRenderer(std::ostream& output, char separator_char, bool escape_cells, bool with_footer)
+    : out(output), separator(separator_char), escape(escape_cells), footer(with_footer) {}
+
+void DelimitedRenderer::begin(const std::vector<std::string>& columns) {
+    column_count = columns.size();
+    row_count = 0;
+    line.clear();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        if (i > 0) line += separator;
+        appendField(columns[i]);
+    }
+    line += '\n';
+    out.write(line.data(), static_cast<std::streamsize>(line.size()));
+}
+
+void DelimitedRenderer::addRows(std::span<const Row> rows) {
+    row_count += rows.size();
+    for (const auto& row : rows) {
+        line.clear();
+        for (size_t i = 0; i < column_count; ++i) {
+            if (i > 0) line += separator;
+            appendField(cellAt(row.columns, i));
+        }
+        line += '\n';
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    }
+    out.flush();
+}
+
+void DelimitedRenderer::end() {
+    if (footer) {
+        writeRowCount(out, row_count);
+    } else {
+        out.flush();
+    }
+}
+
+// 转义反斜杠、制表符、换行和回车，保证一行对应一条记录
+void DelimitedRenderer::appendField(const std::string& value) {
+    if (!escape || value.find_first_of("\\\t\n\r") == std::string::npos) {
+        line += value;
+        return;
+    }
+    for (char c : value) {
+        switch (c) {
+            case '\\': line += "\\\\"; break;
+            case '\t': line += "\\t"; break;
+            case '\n': line += "\\n"; break;
+            case '\r': line += "\\r"; break;
+            default: line += c;
+        }
+    }
+}
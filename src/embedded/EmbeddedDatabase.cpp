@@ -0,0 +1,238 @@
+#include "../../include/embedded/EmbeddedDatabase.hpp"
+#include "../../include/client/Lexer.hpp"
+#include "../../include/client/Parser.hpp"
+#include "../../include/server/RowFilter.hpp"
+#include <algorithm>
+#include <charconv>  // 用于解析 SET 的数值
+#include <map>       // 用于 UPDATE 和带列名的 INSERT
+#include <stdexcept> // 用于捕获解析错误
+
+namespace {
+
+// 解析器的列类型到存储层数据类型
+DataType toDataType(TokenType type) {
+  switch (type) {
+  case TokenType::KEYWORD_INT:
+    return DataType::INT;
+  default:
+    return DataType::STRING;
+  }
+}
+
+// 单个谓词翻译为存储层的条件字符串，值统一加引号
+std::string toConditionString(const Condition &where) {
+  if (where.op == "BETWEEN" && where.values.size() == 2) {
+    return where.column + " BETWEEN " + RowFilter::quote(where.values[0].value) +
+           " AND " + RowFilter::quote(where.values[1].value);
+  }
+  if (where.op == "IN") {
+    std::string condition = where.column + " IN (";
+    for (size_t i = 0; i < where.values.size(); ++i) {
+      condition += (i > 0 ? ", " : "") + RowFilter::quote(where.values[i].value);
+    }
+    return condition + ")";
+  }
+  return where.column + " " + where.op + " " + RowFilter::quote(where.value.value);
+}
+
+// 优先级从低到高：OR、AND、NOT、单个条件
+int precedence(WhereExpr::Kind kind) {
+  switch (kind) {
+  case WhereExpr::Kind::OR:
+    return 0;
+  case WhereExpr::Kind::AND:
+    return 1;
+  case WhereExpr::Kind::NOT:
+    return 2;
+  case WhereExpr::Kind::CONDITION:
+    return 3;
+  }
+  return 3;
+}
+
+// 只给优先级低于父节点的操作数加括号（与服务端一致）
+std::string toConditionString(const WhereExpr &where) {
+  if (where.kind == WhereExpr::Kind::CONDITION) {
+    return toConditionString(where.condition);
+  }
+  auto operand = [&](const WhereExpr &child) {
+    std::string condition = toConditionString(child);
+    return precedence(child.kind) < precedence(where.kind) ? "(" + condition + ")"
+                                                           : condition;
+  };
+  if (where.kind == WhereExpr::Kind::NOT) {
+    return "NOT " + operand(where.children.front());
+  }
+  const char *separator = where.kind == WhereExpr::Kind::AND ? " AND " : " OR ";
+  std::string condition;
+  for (size_t i = 0; i < where.children.size(); ++i) {
+    condition += (i > 0 ? separator : "") + operand(where.children[i]);
+  }
+  return condition;
+}
+
+// 结构化 WHERE 子句翻译为存储层使用的条件字符串（与服务端一致）
+std::string toConditionString(const std::optional<WhereClause> &where) {
+  return where.has_value() ? toConditionString(where.value()) : "";
+}
+
+StatementResult failure(const std::string &message) {
+  StatementResult result;
+  result.success = false;
+  result.message = message;
+  return result;
+}
+
+StatementResult affected(int rows) {
+  StatementResult result;
+  result.affectedRows = rows;
+  return result;
+}
+
+} // namespace
+
+/**
+ * @brief EmbeddedDatabase 的内部实现类 (Pimpl)。
+ */
+class EmbeddedDatabase::Impl {
+public:
+  Database database;
+  QueryInterrupt interrupt;
+  std::chrono::milliseconds statementTimeout{0};
+
+  explicit Impl(const std::string &rootPath) : database(rootPath) {
+    database.setQueryInterrupt(&interrupt);
+  }
+
+  StatementResult execute(const std::string &sql) {
+    std::unique_ptr<Command> command;
+    try {
+      Lexer lexer(sql);
+      Parser parser(lexer.tokenize());
+      command = parser.parse();
+    } catch (const std::runtime_error &e) {
+      throw SyntaxException(e.what());
+    }
+    if (!command) {
+      return failure("Empty statement");
+    }
+
+    DDLOperations &ddl = database.getDDLOperations();
+    DMLOperations &dml = database.getDMLOperations();
+    interrupt.start(statementTimeout);
+
+    if (auto *cmd = dynamic_cast<SetOptionCommand *>(command.get())) {
+      return setOption(*cmd);
+    }
+
+    if (auto *cmd = dynamic_cast<CreateDatabaseCommand *>(command.get())) {
+      return ddl.createDatabase(cmd->db_name)
+                 ? StatementResult{}
+                 : failure("Failed to create database: " + cmd->db_name);
+    }
+    if (auto *cmd = dynamic_cast<DropDatabaseCommand *>(command.get())) {
+      return ddl.dropDatabase(cmd->db_name)
+                 ? StatementResult{}
+                 : failure("Failed to drop database: " + cmd->db_name);
+    }
+    if (auto *cmd = dynamic_cast<UseDatabaseCommand *>(command.get())) {
+      return ddl.useDatabase(cmd->db_name)
+                 ? StatementResult{}
+                 : failure("Database not found: " + cmd->db_name);
+    }
+    if (auto *cmd = dynamic_cast<CreateTableCommand *>(command.get())) {
+      std::vector<ColumnDefinition> columns;
+      for (const auto &col : cmd->columns) {
+        columns.emplace_back(col.name, toDataType(col.type), col.is_primary);
+      }
+      return ddl.createTable(cmd->table_name, columns)
+                 ? StatementResult{}
+                 : failure("Failed to create table: " + cmd->table_name);
+    }
+    if (auto *cmd = dynamic_cast<DropTableCommand *>(command.get())) {
+      return ddl.dropTable(cmd->table_name)
+                 ? StatementResult{}
+                 : failure("Failed to drop table: " + cmd->table_name);
+    }
+    if (auto *cmd = dynamic_cast<InsertCommand *>(command.get())) {
+      int rows = 0;
+      if (cmd->columns.has_value()) {
+        if (cmd->columns->size() != cmd->values.size()) {
+          return failure("Column count does not match value count");
+        }
+        std::map<std::string, std::string> values;
+        for (size_t i = 0; i < cmd->values.size(); ++i) {
+          values[(*cmd->columns)[i]] = cmd->values[i].value;
+        }
+        rows = dml.insert(cmd->table_name, values);
+      } else {
+        std::vector<std::string> values;
+        for (const auto &value : cmd->values) {
+          values.push_back(value.value);
+        }
+        rows = dml.insert(cmd->table_name, values);
+      }
+      return rows > 0 ? affected(rows)
+                      : failure("Failed to insert into table: " +
+                                cmd->table_name);
+    }
+    if (auto *cmd = dynamic_cast<SelectCommand *>(command.get())) {
+      StatementResult result;
+      result.rows =
+          dml.select(cmd->table_name, toConditionString(cmd->where_clause));
+      if (!result.rows) {
+        return failure("No database selected");
+      }
+      return result;
+    }
+    if (auto *cmd = dynamic_cast<UpdateCommand *>(command.get())) {
+      std::map<std::string, std::string> updates;
+      for (const auto &clause : cmd->set_clauses) {
+        updates[clause.column] = clause.value.value;
+      }
+      return affected(dml.update(cmd->table_name, updates,
+                                 toConditionString(cmd->where_clause)));
+    }
+    if (auto *cmd = dynamic_cast<DeleteCommand *>(command.get())) {
+      return affected(
+          dml.remove(cmd->table_name, toConditionString(cmd->where_clause)));
+    }
+    // SHOW STATS/TRACE/MEMORY/ADMISSION 统计的是服务端的请求处理，嵌入式模式下没有意义
+    return failure("Statement is not supported in embedded mode");
+  }
+
+  // SET：目前只支持 statement_timeout（毫秒，0 表示不限制），与服务端一致
+  StatementResult setOption(const SetOptionCommand &cmd) {
+    std::string name = cmd.name;
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    if (name != "statement_timeout") {
+      return failure("Unknown setting: " + cmd.name);
+    }
+    const std::string &value = cmd.value.value;
+    uint64_t millis = 0;
+    auto [end, ec] =
+        std::from_chars(value.data(), value.data() + value.size(), millis);
+    if (ec != std::errc() || end != value.data() + value.size()) {
+      return failure("Invalid value for statement_timeout: " + value);
+    }
+    statementTimeout = std::chrono::milliseconds(millis);
+    return StatementResult{};
+  }
+};
+
+EmbeddedDatabase::EmbeddedDatabase(const std::string &rootPath)
+    : pImpl(std::make_unique<Impl>(rootPath)) {}
+
+EmbeddedDatabase::~EmbeddedDatabase() = default;
+
+StatementResult EmbeddedDatabase::execute(const std::string &sql) {
+  return pImpl->execute(sql);
+}
+
+void EmbeddedDatabase::cancel() { pImpl->interrupt.cancel(); }
+
+void EmbeddedDatabase::setStatementTimeout(std::chrono::milliseconds timeout) {
+  pImpl->statementTimeout = timeout;
+}
+
+Database &EmbeddedDatabase::getDatabase() { return pImpl->database; }
@@ -0,0 +1,427 @@
+#include "../../include/network/async_client.hpp"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace NET {
+
+namespace {
+
+constexpr size_t READ_CHUNK = 16 * 1024;
+
+// 把通用响应转换为查询结果，与 NetworkQueryExecutor::executeQuery 的约定一致
+AsyncClient::QueryResult toQueryResult(AsyncClient::MessageResult result) {
+    if (!result.has_value()) {
+        return std::unexpected(result.error());
+    }
+    auto& message = result.value();
+    if (message->getType() != MessageType::QUERY_RESPONSE) {
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    return std::unique_ptr<QueryResponse>(static_cast<QueryResponse*>(message.release()));
+}
+
+} // namespace
+
+AsyncClient::AsyncClient() = default;
+
+AsyncClient::~AsyncClient() {
+    disconnect();
+}
+
+std::expected<void, SocketError> AsyncClient::connect(const std::string& ip, uint16_t port) {
+    if (isConnected()) {
+        return {}; // 已经连接
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &addr.sin_addr) != 1) {
+        return std::unexpected(SocketError::INVALID_ADDRESS);
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+
+    // 请求是一批小包连续写出，关闭 Nagle 避免等待前一个包的 ACK
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return start(fd);
+}
+
+std::expected<void, SocketError> AsyncClient::connectUnix(const std::string& path) {
+    if (isConnected()) {
+        return {}; // 已经连接
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return std::unexpected(SocketError::INVALID_ADDRESS);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(fd);
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+    return start(fd);
+}
+
+std::expected<void, SocketError> AsyncClient::start(int fd) {
+    // 上一次连接的 I/O 线程可能因对端断开已退出，先回收
+    disconnect();
+
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        close(fd);
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wake_fd < 0) {
+        close(fd);
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    socket_fd = fd;
+    writing.clear();
+    write_offset = 0;
+    input.clear();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queued_output.clear();
+        running = true;
+    }
+    io_thread = std::thread(&AsyncClient::ioLoop, this);
+    return {};
+}
+
+void AsyncClient::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    if (io_thread.joinable()) {
+        wakeIoThread();
+        io_thread.join();
+    }
+    failPending(SocketError::CONNECTION_CLOSED);
+
+    if (socket_fd != -1) {
+        close(socket_fd);
+        socket_fd = -1;
+    }
+    if (wake_fd != -1) {
+        close(wake_fd);
+        wake_fd = -1;
+    }
+}
+
+bool AsyncClient::isConnected() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return running;
+}
+
+std::expected<bool, SocketError> AsyncClient::login(const std::string& username, const std::string& password) {
+    auto promise = std::make_shared<std::promise<MessageResult>>();
+    auto future = promise->get_future();
+    sendAsync(LoginRequest(username, password), [promise](MessageResult result) {
+        promise->set_value(std::move(result));
+    });
+
+    auto result = future.get();
+    if (!result.has_value()) {
+        return std::unexpected(result.error());
+    }
+    auto* success = dynamic_cast<LoginSuccess*>(result.value().get());
+    if (success == nullptr) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        session_token = success->getSessionToken();
+        capabilities = success->getCapabilities();
+    }
+    return true;
+}
+
+void AsyncClient::setSessionToken(const std::string& token) {
+    std::lock_guard<std::mutex> lock(mutex);
+    session_token = token;
+}
+
+bool AsyncClient::hasCapability(Capability capability) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return (capabilities & capability) != 0;
+}
+
+void AsyncClient::sendAsync(const Message& message, MessageCallback callback) {
+    // 在调用线程序列化，I/O 线程只做收发
+    auto bytes = message.serialize();
+
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (running) {
+            // 队列非空说明已有唤醒尚未被 I/O 线程处理，无需重复唤醒
+            wake = queued_output.empty();
+            queued_output.insert(queued_output.end(), bytes.begin(), bytes.end());
+            pending.push_back(std::move(callback));
+            callback = nullptr;
+        }
+    }
+
+    if (callback) {
+        callback(std::unexpected(SocketError::SEND_FAILED));
+        return;
+    }
+    if (wake) {
+        wakeIoThread();
+    }
+}
+
+std::future<AsyncClient::QueryResult> AsyncClient::executeAsync(const QueryRequest& request) {
+    auto promise = std::make_shared<std::promise<QueryResult>>();
+    auto future = promise->get_future();
+    executeAsync(request, [promise](QueryResult result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+void AsyncClient::executeAsync(const QueryRequest& request, QueryCallback callback) {
+    QueryRequest query_request = request;
+    bool supported = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        supported = (request.requiredCapabilities() & ~capabilities) == 0;
+        query_request.setSessionToken(session_token);
+    }
+    if (!supported) {
+        callback(std::unexpected(SocketError::UNSUPPORTED));
+        return;
+    }
+    sendAsync(query_request, [callback = std::move(callback)](MessageResult result) {
+        callback(toQueryResult(std::move(result)));
+    });
+}
+
+std::future<AsyncClient::QueryResult> AsyncClient::executeSqlAsync(const std::string& sql) {
+    auto promise = std::make_shared<std::promise<QueryResult>>();
+    auto future = promise->get_future();
+    executeSqlAsync(sql, [promise](QueryResult result) {
+        promise->set_value(std::move(result));
+    });
+    return future;
+}
+
+void AsyncClient::executeSqlAsync(const std::string& sql, QueryCallback callback) {
+    bool supported = false;
+    std::string token;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        supported = (capabilities & CAP_SQL_TEXT) != 0;
+        token = session_token;
+    }
+    if (!supported) {
+        callback(std::unexpected(SocketError::UNSUPPORTED));
+        return;
+    }
+    sendAsync(SqlTextRequest(token, sql), [callback = std::move(callback)](MessageResult result) {
+        callback(toQueryResult(std::move(result)));
+    });
+}
+
+bool AsyncClient::cancel() {
+    std::vector<std::byte> bytes;
+    bool wake = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!running || (capabilities & CAP_CANCEL) == 0) {
+            return false;
+        }
+        bytes = CancelRequest(session_token).serialize();
+        wake = queued_output.empty();
+        queued_output.insert(queued_output.end(), bytes.begin(), bytes.end());
+    }
+    if (wake) {
+        wakeIoThread();
+    }
+    return true;
+}
+
+size_t AsyncClient::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.size();
+}
+
+void AsyncClient::ioLoop() {
+    SocketError error = SocketError::CONNECTION_CLOSED;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!running) {
+                return; // disconnect() 负责结束未完成的请求
+            }
+            if (write_offset == writing.size() && !queued_output.empty()) {
+                writing.clear();
+                write_offset = 0;
+                writing.swap(queued_output);
+            }
+        }
+
+        if (!flushOutput()) {
+            error = SocketError::SEND_FAILED;
+            break;
+        }
+
+        short events = POLLIN;
+        if (write_offset < writing.size()) {
+            events |= POLLOUT;
+        }
+        pollfd fds[2] = {{socket_fd, events, 0}, {wake_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error = SocketError::RECV_FAILED;
+            break;
+        }
+
+        if (fds[1].revents & POLLIN) {
+            uint64_t value;
+            [[maybe_unused]] auto n = read(wake_fd, &value, sizeof(value));
+        }
+        if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            if (!readInput()) {
+                break;
+            }
+        }
+    }
+
+    // 连接出错：此后的请求立即失败，已发出的请求以错误结束
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+    }
+    failPending(error);
+}
+
+bool AsyncClient::flushOutput() {
+    while (write_offset < writing.size()) {
+        ssize_t sent = send(socket_fd, writing.data() + write_offset,
+                            writing.size() - write_offset, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return true; // 等待 POLLOUT
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        write_offset += static_cast<size_t>(sent);
+    }
+    return true;
+}
+
+bool AsyncClient::readInput() {
+    // 读空套接字；对端关闭前已到达的响应仍然交付
+    std::array<std::byte, READ_CHUNK> buffer;
+    bool peer_closed = false;
+    while (true) {
+        ssize_t received = recv(socket_fd, buffer.data(), buffer.size(), 0);
+        if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            peer_closed = true;
+            break;
+        }
+        if (received == 0) {
+            peer_closed = true;
+            break;
+        }
+        input.insert(input.end(), buffer.begin(), buffer.begin() + received);
+    }
+
+    // 切分出完整的帧，按 FIFO 交给等待中的回调
+    size_t offset = 0;
+    while (input.size() - offset >= MessageHeader::HEADER_SIZE) {
+        Deserializer deserializer(std::span<const std::byte>(input.data() + offset, MessageHeader::HEADER_SIZE));
+        auto header = MessageHeader::deserialize(deserializer);
+        if (!header.has_value()) {
+            return false;
+        }
+        size_t frame_size = MessageHeader::HEADER_SIZE + header->getPayloadSize();
+        if (input.size() - offset < frame_size) {
+            break;
+        }
+
+        auto message = Message::deserialize(std::span<const std::byte>(input.data() + offset, frame_size));
+        offset += frame_size;
+
+        MessageCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (pending.empty()) {
+                return false; // 没有对应请求的响应，连接状态已不可信
+            }
+            callback = std::move(pending.front());
+            pending.pop_front();
+        }
+
+        if (message.has_value()) {
+            callback(std::move(message.value()));
+        } else {
+            callback(std::unexpected(SocketError::RECV_FAILED));
+        }
+    }
+    input.erase(input.begin(), input.begin() + static_cast<std::ptrdiff_t>(offset));
+    return !peer_closed;
+}
+
+void AsyncClient::failPending(SocketError error) {
+    std::deque<MessageCallback> failed;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed.swap(pending);
+        queued_output.clear();
+    }
+    for (auto& callback : failed) {
+        callback(std::unexpected(error));
+    }
+}
+
+void AsyncClient::wakeIoThread() {
+    uint64_t one = 1;
+    [[maybe_unused]] auto n = write(wake_fd, &one, sizeof(one));
+}
+
+} // namespace NET
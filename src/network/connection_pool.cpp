@@ -0,0 +1,303 @@
+#include "../../include/network/connection_pool.hpp"
+
+#include <algorithm>
+
+namespace NET {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 只读语句在响应丢失后可以安全地重新执行
+bool isReadOnly(OperationType operation) {
+    switch (operation) {
+        case OperationType::SELECT:
+        case OperationType::SHOW_STATS:
+        case OperationType::SHOW_TRACE:
+        case OperationType::SHOW_MEMORY:
+        case OperationType::SHOW_ADMISSION:
+            return true;
+        default:
+            return false;
+    }
+}
+
+} // namespace
+
+// ========== Lease Implementation ==========
+
+ConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), connection(std::move(other.connection)), broken(other.broken) {
+    other.pool = nullptr;
+}
+
+ConnectionPool::Lease& ConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool = other.pool;
+        connection = std::move(other.connection);
+        broken = other.broken;
+        other.pool = nullptr;
+    }
+    return *this;
+}
+
+ConnectionPool::Lease::~Lease() {
+    release();
+}
+
+void ConnectionPool::Lease::release() {
+    if (pool != nullptr && connection) {
+        pool->release(std::move(connection), broken);
+    }
+    pool = nullptr;
+}
+
+// ========== ConnectionPool Implementation ==========
+
+ConnectionPool::ConnectionPool(ConnectionPoolOptions pool_options)
+    : options(std::move(pool_options)) {
+    options.max_connections = std::max<size_t>(1, options.max_connections);
+    options.min_connections = std::min(options.min_connections, options.max_connections);
+    maintenance_thread = std::thread(&ConnectionPool::maintenanceLoop, this);
+}
+
+ConnectionPool::~ConnectionPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    stop_signal.notify_all();
+    available.notify_all();
+    if (maintenance_thread.joinable()) {
+        maintenance_thread.join();
+    }
+    idle.clear();
+}
+
+std::expected<ConnectionPool::Lease, SocketError> ConnectionPool::acquire() {
+    auto deadline = Clock::now() + options.acquire_timeout;
+    std::unique_lock<std::mutex> lock(mutex);
+
+    while (true) {
+        if (stopping) {
+            return std::unexpected(SocketError::CONNECTION_CLOSED);
+        }
+
+        // 优先借出最近归还的连接，让多余的连接自然空闲超时
+        if (!idle.empty()) {
+            std::unique_ptr<Connection> connection = std::move(idle.back());
+            idle.pop_back();
+            if (Clock::now() - connection->last_checked < options.health_check_interval) {
+                return Lease(this, std::move(connection));
+            }
+
+            lock.unlock();
+            bool alive = ping(*connection);
+            lock.lock();
+            if (alive) {
+                return Lease(this, std::move(connection));
+            }
+            ++stats.health_check_failures;
+            ++stats.closed;
+            --open_count;
+            continue;
+        }
+
+        if (open_count < options.max_connections) {
+            ++open_count;  // 先占住名额，建连期间不持锁
+            lock.unlock();
+            auto connection = openConnection();
+            lock.lock();
+            if (!connection.has_value()) {
+                --open_count;
+                available.notify_one();
+                return std::unexpected(connection.error());
+            }
+            ++stats.created;
+            return Lease(this, std::move(connection.value()));
+        }
+
+        if (available.wait_until(lock, deadline) == std::cv_status::timeout &&
+            idle.empty() && open_count >= options.max_connections) {
+            return std::unexpected(SocketError::TIMEOUT);
+        }
+    }
+}
+
+std::expected<std::unique_ptr<QueryResponse>, SocketError>
+ConnectionPool::executeQuery(const QueryRequest& request) {
+    for (int attempt = 0;; ++attempt) {
+        auto lease = acquire();
+        if (!lease.has_value()) {
+            return std::unexpected(lease.error());
+        }
+
+        auto result = lease->executor().executeQuery(request);
+        if (result.has_value()) {
+            return result;
+        }
+
+        // 出错后连接上的数据可能已不同步，不再复用
+        lease->markBroken();
+        bool retryable = result.error() == SocketError::SEND_FAILED || isReadOnly(request.getOperation());
+        if (!retryable || attempt >= options.max_retries) {
+            return result;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        ++stats.retries;
+    }
+}
+
+ConnectionPoolStats ConnectionPool::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    ConnectionPoolStats result = stats;
+    result.open = open_count;
+    result.idle = idle.size();
+    result.in_use = open_count - idle.size();
+    return result;
+}
+
+std::expected<std::unique_ptr<ConnectionPool::Connection>, SocketError> ConnectionPool::openConnection() {
+    auto connection = std::make_unique<Connection>();
+
+    auto connect_result = options.unix_socket.empty()
+        ? connection->client.connect(options.server_ip, options.server_port)
+        : connection->client.connectUnix(options.unix_socket);
+    if (!connect_result.has_value()) {
+        return std::unexpected(connect_result.error());
+    }
+    if (options.io_timeout.count() > 0) {
+        connection->client.setTimeout(options.io_timeout);
+    }
+
+    LoginRequest login(options.username, options.password);
+    auto send_result = connection->client.sendMessage(login);
+    if (!send_result.has_value()) {
+        return std::unexpected(send_result.error());
+    }
+
+    auto response = connection->client.receiveMessage();
+    if (!response.has_value()) {
+        return std::unexpected(response.error());
+    }
+    auto* success = dynamic_cast<LoginSuccess*>(response.value().get());
+    if (success == nullptr) {
+        return std::unexpected(SocketError::UNSUPPORTED);  // 用户名或密码错误
+    }
+
+    connection->executor.setSessionToken(success->getSessionToken());
+    connection->executor.setProtocol(success->getProtocolVersion(), success->getCapabilities());
+    connection->last_used = connection->last_checked = Clock::now();
+    return connection;
+}
+
+bool ConnectionPool::ping(Connection& connection) {
+    if (!connection.client.ping(options.io_timeout).has_value()) {
+        return false;
+    }
+    connection.last_checked = Clock::now();
+    return true;
+}
+
+void ConnectionPool::release(std::unique_ptr<Connection> connection, bool broken) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!broken && !stopping && connection->client.isConnected()) {
+            connection->last_used = connection->last_checked = Clock::now();
+            idle.push_back(std::move(connection));
+        } else {
+            --open_count;
+            ++stats.closed;
+        }
+    }
+    available.notify_one();
+}
+
+void ConnectionPool::maintenanceLoop() {
+    auto tick = std::max<std::chrono::milliseconds>(
+        std::chrono::milliseconds(100),
+        std::min(options.health_check_interval, options.idle_timeout) / 2);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        maintain();
+        lock.lock();
+        stop_signal.wait_for(lock, tick, [this] { return stopping; });
+    }
+}
+
+void ConnectionPool::maintain() {
+    auto now = Clock::now();
+    std::vector<std::unique_ptr<Connection>> expired;
+    std::vector<std::unique_ptr<Connection>> to_check;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // 从最久未用的连接开始，关闭超出 min_connections 的空闲连接
+        for (auto it = idle.begin(); it != idle.end();) {
+            if (open_count > options.min_connections && now - (*it)->last_used >= options.idle_timeout) {
+                expired.push_back(std::move(*it));
+                it = idle.erase(it);
+                --open_count;
+                ++stats.closed;
+            } else {
+                ++it;
+            }
+        }
+
+        // 取出需要健康检查的连接，检查期间不持锁
+        for (auto it = idle.begin(); it != idle.end();) {
+            if (now - (*it)->last_checked >= options.health_check_interval) {
+                to_check.push_back(std::move(*it));
+                it = idle.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    expired.clear();
+
+    for (auto& connection : to_check) {
+        bool alive = ping(*connection);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (alive && !stopping) {
+            idle.insert(idle.begin(), std::move(connection));
+        } else {
+            if (!alive) {
+                ++stats.health_check_failures;
+            }
+            --open_count;
+            ++stats.closed;
+        }
+    }
+    if (!to_check.empty()) {
+        available.notify_all();
+    }
+
+    // 预热到 min_connections
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping || open_count >= options.min_connections) {
+                return;
+            }
+            ++open_count;
+        }
+        auto connection = openConnection();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!connection.has_value()) {
+                --open_count;
+                return;  // 服务端不可用，下个周期再试
+            }
+            ++stats.created;
+            idle.insert(idle.begin(), std::move(connection.value()));
+        }
+        available.notify_one();
+    }
+}
+
+} // namespace NET
@@ -0,0 +1,302 @@
+#include "../../include/network/event_loop.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace NET {
+
+// ========== EventLoop Implementation ==========
+
+EventLoop::EventLoop() {
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    wake_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || wake_fd < 0) {
+        throw std::runtime_error("Failed to create event loop");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = wake_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd, &event);
+}
+
+EventLoop::~EventLoop() {
+    if (wake_fd >= 0) {
+        close(wake_fd);
+    }
+    if (epoll_fd >= 0) {
+        close(epoll_fd);
+    }
+}
+
+void EventLoop::run() {
+    constexpr int MAX_EVENTS = 256;
+    epoll_event events[MAX_EVENTS];
+    std::vector<std::coroutine_handle<>> ready;
+
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(posted_mutex);
+            if (stopping) {
+                stopping = false;
+                return;
+            }
+        }
+
+        int timeout_ms = -1;
+        if (!timers.empty()) {
+            auto delay = std::chrono::ceil<std::chrono::milliseconds>(timers.begin()->first.first - Clock::now());
+            timeout_ms = static_cast<int>(std::clamp<int64_t>(delay.count(), 0, INT_MAX));
+        }
+
+        int count = epoll_wait(epoll_fd, events, MAX_EVENTS, timeout_ms);
+        if (count < 0 && errno != EINTR) {
+            throw std::runtime_error("epoll_wait failed");
+        }
+
+        // 先摘下所有就绪的等待者再恢复：恢复的协程可能在同一个描述符上重新等待
+        ready.clear();
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == wake_fd) {
+                uint64_t value;
+                while (read(wake_fd, &value, sizeof(value)) > 0) {
+                }
+                continue;
+            }
+            auto it = fds.find(fd);
+            if (it == fds.end()) {
+                continue;
+            }
+            FdState& state = it->second;
+            uint32_t revents = events[i].events;
+            bool failed = revents & (EPOLLERR | EPOLLHUP);
+            if (state.reader && (failed || (revents & (EPOLLIN | EPOLLRDHUP)))) {
+                IoWaiter* waiter = std::exchange(state.reader, nullptr);
+                if (waiter->timer.second != 0) {
+                    timers.erase(waiter->timer);
+                }
+                ready.push_back(waiter->handle);
+            }
+            if (state.writer && (failed || (revents & EPOLLOUT))) {
+                IoWaiter* waiter = std::exchange(state.writer, nullptr);
+                if (waiter->timer.second != 0) {
+                    timers.erase(waiter->timer);
+                }
+                ready.push_back(waiter->handle);
+            }
+            updateInterest(fd, state);
+        }
+        for (auto handle : ready) {
+            handle.resume();
+        }
+
+        runDueTimers();
+        runPosted();
+    }
+}
+
+void EventLoop::stop() {
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        stopping = true;
+    }
+    uint64_t one = 1;
+    [[maybe_unused]] auto written = write(wake_fd, &one, sizeof(one));
+}
+
+void EventLoop::post(std::coroutine_handle<> handle) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        wake = posted.empty();
+        posted.push_back(handle);
+    }
+    if (wake) {
+        uint64_t one = 1;
+        [[maybe_unused]] auto written = write(wake_fd, &one, sizeof(one));
+    }
+}
+
+void EventLoop::addWaiter(IoWaiter& waiter, std::coroutine_handle<> handle, std::chrono::milliseconds timeout) {
+    waiter.handle = handle;
+    FdState& state = fds[waiter.fd];
+    (waiter.write ? state.writer : state.reader) = &waiter;
+    updateInterest(waiter.fd, state);
+
+    if (timeout.count() >= 0) {
+        IoWaiter* target = &waiter;
+        waiter.timer = addTimer(Clock::now() + timeout, [this, target] {
+            target->timer = {};
+            target->timed_out = true;
+            removeWaiter(*target);
+            target->handle.resume();
+        });
+    }
+}
+
+void EventLoop::removeWaiter(IoWaiter& waiter) {
+    auto it = fds.find(waiter.fd);
+    if (it == fds.end()) {
+        return;
+    }
+    FdState& state = it->second;
+    if (state.reader == &waiter) {
+        state.reader = nullptr;
+    }
+    if (state.writer == &waiter) {
+        state.writer = nullptr;
+    }
+    updateInterest(waiter.fd, state);
+}
+
+// 按当前的等待者调整 epoll 注册；没有等待者时注销，描述符关闭后不会留下残留注册
+void EventLoop::updateInterest(int fd, FdState& state) {
+    uint32_t wanted = (state.reader ? static_cast<uint32_t>(EPOLLIN | EPOLLRDHUP) : 0u) |
+                      (state.writer ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    if (wanted == state.registered) {
+        if (wanted == 0) {
+            fds.erase(fd);
+        }
+        return;
+    }
+
+    epoll_event event{};
+    event.events = wanted;
+    event.data.fd = fd;
+    if (wanted == 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        fds.erase(fd);
+        return;
+    }
+    // 描述符关闭后内核自动注销，编号被复用时 MOD 失败，改为重新 ADD
+    int op = state.registered == 0 ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+    if (epoll_ctl(epoll_fd, op, fd, &event) < 0) {
+        epoll_ctl(epoll_fd, op == EPOLL_CTL_ADD ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event);
+    }
+    state.registered = wanted;
+}
+
+EventLoop::TimerKey EventLoop::addTimer(Clock::time_point deadline, std::function<void()> callback) {
+    TimerKey key{deadline, next_timer_id++};
+    timers.emplace(key, std::move(callback));
+    return key;
+}
+
+void EventLoop::runDueTimers() {
+    auto now = Clock::now();
+    while (!timers.empty() && timers.begin()->first.first <= now) {
+        auto callback = std::move(timers.begin()->second);
+        timers.erase(timers.begin());
+        callback();
+    }
+}
+
+void EventLoop::runPosted() {
+    std::vector<std::coroutine_handle<>> batch;
+    {
+        std::lock_guard<std::mutex> lock(posted_mutex);
+        batch.swap(posted);
+    }
+    for (auto handle : batch) {
+        handle.resume();
+    }
+}
+
+// ========== Executor Implementation ==========
+
+Executor::Executor(size_t thread_count) {
+    thread_count = std::max<size_t>(thread_count, 1);
+    threads.reserve(thread_count);
+    for (size_t i = 0; i < thread_count; ++i) {
+        threads.emplace_back([this] { workerLoop(); });
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void Executor::submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    cv.notify_one();
+}
+
+void Executor::workerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        job();
+    }
+}
+
+// ========== 异步套接字读写 ==========
+
+Task<std::expected<void, SocketError>> readExact(EventLoop& loop, int fd, std::byte* dest, size_t size,
+                                                 std::chrono::milliseconds timeout) {
+    size_t total = 0;
+    while (total < size) {
+        ssize_t received = recv(fd, dest + total, size - total, MSG_DONTWAIT);
+        if (received > 0) {
+            total += static_cast<size_t>(received);
+            continue;
+        }
+        if (received == 0) {
+            co_return std::unexpected(SocketError::CONNECTION_CLOSED);
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            co_return std::unexpected(SocketError::RECV_FAILED);
+        }
+        if (!co_await loop.readable(fd, timeout)) {
+            co_return std::unexpected(SocketError::TIMEOUT);
+        }
+    }
+    co_return std::expected<void, SocketError>{};
+}
+
+Task<std::expected<void, SocketError>> writeAll(EventLoop& loop, int fd, std::span<const std::byte> data) {
+    size_t total = 0;
+    while (total < data.size()) {
+        ssize_t sent = send(fd, data.data() + total, data.size() - total, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (sent >= 0) {
+            total += static_cast<size_t>(sent);
+            continue;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            co_return std::unexpected(SocketError::SEND_FAILED);
+        }
+        co_await loop.writable(fd);
+    }
+    co_return std::expected<void, SocketError>{};
+}
+
+} // namespace NET
@@ -0,0 +1,95 @@
+#include "../../include/network/parse_cache.hpp"
+
+#include <stdexcept>
+
+#include "../../include/client/Lexer.hpp"
+
+namespace NET {
+
+namespace {
+
+// 去掉首尾空白和结尾的分号，使 "select * from t;" 与 "select * from t" 命中同一条缓存
+std::string_view normalize(std::string_view sql) {
+    constexpr std::string_view trailing = " \t\r\n\v\f;";
+    size_t begin = sql.find_first_not_of(" \t\r\n\v\f");
+    if (begin == std::string_view::npos) {
+        return {};
+    }
+    size_t end = sql.find_last_not_of(trailing);
+    return sql.substr(begin, end + 1 - begin);
+}
+
+} // namespace
+
+ParseCache::ParseCache(size_t cache_capacity) : capacity(cache_capacity) {
+    index.reserve(capacity);
+}
+
+std::expected<std::shared_ptr<const QueryRequest>, std::string> ParseCache::parse(std::string_view sql) {
+    if (auto cached = lookup(sql)) {
+        return cached;
+    }
+    auto result = parseUncached(sql);
+    if (result.has_value()) {
+        insert(sql, result.value());
+    }
+    return result;
+}
+
+std::shared_ptr<const QueryRequest> ParseCache::lookup(std::string_view sql) {
+    auto it = index.find(normalize(sql));
+    if (it == index.end()) {
+        ++stats.misses;
+        return nullptr;
+    }
+    ++stats.hits;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->request;
+}
+
+void ParseCache::insert(std::string_view sql, std::shared_ptr<const QueryRequest> request) {
+    std::string_view statement = normalize(sql);
+    if (capacity == 0 || statement.size() > MAX_CACHED_STATEMENT_BYTES || index.contains(statement)) {
+        return;
+    }
+    if (entries.size() >= capacity) {
+        index.erase(entries.back().sql);
+        entries.pop_back();
+        ++stats.evictions;
+    }
+    entries.push_front({std::string(statement), std::move(request)});
+    index.emplace(entries.front().sql, entries.begin());
+}
+
+void ParseCache::clear() {
+    index.clear();
+    entries.clear();
+}
+
+ParseCacheStats ParseCache::getStats() const {
+    ParseCacheStats result = stats;
+    result.entries = entries.size();
+    return result;
+}
+
+std::expected<std::shared_ptr<const QueryRequest>, std::string> ParseCache::parseUncached(std::string_view sql) {
+    std::unique_ptr<Command> command;
+    try {
+        Lexer lexer(normalize(sql));
+        Parser parser(lexer.tokenize());
+        command = parser.parse();
+    } catch (const std::runtime_error& e) {
+        return std::unexpected(std::string(e.what()));
+    }
+    if (!command) {
+        return std::unexpected(std::string("Empty statement"));
+    }
+
+    auto request = QueryBuilder::build(*command);
+    if (!request.has_value()) {
+        return std::unexpected(std::string("Unsupported statement"));
+    }
+    return std::make_shared<const QueryRequest>(std::move(request.value()));
+}
+
+} // namespace NET
@@ -124,6 +124,10 @@ LoginRequest::LoginRequest(std::string user, std::string pass)
 void LoginRequest::serializePayload(Serializer& serializer) const {
     serializer.writeString(username);
     serializer.writeString(password);
+    if (protocol_version > PROTOCOL_VERSION_LEGACY) {
+        serializer.writeU16(protocol_version);
+        serializer.writeU32(capabilities);
+    }
 }
 
 std::expected<void, ProtocolError> LoginRequest::deserializePayload(Deserializer& deserializer) {
@@ -140,6 +144,26 @@ std::expected<void, ProtocolError> LoginRequest::deserializePayload(Deserializer
     username = std::move(username_result.value());
     password = std::move(password_result.value());
     
+    // 旧版客户端的请求到此结束
+    if (deserializer.remaining() == 0) {
+        protocol_version = PROTOCOL_VERSION_LEGACY;
+        capabilities = 0;
+        return {};
+    }
+    
+    auto version_result = deserializer.readU16();
+    if (!version_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    auto caps_result = deserializer.readU32();
+    if (!caps_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    protocol_version = version_result.value();
+    capabilities = caps_result.value();
+    
     return {};
 }
 
@@ -148,6 +172,11 @@ void LoginRequest::setCredentials(std::string user, std::string pass) {
     password = std::move(pass);
 }
 
+void LoginRequest::setProtocol(uint16_t version, uint32_t caps) {
+    protocol_version = version;
+    capabilities = caps;
+}
+
 // ========== LoginSuccess Implementation ==========
 
 LoginSuccess::LoginSuccess() : Message(MessageType::LOGIN_SUCCESS), user_id(0) {}
@@ -158,6 +187,10 @@ LoginSuccess::LoginSuccess(std::string token, uint32_t uid)
 void LoginSuccess::serializePayload(Serializer& serializer) const {
     serializer.writeString(session_token);
     serializer.writeU32(user_id);
+    if (protocol_version > PROTOCOL_VERSION_LEGACY) {
+        serializer.writeU16(protocol_version);
+        serializer.writeU32(capabilities);
+    }
 }
 
 std::expected<void, ProtocolError> LoginSuccess::deserializePayload(Deserializer& deserializer) {
@@ -174,6 +207,26 @@ std::expected<void, ProtocolError> LoginSuccess::deserializePayload(Deserializer
     session_token = std::move(token_result.value());
     user_id = uid_result.value();
     
+    // 旧版服务端的响应到此结束
+    if (deserializer.remaining() == 0) {
+        protocol_version = PROTOCOL_VERSION_LEGACY;
+        capabilities = 0;
+        return {};
+    }
+    
+    auto version_result = deserializer.readU16();
+    if (!version_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    auto caps_result = deserializer.readU32();
+    if (!caps_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    protocol_version = version_result.value();
+    capabilities = caps_result.value();
+    
     return {};
 }
 
@@ -182,6 +235,11 @@ void LoginSuccess::setSessionInfo(std::string token, uint32_t uid) {
     user_id = uid;
 }
 
+void LoginSuccess::setProtocol(uint16_t version, uint32_t caps) {
+    protocol_version = version;
+    capabilities = caps;
+}
+
 // ========== LoginFailure Implementation ==========
 
 LoginFailure::LoginFailure() : Message(MessageType::LOGIN_FAILURE) {}
@@ -320,12 +378,16 @@ void QueryResponse::setError(std::string error) {
     rows.clear();
 }
 
+uint64_t currentTimestampMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()
+    ).count();
+}
+
 // ========== PingRequest Implementation ==========
 
 PingRequest::PingRequest() : Message(MessageType::PING_REQUEST) {
-    timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+    timestamp = currentTimestampMicros();
 }
 
 PingRequest::PingRequest(uint64_t ts) : Message(MessageType::PING_REQUEST), timestamp(ts) {}
@@ -347,9 +409,7 @@ std::expected<void, ProtocolError> PingRequest::deserializePayload(Deserializer&
 // ========== PongResponse Implementation ==========
 
 PongResponse::PongResponse() : Message(MessageType::PONG_RESPONSE), original_timestamp(0) {
-    server_timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()
-    ).count();
+    server_timestamp = currentTimestampMicros();
 }
 
 PongResponse::PongResponse(uint64_t orig_ts, uint64_t server_ts) 
@@ -382,6 +442,105 @@ void PongResponse::setTimestamps(uint64_t orig_ts, uint64_t server_ts) {
     server_timestamp = server_ts;
 }
 
+// ========== ShmAttachRequest Implementation ==========
+
+ShmAttachRequest::ShmAttachRequest() : Message(MessageType::SHM_ATTACH_REQUEST), ring_capacity(0) {}
+
+ShmAttachRequest::ShmAttachRequest(uint64_t capacity) 
+    : Message(MessageType::SHM_ATTACH_REQUEST), ring_capacity(capacity) {}
+
+void ShmAttachRequest::serializePayload(Serializer& serializer) const {
+    serializer.writeU64(ring_capacity);
+}
+
+std::expected<void, ProtocolError> ShmAttachRequest::deserializePayload(Deserializer& deserializer) {
+    auto capacity_result = deserializer.readU64();
+    if (!capacity_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    ring_capacity = capacity_result.value();
+    return {};
+}
+
+// ========== ShmAttachResponse Implementation ==========
+
+ShmAttachResponse::ShmAttachResponse() : Message(MessageType::SHM_ATTACH_RESPONSE), accepted(false) {}
+
+ShmAttachResponse::ShmAttachResponse(bool accepted, std::string message) 
+    : Message(MessageType::SHM_ATTACH_RESPONSE), accepted(accepted), message(std::move(message)) {}
+
+void ShmAttachResponse::serializePayload(Serializer& serializer) const {
+    serializer.writeU8(accepted ? 1 : 0);
+    serializer.writeString(message);
+}
+
+std::expected<void, ProtocolError> ShmAttachResponse::deserializePayload(Deserializer& deserializer) {
+    auto accepted_result = deserializer.readU8();
+    if (!accepted_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    auto message_result = deserializer.readString();
+    if (!message_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    accepted = accepted_result.value() != 0;
+    message = std::move(message_result.value());
+    
+    return {};
+}
+
+// ========== CancelRequest Implementation ==========
+
+CancelRequest::CancelRequest() : Message(MessageType::CANCEL_REQUEST) {}
+
+CancelRequest::CancelRequest(std::string token) 
+    : Message(MessageType::CANCEL_REQUEST), session_token(std::move(token)) {}
+
+void CancelRequest::serializePayload(Serializer& serializer) const {
+    serializer.writeString(session_token);
+}
+
+std::expected<void, ProtocolError> CancelRequest::deserializePayload(Deserializer& deserializer) {
+    auto token_result = deserializer.readString();
+    if (!token_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    session_token = std::move(token_result.value());
+    return {};
+}
+
+// ========== SqlTextRequest Implementation ==========
+
+SqlTextRequest::SqlTextRequest() : Message(MessageType::SQL_TEXT_REQUEST) {}
+
+SqlTextRequest::SqlTextRequest(std::string token, std::string statement) 
+    : Message(MessageType::SQL_TEXT_REQUEST), session_token(std::move(token)), sql(std::move(statement)) {}
+
+void SqlTextRequest::serializePayload(Serializer& serializer) const {
+    serializer.writeString(session_token);
+    serializer.writeString(sql);
+}
+
+std::expected<void, ProtocolError> SqlTextRequest::deserializePayload(Deserializer& deserializer) {
+    auto token_result = deserializer.readString();
+    if (!token_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    auto sql_result = deserializer.readString();
+    if (!sql_result.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    
+    session_token = std::move(token_result.value());
+    sql = std::move(sql_result.value());
+    return {};
+}
+
 // ========== ErrorResponse Implementation ==========
 
 ErrorResponse::ErrorResponse() : Message(MessageType::ERROR_RESPONSE), error_code(0) {}
@@ -435,6 +594,14 @@ MessageFactory::createMessage(MessageType type) {
             return std::make_unique<PingRequest>();
         case MessageType::PONG_RESPONSE:
             return std::make_unique<PongResponse>();
+        case MessageType::SHM_ATTACH_REQUEST:
+            return std::make_unique<ShmAttachRequest>();
+        case MessageType::SHM_ATTACH_RESPONSE:
+            return std::make_unique<ShmAttachResponse>();
+        case MessageType::CANCEL_REQUEST:
+            return std::make_unique<CancelRequest>();
+        case MessageType::SQL_TEXT_REQUEST:
+            return std::make_unique<SqlTextRequest>();
         case MessageType::ERROR_RESPONSE:
             return std::make_unique<ErrorResponse>();
         default:
@@ -58,6 +58,12 @@ void WhereCondition::serialize(Serializer& serializer) const {
     serializer.writeString(column);
     serializer.writeString(operator_str);
     value.serialize(serializer);
+    if (hasValueList()) {
+        serializer.writeU32(static_cast<uint32_t>(values.size()));
+        for (const auto& val : values) {
+            val.serialize(serializer);
+        }
+    }
 }
 
 std::expected<WhereCondition, ProtocolError> WhereCondition::deserialize(Deserializer& deserializer) {
@@ -76,9 +82,91 @@ std::expected<WhereCondition, ProtocolError> WhereCondition::deserialize(Deseria
         return std::unexpected(value_result.error());
     }
     
-    return WhereCondition(std::move(column_result.value()), 
-                         std::move(op_result.value()),
-                         std::move(value_result.value()));
+    WhereCondition condition(std::move(column_result.value()), 
+                             std::move(op_result.value()),
+                             std::move(value_result.value()));
+    if (condition.hasValueList()) {
+        auto count_result = deserializer.readU32();
+        if (!count_result.has_value()) {
+            return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+        }
+        for (uint32_t i = 0; i < count_result.value(); ++i) {
+            auto val_result = LiteralValue::deserialize(deserializer);
+            if (!val_result.has_value()) {
+                return std::unexpected(val_result.error());
+            }
+            condition.values.push_back(std::move(val_result.value()));
+        }
+    }
+    return condition;
+}
+
+// ========== WhereExpression Implementation ==========
+
+uint32_t WhereCondition::requiredCapabilities() const {
+    if (hasValueList()) {
+        return CAP_SET_PREDICATES;
+    }
+    if (operator_str == "LIKE" || operator_str == "ILIKE") {
+        return CAP_LIKE;
+    }
+    return 0;
+}
+
+uint32_t WhereExpression::requiredCapabilities() const {
+    if (kind == Kind::CONDITION) {
+        return condition.requiredCapabilities();
+    }
+    uint32_t required = CAP_BOOLEAN_WHERE;
+    for (const auto& child : children) {
+        required |= child.requiredCapabilities();
+    }
+    return required;
+}
+
+void WhereExpression::serialize(Serializer& serializer) const {
+    serializer.writeU8(static_cast<uint8_t>(kind));
+    if (kind == Kind::CONDITION) {
+        condition.serialize(serializer);
+        return;
+    }
+    serializer.writeU32(static_cast<uint32_t>(children.size()));
+    for (const auto& child : children) {
+        child.serialize(serializer);
+    }
+}
+
+std::expected<WhereExpression, ProtocolError> WhereExpression::deserialize(Deserializer& deserializer, int depth) {
+    if (depth > MAX_DEPTH) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    auto kind_result = deserializer.readU8();
+    if (!kind_result.has_value() || kind_result.value() > static_cast<uint8_t>(Kind::NOT)) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    auto kind = static_cast<Kind>(kind_result.value());
+    if (kind == Kind::CONDITION) {
+        auto condition_result = WhereCondition::deserialize(deserializer);
+        if (!condition_result.has_value()) {
+            return std::unexpected(condition_result.error());
+        }
+        return WhereExpression(std::move(condition_result.value()));
+    }
+    
+    auto count_result = deserializer.readU32();
+    if (!count_result.has_value() || count_result.value() == 0 ||
+        (kind == Kind::NOT && count_result.value() != 1)) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    std::vector<WhereExpression> children;
+    for (uint32_t i = 0; i < count_result.value(); ++i) {
+        auto child_result = deserialize(deserializer, depth + 1);
+        if (!child_result.has_value()) {
+            return std::unexpected(child_result.error());
+        }
+        children.push_back(std::move(child_result.value()));
+    }
+    return WhereExpression(kind, std::move(children));
 }
 
 // ========== SetClause Implementation ==========
@@ -138,13 +226,26 @@ void QueryRequest::serializePayload(Serializer& serializer) const {
         clause.serialize(serializer);
     }
     
-    // 序列化WHERE条件
-    serializer.writeU8(where_condition.has_value() ? 1 : 0);
-    if (where_condition.has_value()) {
-        where_condition.value().serialize(serializer);
+    // 序列化WHERE条件：0 无，1 单个条件（旧版编码），2 表达式树
+    if (!where_expression.has_value()) {
+        serializer.writeU8(0);
+    } else if (where_expression->isCondition()) {
+        serializer.writeU8(1);
+        where_expression->condition.serialize(serializer);
+    } else {
+        serializer.writeU8(2);
+        where_expression->serialize(serializer);
     }
 }
 
+uint32_t QueryRequest::requiredCapabilities() const {
+    uint32_t required = 0;
+    if (where_expression.has_value()) {
+        required |= where_expression->requiredCapabilities();
+    }
+    return required;
+}
+
 std::expected<void, ProtocolError> QueryRequest::deserializePayload(Deserializer& deserializer) {
     // 反序列化基本信息
     auto op_result = deserializer.readU8();
@@ -240,14 +341,20 @@ std::expected<void, ProtocolError> QueryRequest::deserializePayload(Deserializer
         return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
     }
     
-    if (has_where_result.value() != 0) {
+    if (has_where_result.value() == 1) {
         auto where_result = WhereCondition::deserialize(deserializer);
         if (!where_result.has_value()) {
             return std::unexpected(where_result.error());
         }
-        where_condition = std::move(where_result.value());
+        where_expression = WhereExpression(std::move(where_result.value()));
+    } else if (has_where_result.value() == 2) {
+        auto where_result = WhereExpression::deserialize(deserializer);
+        if (!where_result.has_value()) {
+            return std::unexpected(where_result.error());
+        }
+        where_expression = std::move(where_result.value());
     } else {
-        where_condition.reset();
+        where_expression.reset();
     }
     
     return {};
@@ -313,7 +420,7 @@ QueryRequest QueryBuilder::buildSelect(const SelectCommand& cmd) {
     // 如果select_all为true，则select_columns保持为空，表示SELECT *
     
     if (cmd.where_clause.has_value()) {
-        request.setWhereCondition(convertWhereClause(cmd.where_clause.value()));
+        request.setWhereExpression(convertWhereClause(cmd.where_clause.value()));
     }
     
     return request;
@@ -330,7 +437,7 @@ QueryRequest QueryBuilder::buildUpdate(const UpdateCommand& cmd) {
     request.setUpdateClauses(clauses);
     
     if (cmd.where_clause.has_value()) {
-        request.setWhereCondition(convertWhereClause(cmd.where_clause.value()));
+        request.setWhereExpression(convertWhereClause(cmd.where_clause.value()));
     }
     
     return request;
@@ -341,12 +448,52 @@ QueryRequest QueryBuilder::buildDelete(const DeleteCommand& cmd) {
     request.setTableName(cmd.table_name);
     
     if (cmd.where_clause.has_value()) {
-        request.setWhereCondition(convertWhereClause(cmd.where_clause.value()));
+        request.setWhereExpression(convertWhereClause(cmd.where_clause.value()));
     }
     
     return request;
 }
 
+QueryRequest QueryBuilder::buildShowStats(const ShowStatsCommand&) {
+    return QueryRequest(OperationType::SHOW_STATS);
+}
+
+QueryRequest QueryBuilder::buildShowTrace(const ShowTraceCommand&) {
+    return QueryRequest(OperationType::SHOW_TRACE);
+}
+
+QueryRequest QueryBuilder::buildShowMemory(const ShowMemoryCommand&) {
+    return QueryRequest(OperationType::SHOW_MEMORY);
+}
+
+QueryRequest QueryBuilder::buildShowAdmission(const ShowAdmissionCommand&) {
+    return QueryRequest(OperationType::SHOW_ADMISSION);
+}
+
+QueryRequest QueryBuilder::buildSetOption(const SetOptionCommand& cmd) {
+    QueryRequest request(OperationType::SET_OPTION);
+    request.setUpdateClauses({SetClause(cmd.name, convertLiteralValue(cmd.value))});
+    return request;
+}
+
+std::optional<QueryRequest> QueryBuilder::build(const Command& cmd) {
+    if (auto* c = dynamic_cast<const CreateDatabaseCommand*>(&cmd)) return buildCreateDatabase(*c);
+    if (auto* c = dynamic_cast<const DropDatabaseCommand*>(&cmd)) return buildDropDatabase(*c);
+    if (auto* c = dynamic_cast<const UseDatabaseCommand*>(&cmd)) return buildUseDatabase(*c);
+    if (auto* c = dynamic_cast<const CreateTableCommand*>(&cmd)) return buildCreateTable(*c);
+    if (auto* c = dynamic_cast<const DropTableCommand*>(&cmd)) return buildDropTable(*c);
+    if (auto* c = dynamic_cast<const InsertCommand*>(&cmd)) return buildInsert(*c);
+    if (auto* c = dynamic_cast<const SelectCommand*>(&cmd)) return buildSelect(*c);
+    if (auto* c = dynamic_cast<const UpdateCommand*>(&cmd)) return buildUpdate(*c);
+    if (auto* c = dynamic_cast<const DeleteCommand*>(&cmd)) return buildDelete(*c);
+    if (auto* c = dynamic_cast<const ShowStatsCommand*>(&cmd)) return buildShowStats(*c);
+    if (auto* c = dynamic_cast<const ShowTraceCommand*>(&cmd)) return buildShowTrace(*c);
+    if (auto* c = dynamic_cast<const ShowMemoryCommand*>(&cmd)) return buildShowMemory(*c);
+    if (auto* c = dynamic_cast<const ShowAdmissionCommand*>(&cmd)) return buildShowAdmission(*c);
+    if (auto* c = dynamic_cast<const SetOptionCommand*>(&cmd)) return buildSetOption(*c);
+    return std::nullopt;
+}
+
 // 类型转换辅助函数
 DataType QueryBuilder::convertTokenType(TokenType token_type) {
     switch (token_type) {
@@ -369,9 +516,38 @@ ColumnDefinition QueryBuilder::convertColumnDef(const ColumnDef& client_col) {
     return ColumnDefinition(client_col.name, type, client_col.is_primary);
 }
 
-WhereCondition QueryBuilder::convertWhereClause(const WhereClause& client_where) {
-    LiteralValue value = convertLiteralValue(client_where.value);
-    return WhereCondition(client_where.column, client_where.op, std::move(value));
+WhereCondition QueryBuilder::convertCondition(const Condition& client_condition) {
+    if (!client_condition.values.empty()) {
+        std::vector<LiteralValue> values;
+        values.reserve(client_condition.values.size());
+        for (const auto& val : client_condition.values) {
+            values.push_back(convertLiteralValue(val));
+        }
+        return WhereCondition(client_condition.column, client_condition.op, std::move(values));
+    }
+    LiteralValue value = convertLiteralValue(client_condition.value);
+    return WhereCondition(client_condition.column, client_condition.op, std::move(value));
+}
+
+WhereExpression QueryBuilder::convertWhereClause(const WhereClause& client_where) {
+    switch (client_where.kind) {
+        case WhereExpr::Kind::AND:
+        case WhereExpr::Kind::OR:
+        case WhereExpr::Kind::NOT: {
+            std::vector<WhereExpression> children;
+            children.reserve(client_where.children.size());
+            for (const auto& child : client_where.children) {
+                children.push_back(convertWhereClause(child));
+            }
+            auto kind = client_where.kind == WhereExpr::Kind::AND ? WhereExpression::Kind::AND
+                      : client_where.kind == WhereExpr::Kind::OR  ? WhereExpression::Kind::OR
+                                                                  : WhereExpression::Kind::NOT;
+            return WhereExpression(kind, std::move(children));
+        }
+        case WhereExpr::Kind::CONDITION:
+            break;
+    }
+    return WhereExpression(convertCondition(client_where.condition));
 }
 
 SetClause QueryBuilder::convertSetClause(const ::SetClause& client_set) {
@@ -396,6 +572,13 @@ bool NetworkQueryExecutor::isAuthenticated() const {
 void NetworkQueryExecutor::clearAuthentication() {
     // 清空session_token，将用户置为未认证状态
     session_token.clear();
+    protocol_version = PROTOCOL_VERSION_LEGACY;
+    capabilities = 0;
+}
+
+void NetworkQueryExecutor::setProtocol(uint16_t version, uint32_t caps) {
+    protocol_version = version;
+    capabilities = caps;
 }
 
 std::expected<std::unique_ptr<QueryResponse>, SocketError> 
@@ -404,20 +587,38 @@ NetworkQueryExecutor::executeQuery(const QueryRequest& request) {
         return std::unexpected(SocketError::SEND_FAILED);
     }
     
+    // 旧版服务端无法解析新的编码
+    if ((request.requiredCapabilities() & ~capabilities) != 0) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+    
     // 创建请求的副本并设置token
     QueryRequest query_request = request;
     query_request.setSessionToken(session_token);
     
-    // 发送请求
-    auto send_result = client.sendMessage(query_request);
-    if (!send_result.has_value()) {
-        std::cerr << "[ERROR] Failed to send query request" << std::endl;
-        return std::unexpected(send_result.error());
+    return sendRequest(query_request);
+}
+
+std::expected<std::unique_ptr<QueryResponse>, SocketError> 
+NetworkQueryExecutor::executeSql(const std::string& sql) {
+    if (session_token.empty()) {
+        return std::unexpected(SocketError::SEND_FAILED);
     }
-    
-    // 接收响应
-    auto response_result = client.receiveMessage();
+    if (!hasCapability(CAP_SQL_TEXT)) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+    return sendRequest(SqlTextRequest(session_token, sql));
+}
+
+std::expected<std::unique_ptr<QueryResponse>, SocketError> 
+NetworkQueryExecutor::sendRequest(const Message& request) {
+    // 发送请求并接收响应（与心跳互斥）
+    auto response_result = client.request(request);
     if (!response_result.has_value()) {
+        if (response_result.error() == SocketError::SEND_FAILED) {
+            std::cerr << "[ERROR] Failed to send query request" << std::endl;
+            return std::unexpected(SocketError::SEND_FAILED);
+        }
         std::cerr << "[ERROR] Failed to receive query response" << std::endl;
         return std::unexpected(SocketError::RECV_FAILED);
     }
@@ -438,4 +639,69 @@ NetworkQueryExecutor::executeQuery(const QueryRequest& request) {
     return std::unexpected(SocketError::RECV_FAILED);
 }
 
+std::expected<ResultSet, SocketError> NetworkQueryExecutor::fetch(const QueryRequest& request) {
+    if (session_token.empty()) {
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+    if ((request.requiredCapabilities() & ~capabilities) != 0) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+    QueryRequest query_request = request;
+    query_request.setSessionToken(session_token);
+    return sendRequestLazy(query_request);
+}
+
+std::expected<ResultSet, SocketError> NetworkQueryExecutor::fetchSql(const std::string& sql) {
+    if (session_token.empty()) {
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+    if (!hasCapability(CAP_SQL_TEXT)) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+    return sendRequestLazy(SqlTextRequest(session_token, sql));
+}
+
+std::expected<ResultSet, SocketError> NetworkQueryExecutor::sendRequestLazy(const Message& request) {
+    auto frame = client.requestFrame(request);
+    if (!frame.has_value()) {
+        if (frame.error() == SocketError::SEND_FAILED) {
+            std::cerr << "[ERROR] Failed to send query request" << std::endl;
+            return std::unexpected(SocketError::SEND_FAILED);
+        }
+        std::cerr << "[ERROR] Failed to receive query response" << std::endl;
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    
+    // 只看头部判断类型；ERROR_RESPONSE 很少见，解码后按 sendRequest 的方式报告
+    Deserializer header_reader(frame.value());
+    auto header = MessageHeader::deserialize(header_reader);
+    if (header.has_value() && header->getType() == MessageType::ERROR_RESPONSE) {
+        auto message = Message::deserialize(frame.value());
+        if (message.has_value()) {
+            auto* error_response = dynamic_cast<ErrorResponse*>(message.value().get());
+            std::cerr << "[ERROR] Server error: " << error_response->getErrorMessage() << std::endl;
+        }
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    
+    auto result = ResultSet::fromFrame(std::move(frame.value()));
+    if (!result.has_value()) {
+        std::cerr << "[ERROR] Unexpected response type" << std::endl;
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    return std::move(result.value());
+}
+
+std::expected<void, SocketError> NetworkQueryExecutor::cancel() {
+    if (session_token.empty()) {
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+    // 旧版服务端无法解析 CANCEL 消息
+    if (!hasCapability(CAP_CANCEL)) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+    // 不等待响应：被取消的语句的 QUERY_RESPONSE 由 executeQuery 接收
+    return client.sendMessage(CancelRequest(session_token));
+}
+
 } // namespace NET
\ No newline at end of file
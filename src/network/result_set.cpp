@@ -0,0 +1,256 @@
+#include "../../include/network/result_set.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <arpa/inet.h>
+
+namespace NET {
+
+namespace {
+
+uint32_t loadU32(const std::byte* data) {
+    uint32_t network_value;
+    std::memcpy(&network_value, data, sizeof(network_value));
+    return ntohl(network_value);
+}
+
+template <typename T>
+std::expected<T, FieldError> parseNumber(std::string_view text) {
+    T value{};
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec == std::errc::result_out_of_range) {
+        return std::unexpected(FieldError::VALUE_OUT_OF_RANGE);
+    }
+    if (ec != std::errc() || end != text.data() + text.size()) {
+        return std::unexpected(FieldError::INVALID_VALUE);
+    }
+    return value;
+}
+
+bool equalsIgnoreCase(std::string_view text, std::string_view expected) {
+    return std::equal(text.begin(), text.end(), expected.begin(), expected.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+}
+
+// 顺序读取长度前缀，只做越界检查，不拷贝数据
+class FrameScanner {
+public:
+    FrameScanner(const std::vector<std::byte>& data, size_t start) : frame(data), position(start) {}
+
+    std::optional<uint32_t> readU32() {
+        if (frame.size() - position < sizeof(uint32_t)) {
+            return std::nullopt;
+        }
+        uint32_t value = loadU32(frame.data() + position);
+        position += sizeof(uint32_t);
+        return value;
+    }
+
+    // 跳过一个长度前缀字符串，返回它的起始偏移
+    std::optional<uint32_t> skipString() {
+        uint32_t offset = static_cast<uint32_t>(position);
+        auto length = readU32();
+        if (!length.has_value() || frame.size() - position < length.value()) {
+            return std::nullopt;
+        }
+        position += length.value();
+        return offset;
+    }
+
+    std::optional<uint8_t> readU8() {
+        if (position >= frame.size()) {
+            return std::nullopt;
+        }
+        return static_cast<uint8_t>(frame[position++]);
+    }
+
+private:
+    const std::vector<std::byte>& frame;
+    size_t position;
+};
+
+} // namespace
+
+// ========== RowView Implementation ==========
+
+size_t ResultSet::RowView::size() const {
+    if (row >= result->getRowCount()) {
+        return 0;
+    }
+    return result->row_begin[row + 1] - result->row_begin[row];
+}
+
+std::expected<std::string_view, FieldError> ResultSet::RowView::getStringView(size_t column) const {
+    return result->getStringView(row, column);
+}
+
+std::expected<int64_t, FieldError> ResultSet::RowView::getInt64(size_t column) const {
+    return result->getInt64(row, column);
+}
+
+std::expected<double, FieldError> ResultSet::RowView::getDouble(size_t column) const {
+    return result->getDouble(row, column);
+}
+
+std::expected<bool, FieldError> ResultSet::RowView::getBool(size_t column) const {
+    return result->getBool(row, column);
+}
+
+// ========== ResultSet Implementation ==========
+
+std::expected<ResultSet, ProtocolError> ResultSet::fromFrame(std::vector<std::byte> data) {
+    Deserializer header_reader(data);
+    auto header = MessageHeader::deserialize(header_reader);
+    if (!header.has_value()) {
+        return std::unexpected(header.error());
+    }
+    if (header->getType() != MessageType::QUERY_RESPONSE) {
+        return std::unexpected(ProtocolError::INVALID_MESSAGE_TYPE);
+    }
+    if (data.size() != MessageHeader::HEADER_SIZE + header->getPayloadSize()) {
+        return std::unexpected(ProtocolError::PAYLOAD_SIZE_MISMATCH);
+    }
+
+    ResultSet result;
+    result.frame = std::move(data);
+    FrameScanner scanner(result.frame, MessageHeader::HEADER_SIZE);
+
+    auto success = scanner.readU8();
+    if (!success.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    result.success = success.value() != 0;
+    if (!result.success) {
+        auto offset = scanner.skipString();
+        if (!offset.has_value()) {
+            return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+        }
+        result.error_message = std::string(result.stringAt(offset.value()));
+        return result;
+    }
+
+    auto column_count = scanner.readU32();
+    if (!column_count.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    for (uint32_t i = 0; i < column_count.value(); ++i) {
+        auto offset = scanner.skipString();
+        if (!offset.has_value()) {
+            return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+        }
+        result.column_offsets.push_back(offset.value());
+    }
+
+    auto row_count = scanner.readU32();
+    if (!row_count.has_value()) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    // 每行至少占 4 字节，先按剩余长度检查行数，避免按伪造的行数预留内存
+    if (row_count.value() > result.frame.size() / sizeof(uint32_t)) {
+        return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+    }
+    result.row_begin.reserve(row_count.value() + 1);
+    result.cells.reserve(std::min<size_t>(static_cast<size_t>(row_count.value()) * column_count.value(),
+                                          result.frame.size() / sizeof(uint32_t)));
+    result.row_begin.push_back(0);
+    for (uint32_t r = 0; r < row_count.value(); ++r) {
+        auto cell_count = scanner.readU32();
+        if (!cell_count.has_value()) {
+            return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+        }
+        for (uint32_t i = 0; i < cell_count.value(); ++i) {
+            auto offset = scanner.skipString();
+            if (!offset.has_value()) {
+                return std::unexpected(ProtocolError::DESERIALIZATION_FAILED);
+            }
+            result.cells.push_back(offset.value());
+        }
+        result.row_begin.push_back(static_cast<uint32_t>(result.cells.size()));
+    }
+    return result;
+}
+
+std::string_view ResultSet::getColumnName(size_t column) const {
+    return stringAt(column_offsets.at(column));
+}
+
+std::optional<size_t> ResultSet::findColumn(std::string_view name) const {
+    for (size_t i = 0; i < column_offsets.size(); ++i) {
+        if (stringAt(column_offsets[i]) == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string_view ResultSet::stringAt(uint32_t offset) const {
+    uint32_t length = loadU32(frame.data() + offset);
+    return std::string_view(reinterpret_cast<const char*>(frame.data() + offset + sizeof(uint32_t)), length);
+}
+
+std::expected<std::string_view, FieldError> ResultSet::cell(size_t row, size_t column) const {
+    if (row >= getRowCount() || column >= row_begin[row + 1] - row_begin[row]) {
+        return std::unexpected(FieldError::NO_SUCH_FIELD);
+    }
+    return stringAt(cells[row_begin[row] + column]);
+}
+
+std::expected<std::string_view, FieldError> ResultSet::getStringView(size_t row, size_t column) const {
+    return cell(row, column);
+}
+
+std::expected<int64_t, FieldError> ResultSet::getInt64(size_t row, size_t column) const {
+    auto text = cell(row, column);
+    if (!text.has_value()) {
+        return std::unexpected(text.error());
+    }
+    return parseNumber<int64_t>(text.value());
+}
+
+std::expected<double, FieldError> ResultSet::getDouble(size_t row, size_t column) const {
+    auto text = cell(row, column);
+    if (!text.has_value()) {
+        return std::unexpected(text.error());
+    }
+    return parseNumber<double>(text.value());
+}
+
+std::expected<bool, FieldError> ResultSet::getBool(size_t row, size_t column) const {
+    auto text = cell(row, column);
+    if (!text.has_value()) {
+        return std::unexpected(text.error());
+    }
+    if (text.value() == "1" || equalsIgnoreCase(text.value(), "true")) {
+        return true;
+    }
+    if (text.value() == "0" || equalsIgnoreCase(text.value(), "false")) {
+        return false;
+    }
+    return std::unexpected(FieldError::INVALID_VALUE);
+}
+
+QueryResponse ResultSet::materialize() const {
+    if (!success) {
+        return QueryResponse(error_message);
+    }
+
+    std::vector<std::string> columns;
+    columns.reserve(column_offsets.size());
+    for (uint32_t offset : column_offsets) {
+        columns.emplace_back(stringAt(offset));
+    }
+
+    std::vector<QueryResponse::Row> rows(getRowCount());
+    for (size_t r = 0; r < rows.size(); ++r) {
+        rows[r].columns.reserve(row_begin[r + 1] - row_begin[r]);
+        for (uint32_t i = row_begin[r]; i < row_begin[r + 1]; ++i) {
+            rows[r].columns.emplace_back(stringAt(cells[i]));
+        }
+    }
+    return QueryResponse(std::move(columns), std::move(rows));
+}
+
+} // namespace NET
@@ -0,0 +1,394 @@
+#include "../../include/network/shm_transport.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <thread>
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace NET {
+
+// 映射开头的控制块，其后依次为：请求环头、请求环数据、响应环头、响应环数据
+struct ShmLayout {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t ring_capacity;
+    alignas(64) std::atomic<uint32_t> closed;  // 任一端关闭后置 1
+};
+
+namespace {
+
+constexpr uint32_t SHM_MAGIC = 0x53445351;  // "SDSQ"
+constexpr uint32_t SHM_VERSION = 1;
+constexpr uint64_t MIN_RING_CAPACITY = 4096;
+constexpr uint64_t MAX_RING_CAPACITY = 1ull << 30;
+
+// futex 睡眠的超时，超时后检查对端是否已断开
+constexpr timespec SLEEP_TIMEOUT = {0, 50 * 1000 * 1000};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free && sizeof(std::atomic<uint32_t>) == 4,
+              "futex words must be plain 32-bit integers");
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "ring indices are shared between processes and must be lock-free");
+
+std::atomic<int64_t> g_spin_nanos{std::thread::hardware_concurrency() > 1 ? 50000 : 0};
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+constexpr size_t ringOffset(uint64_t capacity, int index) {
+    return alignUp(sizeof(ShmLayout), 64) + index * (sizeof(ShmRingHeader) + capacity);
+}
+
+constexpr size_t mappingSize(uint64_t capacity) {
+    return ringOffset(capacity, 2);
+}
+
+ShmRing ringAt(void* mapping, uint64_t capacity, int index) {
+    auto* base = static_cast<std::byte*>(mapping) + ringOffset(capacity, index);
+    return ShmRing{std::launder(reinterpret_cast<ShmRingHeader*>(base)),
+                   base + sizeof(ShmRingHeader), capacity};
+}
+
+// 映射是进程间共享的，不能使用 FUTEX_PRIVATE_FLAG（std::atomic::wait 用的就是私有 futex）
+void futexWait(std::atomic<uint32_t>& word, uint32_t expected) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &SLEEP_TIMEOUT, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// 推进索引后，若对端登记了睡眠则递增序号并唤醒
+void notify(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& sleeping) {
+    if (sleeping.load() != 0) {
+        seq.fetch_add(1);
+        futexWake(seq);
+    }
+}
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // namespace
+
+// ========== ShmChannel Implementation ==========
+
+ShmChannel::ShmChannel(int socket_fd, int memfd, void* mapping, size_t mapping_size, bool is_server)
+    : socket_fd(socket_fd), memfd(memfd), mapping(mapping), mapping_size(mapping_size),
+      layout(std::launder(static_cast<ShmLayout*>(mapping))) {
+    ShmRing request_ring = ringAt(mapping, layout->ring_capacity, 0);
+    ShmRing response_ring = ringAt(mapping, layout->ring_capacity, 1);
+    outbound = is_server ? response_ring : request_ring;
+    inbound = is_server ? request_ring : response_ring;
+}
+
+ShmChannel::~ShmChannel() {
+    // 标记关闭并唤醒可能在睡眠的对端
+    layout->closed.store(1);
+    for (ShmRing* ring : {&outbound, &inbound}) {
+        ring->header->data_seq.fetch_add(1);
+        ring->header->space_seq.fetch_add(1);
+        futexWake(ring->header->data_seq);
+        futexWake(ring->header->space_seq);
+    }
+    munmap(mapping, mapping_size);
+    close(memfd);
+}
+
+std::expected<std::unique_ptr<ShmChannel>, SocketError>
+ShmChannel::create(int socket_fd, size_t ring_capacity) {
+    uint64_t capacity = std::bit_ceil(std::clamp<uint64_t>(ring_capacity, MIN_RING_CAPACITY, MAX_RING_CAPACITY));
+    size_t size = mappingSize(capacity);
+
+    int memfd = memfd_create("sdsql-shm", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (memfd < 0) {
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    // 固定大小后密封，服务端据此确认映射区不会被截断
+    if (ftruncate(memfd, static_cast<off_t>(size)) < 0 ||
+        fcntl(memfd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) < 0) {
+        close(memfd);
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (mapping == MAP_FAILED) {
+        close(memfd);
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    new (mapping) ShmLayout{SHM_MAGIC, SHM_VERSION, capacity, 0};
+    for (int index = 0; index < 2; ++index) {
+        new (static_cast<std::byte*>(mapping) + ringOffset(capacity, index)) ShmRingHeader{};
+    }
+
+    return std::unique_ptr<ShmChannel>(new ShmChannel(socket_fd, memfd, mapping, size, false));
+}
+
+std::expected<std::unique_ptr<ShmChannel>, SocketError>
+ShmChannel::attach(int socket_fd, int memfd) {
+    auto reject = [memfd](SocketError error) {
+        close(memfd);
+        return std::unexpected(error);
+    };
+
+    // 未密封的 memfd 可能在映射后被对端截断，访问时触发 SIGBUS
+    int seals = fcntl(memfd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+        return reject(SocketError::UNSUPPORTED);
+    }
+
+    struct stat st{};
+    if (fstat(memfd, &st) < 0 || st.st_size < static_cast<off_t>(mappingSize(MIN_RING_CAPACITY))) {
+        return reject(SocketError::UNSUPPORTED);
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, memfd, 0);
+    if (mapping == MAP_FAILED) {
+        return reject(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    const auto* layout = static_cast<const ShmLayout*>(mapping);
+    uint64_t capacity = layout->ring_capacity;
+    if (layout->magic != SHM_MAGIC || layout->version != SHM_VERSION ||
+        capacity < MIN_RING_CAPACITY || capacity > MAX_RING_CAPACITY ||
+        !std::has_single_bit(capacity) || mappingSize(capacity) != size) {
+        munmap(mapping, size);
+        return reject(SocketError::UNSUPPORTED);
+    }
+
+    return std::unique_ptr<ShmChannel>(new ShmChannel(socket_fd, memfd, mapping, size, true));
+}
+
+uint64_t ShmChannel::getRingCapacity() const {
+    return outbound.capacity;
+}
+
+void ShmChannel::setSpinDuration(std::chrono::nanoseconds duration) {
+    g_spin_nanos.store(duration.count(), std::memory_order_relaxed);
+}
+
+template <typename Ready>
+std::expected<void, SocketError> ShmChannel::waitFor(std::atomic<uint32_t>& seq, std::atomic<uint32_t>& sleeping,
+                                                     Ready ready, std::chrono::steady_clock::time_point deadline) {
+    // 自旋阶段：对端通常在几微秒内就会推进索引
+    auto spin = std::chrono::nanoseconds(g_spin_nanos.load(std::memory_order_relaxed));
+    if (spin.count() > 0) {
+        auto deadline = std::chrono::steady_clock::now() + spin;
+        do {
+            for (int i = 0; i < 64; ++i) {
+                if (ready()) {
+                    return {};
+                }
+                cpuRelax();
+            }
+        } while (std::chrono::steady_clock::now() < deadline);
+    }
+
+    // 睡眠阶段：先读序号、登记睡眠再复查条件。对端推进索引后看到登记就会递增序号，
+    // 因此复查之后的推进会让 futex_wait 立即返回，不会丢失唤醒
+    while (true) {
+        uint32_t observed = seq.load();
+        sleeping.store(1);
+        if (ready()) {
+            sleeping.store(0);
+            return {};
+        }
+        if (layout->closed.load() != 0) {
+            sleeping.store(0);
+            return std::unexpected(SocketError::CONNECTION_CLOSED);
+        }
+
+        futexWait(seq, observed);
+        sleeping.store(0);
+
+        if (ready()) {
+            return {};
+        }
+        if (layout->closed.load() != 0 || peerGone()) {
+            return std::unexpected(SocketError::CONNECTION_CLOSED);
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            return std::unexpected(SocketError::TIMEOUT);
+        }
+    }
+}
+
+bool ShmChannel::peerGone() const {
+    pollfd pfd{socket_fd, POLLRDHUP, 0};
+    if (poll(&pfd, 1, 0) < 0) {
+        return false;
+    }
+    return (pfd.revents & (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)) != 0;
+}
+
+std::expected<void, SocketError> ShmChannel::send(std::span<const std::byte> data) {
+    ShmRingHeader& ring = *outbound.header;
+    const uint64_t capacity = outbound.capacity;
+    size_t offset = 0;
+
+    while (offset < data.size()) {
+        if (layout->closed.load(std::memory_order_acquire) != 0) {
+            return std::unexpected(SocketError::CONNECTION_CLOSED);
+        }
+
+        uint64_t head = ring.head.load(std::memory_order_relaxed);  // 只有本端推进 head
+        uint64_t used = head - ring.tail.load(std::memory_order_acquire);
+        if (used > capacity) {
+            return std::unexpected(SocketError::SEND_FAILED);  // 索引被破坏
+        }
+        if (used == capacity) {
+            auto waited = waitFor(ring.space_seq, ring.writer_sleeping, [&] {
+                return ring.head.load(std::memory_order_relaxed) - ring.tail.load() < capacity;
+            }, std::chrono::steady_clock::time_point::max());
+            if (!waited.has_value()) {
+                return std::unexpected(waited.error());
+            }
+            continue;
+        }
+
+        size_t chunk = std::min<uint64_t>(capacity - used, data.size() - offset);
+        size_t pos = head & (capacity - 1);
+        size_t first = std::min<size_t>(chunk, capacity - pos);
+        std::memcpy(outbound.data + pos, data.data() + offset, first);
+        std::memcpy(outbound.data, data.data() + offset + first, chunk - first);
+
+        ring.head.store(head + chunk);
+        notify(ring.data_seq, ring.reader_sleeping);
+        offset += chunk;
+    }
+
+    return {};
+}
+
+bool ShmChannel::hasData() const {
+    const ShmRingHeader& ring = *inbound.header;
+    return ring.head.load(std::memory_order_acquire) != ring.tail.load(std::memory_order_relaxed);
+}
+
+std::expected<void, SocketError> ShmChannel::receive(std::byte* dest, size_t size) {
+    ShmRingHeader& ring = *inbound.header;
+    const uint64_t capacity = inbound.capacity;
+    size_t offset = 0;
+    auto deadline = receive_timeout.count() > 0
+        ? std::chrono::steady_clock::now() + receive_timeout
+        : std::chrono::steady_clock::time_point::max();
+
+    while (offset < size) {
+        uint64_t tail = ring.tail.load(std::memory_order_relaxed);  // 只有本端推进 tail
+        uint64_t available = ring.head.load(std::memory_order_acquire) - tail;
+        if (available > capacity) {
+            return std::unexpected(SocketError::RECV_FAILED);  // 索引被破坏
+        }
+        if (available == 0) {
+            auto waited = waitFor(ring.data_seq, ring.reader_sleeping, [&] {
+                return ring.head.load() != ring.tail.load(std::memory_order_relaxed);
+            }, deadline);
+            if (!waited.has_value()) {
+                return std::unexpected(waited.error());
+            }
+            continue;
+        }
+
+        size_t chunk = std::min<uint64_t>(available, size - offset);
+        size_t pos = tail & (capacity - 1);
+        size_t first = std::min<size_t>(chunk, capacity - pos);
+        std::memcpy(dest + offset, inbound.data + pos, first);
+        std::memcpy(dest + offset + first, inbound.data, chunk - first);
+
+        ring.tail.store(tail + chunk);
+        notify(ring.space_seq, ring.writer_sleeping);
+        offset += chunk;
+    }
+
+    return {};
+}
+
+// ========== 文件描述符传递 ==========
+
+std::expected<void, SocketError> sendFileDescriptor(int socket_fd, int fd) {
+    char byte = 0;
+    iovec iov{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+
+    if (sendmsg(socket_fd, &msg, MSG_NOSIGNAL) != 1) {
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+    return {};
+}
+
+std::expected<int, SocketError> receiveFileDescriptor(int socket_fd) {
+    char byte = 0;
+    iovec iov{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int) * 4)] = {};
+
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+
+    ssize_t received = recvmsg(socket_fd, &msg, MSG_CMSG_CLOEXEC);
+    if (received < 0) {
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    if (received == 0) {
+        return std::unexpected(SocketError::CONNECTION_CLOSED);
+    }
+
+    // 只接受第一个描述符，多余的全部关闭
+    int result = -1;
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+        size_t count = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+        for (size_t i = 0; i < count; ++i) {
+            int fd;
+            std::memcpy(&fd, CMSG_DATA(cmsg) + i * sizeof(int), sizeof(int));
+            if (result == -1) {
+                result = fd;
+            } else {
+                close(fd);
+            }
+        }
+    }
+
+    if (result == -1) {
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    return result;
+}
+
+} // namespace NET
@@ -1,5 +1,8 @@
 #include "../../include/network/socket_client.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <poll.h>
 
 namespace NET {
 
@@ -42,12 +45,109 @@ std::expected<void, SocketError> SocketClient::connect(const std::string& ip, ui
     return {};
 }
 
+std::expected<void, SocketError> SocketClient::connectUnix(const std::string& path) {
+    if (connected) {
+        return {}; // 已经连接
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return std::unexpected(SocketError::INVALID_ADDRESS);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    socket_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (socket_fd < 0) {
+        socket_fd = -1;
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    if (::connect(socket_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(socket_fd);
+        socket_fd = -1;
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+
+    connected = true;
+    return {};
+}
+
+std::expected<void, SocketError> SocketClient::enableSharedMemory(size_t ring_capacity) {
+    if (!connected) {
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+    if (shm_channel) {
+        return {}; // 已经升级
+    }
+
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getsockname(socket_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) < 0 ||
+        addr.ss_family != AF_UNIX) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+
+    auto channel = ShmChannel::create(socket_fd, ring_capacity);
+    if (!channel.has_value()) {
+        return std::unexpected(channel.error());
+    }
+
+    // 握手中途失败时套接字上的数据已不同步，直接断开
+    ShmAttachRequest request(channel.value()->getRingCapacity());
+    auto sent = sendMessage(request);
+    if (sent.has_value()) {
+        sent = sendFileDescriptor(socket_fd, channel.value()->getMemfd());
+    }
+    if (!sent.has_value()) {
+        disconnect();
+        return std::unexpected(sent.error());
+    }
+
+    // 响应仍经由套接字返回
+    auto response = receiveMessage();
+    if (!response.has_value()) {
+        disconnect();
+        return std::unexpected(response.error());
+    }
+    auto* attach = dynamic_cast<ShmAttachResponse*>(response.value().get());
+    if (attach == nullptr) {
+        disconnect();
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    if (!attach->isAccepted()) {
+        return std::unexpected(SocketError::UNSUPPORTED);
+    }
+
+    shm_channel = std::move(channel.value());
+    return {};
+}
+
+std::expected<void, SocketError> SocketClient::setTimeout(std::chrono::milliseconds timeout) {
+    if (!connected) {
+        return std::unexpected(SocketError::SEND_FAILED);
+    }
+
+    auto seconds = std::chrono::duration_cast<std::chrono::seconds>(timeout);
+    timeval tv{};
+    tv.tv_sec = static_cast<time_t>(seconds.count());
+    tv.tv_usec = static_cast<suseconds_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(timeout - seconds).count());
+    if (setsockopt(socket_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv)) < 0 ||
+        setsockopt(socket_fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv)) < 0) {
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+    return {};
+}
+
 void SocketClient::disconnect() {
+    stopKeepalive();
     if (!connected) {
         return;
     }
 
     connected = false;
+    shm_channel.reset();
     if (socket_fd != -1) {
         close(socket_fd);
         socket_fd = -1;
@@ -60,10 +160,26 @@ std::expected<void, SocketError> SocketClient::sendMessage(const Message& messag
     }
 
     auto serialized = message.serialize();
+    std::lock_guard<std::mutex> lock(send_mutex);
     return sendBytes(serialized);
 }
 
 std::expected<std::unique_ptr<Message>, SocketError> SocketClient::receiveMessage() {
+    auto frame = receiveFrame();
+    if (!frame.has_value()) {
+        return std::unexpected(frame.error());
+    }
+
+    // 反序列化完整消息
+    auto message = Message::deserialize(frame.value());
+    if (!message.has_value()) {
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    
+    return std::move(message.value());
+}
+
+std::expected<std::vector<std::byte>, SocketError> SocketClient::receiveFrame() {
     if (!connected) {
         return std::unexpected(SocketError::RECV_FAILED);
     }
@@ -93,18 +209,174 @@ std::expected<std::unique_ptr<Message>, SocketError> SocketClient::receiveMessag
         }
         full_message.insert(full_message.end(), payload_bytes.value().begin(), payload_bytes.value().end());
     }
+    return full_message;
+}
 
-    // 反序列化完整消息
-    auto message = Message::deserialize(full_message);
-    if (!message.has_value()) {
+std::expected<std::unique_ptr<Message>, SocketError> SocketClient::request(const Message& message) {
+    auto frame = requestFrame(message);
+    if (!frame.has_value()) {
+        return std::unexpected(frame.error());
+    }
+    auto response = Message::deserialize(frame.value());
+    if (!response.has_value()) {
         return std::unexpected(SocketError::RECV_FAILED);
     }
-    
-    return std::move(message.value());
+    return std::move(response.value());
+}
+
+std::expected<std::vector<std::byte>, SocketError> SocketClient::requestFrame(const Message& message) {
+    std::lock_guard<std::mutex> lock(io_mutex);
+    auto send_result = sendMessage(message);
+    if (!send_result.has_value()) {
+        return std::unexpected(send_result.error());
+    }
+    // 跳过超时 PING 晚到的 PONG
+    while (true) {
+        auto frame = receiveFrame();
+        if (!frame.has_value()) {
+            return frame;
+        }
+        Deserializer deserializer(frame.value());
+        auto header = MessageHeader::deserialize(deserializer);
+        if (!header.has_value()) {
+            return std::unexpected(SocketError::RECV_FAILED);
+        }
+        if (header->getType() != MessageType::PONG_RESPONSE ||
+            message.getType() == MessageType::PING_REQUEST) {
+            last_activity_ns = std::chrono::steady_clock::now().time_since_epoch().count();
+            return frame;
+        }
+    }
+}
+
+std::expected<void, SocketError> SocketClient::ping(std::chrono::milliseconds timeout) {
+    std::lock_guard<std::mutex> lock(io_mutex);
+    auto result = [&]() -> std::expected<void, SocketError> {
+        auto start = std::chrono::steady_clock::now();
+        uint64_t sent_at = currentTimestampMicros();
+        auto send_result = sendMessage(PingRequest(sent_at));
+        if (!send_result.has_value()) {
+            return std::unexpected(send_result.error());
+        }
+
+        // 之前超时的 PING 的响应可能晚到，跳过时间戳不匹配的 PONG
+        PongResponse* pong = nullptr;
+        std::unique_ptr<Message> response;
+        while (pong == nullptr) {
+            // 共享内存通道自行检测对端断开，这里只对套接字设置超时
+            if (!shm_channel) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    start + timeout - std::chrono::steady_clock::now());
+                pollfd pfd{socket_fd, POLLIN, 0};
+                int ready = poll(&pfd, 1, static_cast<int>(std::max<int64_t>(0, remaining.count())));
+                if (ready == 0) {
+                    return std::unexpected(SocketError::TIMEOUT);
+                }
+                if (ready < 0) {
+                    return std::unexpected(SocketError::RECV_FAILED);
+                }
+            }
+
+            auto received = receiveMessage();
+            if (!received.has_value()) {
+                return std::unexpected(received.error());
+            }
+            response = std::move(received.value());
+            pong = dynamic_cast<PongResponse*>(response.get());
+            if (pong == nullptr) {
+                return std::unexpected(SocketError::UNSUPPORTED);
+            }
+            if (pong->getOriginalTimestamp() != sent_at) {
+                pong = nullptr;
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        double rtt = std::chrono::duration<double, std::micro>(now - start).count();
+        // 假设去程与回程耗时相同，服务端时间戳对应本地 sent_at + rtt / 2
+        double offset = static_cast<double>(pong->getServerTimestamp()) -
+                        (static_cast<double>(sent_at) + rtt / 2);
+        last_activity_ns = now.time_since_epoch().count();
+
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        if (ping_stats.samples == 0 || rtt < ping_stats.min_rtt_us) {
+            ping_stats.min_rtt_us = rtt;
+            ping_stats.clock_offset_us = offset;
+        }
+        ping_stats.max_rtt_us = std::max(ping_stats.max_rtt_us, rtt);
+        ++ping_stats.samples;
+        ping_stats.avg_rtt_us += (rtt - ping_stats.avg_rtt_us) / ping_stats.samples;
+        ping_stats.last_rtt_us = rtt;
+        ping_stats.last_clock_offset_us = offset;
+        return {};
+    }();
+
+    if (!result.has_value()) {
+        std::lock_guard<std::mutex> stats_lock(stats_mutex);
+        ++ping_stats.failures;
+    }
+    return result;
+}
+
+void SocketClient::startKeepalive(std::chrono::milliseconds interval, int max_failures) {
+    stopKeepalive();
+    if (!connected || interval.count() <= 0) {
+        return;
+    }
+
+    keepalive_running = true;
+    last_activity_ns = std::chrono::steady_clock::now().time_since_epoch().count();
+    keepalive_thread = std::thread([this, interval, max_failures] {
+        int failures = 0;
+        std::unique_lock<std::mutex> lock(keepalive_mutex);
+        while (!keepalive_cv.wait_for(lock, interval, [this] { return !keepalive_running; })) {
+            // 最近有过成功的往返，说明连接可用
+            auto idle = std::chrono::steady_clock::now().time_since_epoch() -
+                        std::chrono::steady_clock::duration(last_activity_ns.load());
+            if (idle < interval) {
+                continue;
+            }
+
+            lock.unlock();
+            auto result = ping(interval);
+            lock.lock();
+
+            failures = result.has_value() ? 0 : failures + 1;
+            if (failures >= max_failures) {
+                // 让阻塞中和之后的收发立即失败
+                shutdown(socket_fd, SHUT_RDWR);
+                break;
+            }
+        }
+    });
+}
+
+void SocketClient::stopKeepalive() {
+    {
+        std::lock_guard<std::mutex> lock(keepalive_mutex);
+        keepalive_running = false;
+    }
+    keepalive_cv.notify_all();
+    if (keepalive_thread.joinable()) {
+        keepalive_thread.join();
+    }
+}
+
+PingStats SocketClient::getPingStats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    return ping_stats;
 }
 
 std::expected<std::vector<std::byte>, SocketError> SocketClient::receiveBytes(size_t size) {
     std::vector<std::byte> buffer(size);
+    if (shm_channel) {
+        auto result = shm_channel->receive(buffer.data(), size);
+        if (!result.has_value()) {
+            return std::unexpected(result.error());
+        }
+        return buffer;
+    }
+
     size_t total_received = 0;
 
     while (total_received < size) {
@@ -113,6 +385,9 @@ std::expected<std::vector<std::byte>, SocketError> SocketClient::receiveBytes(si
                                size - total_received, 0);
         
         if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return std::unexpected(SocketError::TIMEOUT);
+            }
             return std::unexpected(SocketError::RECV_FAILED);
         }
         
@@ -127,13 +402,21 @@ std::expected<std::vector<std::byte>, SocketError> SocketClient::receiveBytes(si
 }
 
 std::expected<void, SocketError> SocketClient::sendBytes(const std::vector<std::byte>& data) {
+    if (shm_channel) {
+        return shm_channel->send(data);
+    }
+
     size_t total_sent = 0;
     const char* char_data = reinterpret_cast<const char*>(data.data());
 
     while (total_sent < data.size()) {
-        ssize_t sent = send(socket_fd, char_data + total_sent, data.size() - total_sent, 0);
+        // 对端已断开时返回错误而不是触发 SIGPIPE
+        ssize_t sent = send(socket_fd, char_data + total_sent, data.size() - total_sent, MSG_NOSIGNAL);
         
         if (sent < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return std::unexpected(SocketError::TIMEOUT);
+            }
             return std::unexpected(SocketError::SEND_FAILED);
         }
         
@@ -1,8 +1,36 @@
 #include "../../include/network/socket_server.hpp"
+#include <algorithm>
+#include <cerrno>
 #include <cstring>
+#include <poll.h>
+#include <sys/stat.h>
 
 namespace NET {
 
+namespace {
+
+// 只删除上次异常退出残留的套接字文件：路径不是套接字或仍有服务端在监听时返回 false
+bool removeStaleSocket(const std::string& path, const sockaddr_un& addr) {
+    struct stat st{};
+    if (lstat(path.c_str(), &st) < 0) {
+        return errno == ENOENT;
+    }
+    if (!S_ISSOCK(st.st_mode)) {
+        return false;
+    }
+
+    int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe_fd < 0) {
+        return false;
+    }
+    bool stale = connect(probe_fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) < 0 &&
+                 errno == ECONNREFUSED;
+    close(probe_fd);
+    return stale && unlink(path.c_str()) == 0;
+}
+
+} // namespace
+
 SocketServer::SocketServer() = default;
 
 SocketServer::~SocketServer() {
@@ -10,7 +38,7 @@ SocketServer::~SocketServer() {
 }
 
 std::expected<void, SocketError> SocketServer::start(const std::string& ip, uint16_t port) {
-    if (running) {
+    if (server_fd != -1) {
         return {}; // 已经在运行
     }
 
@@ -43,7 +71,7 @@ std::expected<void, SocketError> SocketServer::start(const std::string& ip, uint
     }
 
     // 监听
-    if (listen(server_fd, 10) < 0) {
+    if (listen(server_fd, listen_backlog) < 0) {
         close(server_fd);
         server_fd = -1;
         return std::unexpected(SocketError::LISTEN_FAILED);
@@ -53,6 +81,46 @@ std::expected<void, SocketError> SocketServer::start(const std::string& ip, uint
     return {};
 }
 
+std::expected<void, SocketError> SocketServer::startUnix(const std::string& path) {
+    if (unix_fd != -1) {
+        return {}; // 已经在运行
+    }
+
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        return std::unexpected(SocketError::INVALID_ADDRESS);
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    if (!removeStaleSocket(path, addr)) {
+        return std::unexpected(SocketError::BIND_FAILED);
+    }
+
+    unix_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (unix_fd < 0) {
+        unix_fd = -1;
+        return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
+    }
+
+    if (bind(unix_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        close(unix_fd);
+        unix_fd = -1;
+        return std::unexpected(SocketError::BIND_FAILED);
+    }
+
+    if (listen(unix_fd, listen_backlog) < 0) {
+        close(unix_fd);
+        unix_fd = -1;
+        unlink(path.c_str());
+        return std::unexpected(SocketError::LISTEN_FAILED);
+    }
+
+    unix_path = path;
+    running = true;
+    return {};
+}
+
 void SocketServer::stop() {
     if (!running) {
         return;
@@ -63,6 +131,12 @@ void SocketServer::stop() {
         close(server_fd);
         server_fd = -1;
     }
+    if (unix_fd != -1) {
+        close(unix_fd);
+        unix_fd = -1;
+        unlink(unix_path.c_str());
+        unix_path.clear();
+    }
 }
 
 std::expected<int, SocketError> SocketServer::acceptClient() {
@@ -70,19 +144,195 @@ std::expected<int, SocketError> SocketServer::acceptClient() {
         return std::unexpected(SocketError::SOCKET_CREATE_FAILED);
     }
 
-    sockaddr_in client_addr{};
-    socklen_t addr_len = sizeof(client_addr);
+    // 只有一个监听套接字时直接阻塞在 accept 上
+    int listen_fd = (unix_fd == -1) ? server_fd : unix_fd;
+    if (server_fd != -1 && unix_fd != -1) {
+        pollfd fds[2] = {{server_fd, POLLIN, 0}, {unix_fd, POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            return std::unexpected(SocketError::ACCEPT_FAILED);
+        }
+        listen_fd = (fds[1].revents & POLLIN) ? unix_fd : server_fd;
+    }
 
-    int client_fd = accept(server_fd, reinterpret_cast<sockaddr*>(&client_addr), &addr_len);
+    int client_fd = accept(listen_fd, nullptr, nullptr);
     if (client_fd < 0) {
         return std::unexpected(SocketError::ACCEPT_FAILED);
     }
 
+    configureClient(client_fd);
     return client_fd;
 }
 
+std::expected<int, SocketError> SocketServer::tryAcceptClient() {
+    pollfd fds[2];
+    nfds_t count = 0;
+    for (int listen_fd : {server_fd, unix_fd}) {
+        if (listen_fd != -1) {
+            fds[count++] = {listen_fd, POLLIN, 0};
+        }
+    }
+    if (poll(fds, count, 0) < 0) {
+        return std::unexpected(SocketError::ACCEPT_FAILED);
+    }
+
+    for (nfds_t i = 0; i < count; ++i) {
+        if (!(fds[i].revents & POLLIN)) {
+            continue;
+        }
+        // 连接可能在 poll 之后被对端放弃，非阻塞地 accept 避免卡住
+        int client_fd = accept4(fds[i].fd, nullptr, nullptr, SOCK_NONBLOCK);
+        if (client_fd < 0) {
+            continue;
+        }
+        int flags = fcntl(client_fd, F_GETFL);
+        fcntl(client_fd, F_SETFL, flags & ~O_NONBLOCK);
+        configureClient(client_fd);
+        return client_fd;
+    }
+    return std::unexpected(SocketError::TIMEOUT);
+}
+
+std::vector<int> SocketServer::listeningSockets() const {
+    std::vector<int> result;
+    for (int listen_fd : {server_fd, unix_fd}) {
+        if (listen_fd != -1) {
+            result.push_back(listen_fd);
+        }
+    }
+    return result;
+}
+
+void SocketServer::rejectClient(int client_fd, const Message& message) {
+    sendMessage(client_fd, message);
+    shutdown(client_fd, SHUT_WR);
+
+    // 排队的连接通常已发来登录请求，读掉已到达的数据再关闭；不等待后续数据
+    std::byte discard[4096];
+    while (recv(client_fd, discard, sizeof(discard), MSG_DONTWAIT) > 0) {
+    }
+    disconnectClient(client_fd);
+}
+
+void SocketServer::configureClient(int client_fd) {
+    if (idle_timeout.count() > 0) {
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(idle_timeout);
+        timeval tv{};
+        tv.tv_sec = static_cast<time_t>(seconds.count());
+        tv.tv_usec = static_cast<suseconds_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(idle_timeout - seconds).count());
+        setsockopt(client_fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    }
+}
+
+std::expected<PeerCredentials, SocketError> SocketServer::getPeerCredentials(int client_fd) const {
+    sockaddr_storage addr{};
+    socklen_t addr_len = sizeof(addr);
+    if (getsockname(client_fd, reinterpret_cast<sockaddr*>(&addr), &addr_len) < 0 ||
+        addr.ss_family != AF_UNIX) {
+        return std::unexpected(SocketError::INVALID_ADDRESS);
+    }
+
+    ucred cred{};
+    socklen_t cred_len = sizeof(cred);
+    if (getsockopt(client_fd, SOL_SOCKET, SO_PEERCRED, &cred, &cred_len) < 0) {
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+
+    return PeerCredentials{cred.pid, cred.uid, cred.gid};
+}
+
+std::expected<bool, SocketError> SocketServer::acceptSharedMemory(int client_fd, bool allowed) {
+    auto channel = attachSharedMemory(client_fd, allowed);
+    if (!channel.has_value()) {
+        return std::unexpected(channel.error());
+    }
+    if (!channel.value()) {
+        return false;
+    }
+    shm_channels[client_fd] = std::move(channel.value());
+    return true;
+}
+
+std::expected<std::unique_ptr<ShmChannel>, SocketError>
+SocketServer::attachSharedMemory(int client_fd, bool allowed) {
+    // TCP 连接无法传递描述符，客户端不会发送 memfd
+    if (!getPeerCredentials(client_fd).has_value()) {
+        ShmAttachResponse response(false, "Shared memory requires a unix socket connection");
+        auto sent = sendMessage(client_fd, response);
+        if (!sent.has_value()) {
+            return std::unexpected(sent.error());
+        }
+        return nullptr;
+    }
+
+    auto memfd = receiveFileDescriptor(client_fd);
+    if (!memfd.has_value()) {
+        return std::unexpected(memfd.error());
+    }
+
+    if (!allowed) {
+        close(memfd.value());
+        ShmAttachResponse response(false, "Shared memory transport is disabled");
+        auto sent = sendMessage(client_fd, response);
+        if (!sent.has_value()) {
+            return std::unexpected(sent.error());
+        }
+        return nullptr;
+    }
+
+    auto channel = ShmChannel::attach(client_fd, memfd.value());
+    if (!channel.has_value()) {
+        ShmAttachResponse response(false, "Invalid shared memory segment");
+        auto sent = sendMessage(client_fd, response);
+        if (!sent.has_value()) {
+            return std::unexpected(sent.error());
+        }
+        return nullptr;
+    }
+
+    channel.value()->setReceiveTimeout(idle_timeout);
+
+    // 先经套接字确认，再切换，之后的收发全部走共享内存
+    ShmAttachResponse response(true, "");
+    auto sent = sendMessage(client_fd, response);
+    if (!sent.has_value()) {
+        return std::unexpected(sent.error());
+    }
+    return std::move(channel.value());
+}
+
 std::expected<std::unique_ptr<Message>, SocketError> SocketServer::receiveMessage(int client_fd) {
     // 先接收消息头
+    auto header_result = receiveHeader(client_fd);
+    if (!header_result.has_value()) {
+        return std::unexpected(header_result.error());
+    }
+
+    // 接收载荷数据
+    auto frame = receiveFrame(client_fd, header_result.value());
+    if (!frame.has_value()) {
+        return std::unexpected(frame.error());
+    }
+
+    // 反序列化完整消息
+    auto message = Message::deserialize(frame.value());
+    if (!message.has_value()) {
+        return std::unexpected(SocketError::RECV_FAILED);
+    }
+    
+    return std::move(message.value());
+}
+
+bool SocketServer::hasPendingInput(int client_fd) const {
+    if (auto it = shm_channels.find(client_fd); it != shm_channels.end() && it->second->hasData()) {
+        return true;
+    }
+    // 共享内存连接的套接字上不再有数据，可读即表示对端已关闭
+    pollfd pfd{client_fd, POLLIN | POLLRDHUP, 0};
+    return poll(&pfd, 1, 0) > 0 && pfd.revents != 0;
+}
+
+std::expected<MessageHeader, SocketError> SocketServer::receiveHeader(int client_fd) {
     auto header_bytes = receiveBytes(client_fd, MessageHeader::HEADER_SIZE);
     if (!header_bytes.has_value()) {
         return std::unexpected(header_bytes.error());
@@ -95,26 +345,28 @@ std::expected<std::unique_ptr<Message>, SocketError> SocketServer::receiveMessag
         return std::unexpected(SocketError::RECV_FAILED);
     }
 
-    MessageHeader header = header_result.value();
+    return header_result.value();
+}
+
+std::expected<std::vector<std::byte>, SocketError>
+SocketServer::receiveFrame(int client_fd, const MessageHeader& header) {
     uint32_t payload_size = header.getPayloadSize();
 
-    // 接收载荷数据
-    std::vector<std::byte> full_message = std::move(header_bytes.value());
+    // 重建头部字节，载荷直接接收到同一缓冲区，避免额外拷贝
+    Serializer header_serializer(MessageHeader::HEADER_SIZE);
+    header.serialize(header_serializer);
+
+    std::vector<std::byte> frame(MessageHeader::HEADER_SIZE + payload_size);
+    std::copy(header_serializer.getBuffer().begin(), header_serializer.getBuffer().end(), frame.begin());
+
     if (payload_size > 0) {
-        auto payload_bytes = receiveBytes(client_fd, payload_size);
-        if (!payload_bytes.has_value()) {
-            return std::unexpected(payload_bytes.error());
+        auto result = receiveInto(client_fd, frame.data() + MessageHeader::HEADER_SIZE, payload_size);
+        if (!result.has_value()) {
+            return std::unexpected(result.error());
         }
-        full_message.insert(full_message.end(), payload_bytes.value().begin(), payload_bytes.value().end());
     }
 
-    // 反序列化完整消息
-    auto message = Message::deserialize(full_message);
-    if (!message.has_value()) {
-        return std::unexpected(SocketError::RECV_FAILED);
-    }
-    
-    return std::move(message.value());
+    return frame;
 }
 
 std::expected<void, SocketError> SocketServer::sendMessage(int client_fd, const Message& message) {
@@ -122,7 +374,12 @@ std::expected<void, SocketError> SocketServer::sendMessage(int client_fd, const
     return sendBytes(client_fd, serialized);
 }
 
+std::expected<void, SocketError> SocketServer::sendFrame(int client_fd, std::span<const std::byte> frame) {
+    return sendBytes(client_fd, frame);
+}
+
 void SocketServer::disconnectClient(int client_fd) {
+    shm_channels.erase(client_fd);
     if (client_fd >= 0) {
         close(client_fd);
     }
@@ -130,14 +387,29 @@ void SocketServer::disconnectClient(int client_fd) {
 
 std::expected<std::vector<std::byte>, SocketError> SocketServer::receiveBytes(int fd, size_t size) {
     std::vector<std::byte> buffer(size);
+    auto result = receiveInto(fd, buffer.data(), size);
+    if (!result.has_value()) {
+        return std::unexpected(result.error());
+    }
+    return buffer;
+}
+
+std::expected<void, SocketError> SocketServer::receiveInto(int fd, std::byte* dest, size_t size) {
+    if (auto it = shm_channels.find(fd); it != shm_channels.end()) {
+        return it->second->receive(dest, size);
+    }
+
     size_t total_received = 0;
 
     while (total_received < size) {
         ssize_t received = recv(fd, 
-                               reinterpret_cast<char*>(buffer.data()) + total_received, 
+                               reinterpret_cast<char*>(dest) + total_received, 
                                size - total_received, 0);
         
         if (received < 0) {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return std::unexpected(SocketError::TIMEOUT);
+            }
             return std::unexpected(SocketError::RECV_FAILED);
         }
         
@@ -148,15 +420,20 @@ std::expected<std::vector<std::byte>, SocketError> SocketServer::receiveBytes(in
         total_received += received;
     }
 
-    return buffer;
+    return {};
 }
 
-std::expected<void, SocketError> SocketServer::sendBytes(int fd, const std::vector<std::byte>& data) {
+std::expected<void, SocketError> SocketServer::sendBytes(int fd, std::span<const std::byte> data) {
+    if (auto it = shm_channels.find(fd); it != shm_channels.end()) {
+        return it->second->send(data);
+    }
+
     size_t total_sent = 0;
     const char* char_data = reinterpret_cast<const char*>(data.data());
 
     while (total_sent < data.size()) {
-        ssize_t sent = send(fd, char_data + total_sent, data.size() - total_sent, 0);
+        // 客户端已断开时返回错误而不是让整个服务器被 SIGPIPE 终止
+        ssize_t sent = send(fd, char_data + total_sent, data.size() - total_sent, MSG_NOSIGNAL);
         
         if (sent < 0) {
             return std::unexpected(SocketError::SEND_FAILED);
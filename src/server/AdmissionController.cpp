@@ -0,0 +1,97 @@
+#include "../../include/server/AdmissionController.hpp"
+
+#include <algorithm>
+
+AdmissionController::AdmissionController(const AdmissionConfig &config)
+    : config_(config) {}
+
+bool AdmissionController::admitConnection() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (counters_.activeConnections >= config_.maxConnections) {
+    ++counters_.rejectedConnections;
+    return false;
+  }
+  ++counters_.activeConnections;
+  ++counters_.admittedConnections;
+  counters_.peakConnections =
+      std::max(counters_.peakConnections, counters_.activeConnections);
+  return true;
+}
+
+void AdmissionController::connectionClosed() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (counters_.activeConnections > 0) {
+    --counters_.activeConnections;
+  }
+}
+
+bool AdmissionController::enqueueRequest() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (counters_.queuedRequests >= config_.maxQueuedRequests) {
+    ++counters_.rejectedQueueFull;
+    return false;
+  }
+  ++counters_.queuedRequests;
+  counters_.peakQueuedRequests =
+      std::max(counters_.peakQueuedRequests, counters_.queuedRequests);
+  return true;
+}
+
+bool AdmissionController::admitRequest(Clock::time_point arrivedAt,
+                                       Clock::time_point now) {
+  requestWait_.record(elapsedNanos(arrivedAt, now));
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (counters_.queuedRequests > 0) {
+    --counters_.queuedRequests;
+  }
+  if (config_.queueTimeout.count() > 0 &&
+      now - arrivedAt >= config_.queueTimeout) {
+    ++counters_.expiredRequests;
+    return false;
+  }
+  return true;
+}
+
+std::optional<std::string>
+AdmissionController::checkEstimate(const QueryEstimate &estimate) {
+  std::optional<std::string> reason;
+  if (config_.maxResultRows > 0 && estimate.rows > config_.maxResultRows) {
+    reason = "query would return " + std::to_string(estimate.rows) +
+             " rows, limit is " + std::to_string(config_.maxResultRows);
+  } else if (config_.maxQueryBytes > 0 &&
+             estimate.bytes > config_.maxQueryBytes) {
+    reason = "query would materialize about " +
+             std::to_string(estimate.bytes) + " bytes, limit is " +
+             std::to_string(config_.maxQueryBytes);
+  }
+  if (reason) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++counters_.rejectedByEstimate;
+  }
+  return reason;
+}
+
+void AdmissionController::recordBudgetAbort() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ++counters_.abortedOverBudget;
+}
+
+AdmissionStats AdmissionController::stats() const {
+  AdmissionStats result;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    result = counters_;
+  }
+  result.requestWait = requestWait_.summary();
+  return result;
+}
+
+uint64_t AdmissionController::elapsedNanos(Clock::time_point since,
+                                           Clock::time_point now) {
+  if (now <= since) {
+    return 0;
+  }
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(now - since)
+          .count());
+}
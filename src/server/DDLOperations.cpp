@@ -59,13 +59,12 @@ public:
                   << std::endl;
         return false;
       }
+      // 删除数据库时清空该数据库的表在内存中的数据，其他数据库不受影响
       if (core_impl_->currentDbName == dbName) {
         core_impl_->currentDbName.clear();
+        core_impl_->tables.clear();
       }
-      // 在删除数据库时，清空该数据库下所有表的内存数据
-      // 注意：这里需要确保删除的是当前数据库下的表
-      // 对于当前设计，直接清空内存中的所有表，因为删除一个数据库意味着它包含的所有表都将失效
-      core_impl_->tables.clear();
+      core_impl_->inactiveDatabases.erase(dbName);
 
       std::filesystem::remove_all(dbPath);
       return true;
@@ -84,14 +83,28 @@ public:
     std::filesystem::path dbPath =
         std::filesystem::path(core_impl_->rootPath) / dbName;
     if (std::filesystem::is_directory(dbPath)) {
+      // 已经是当前数据库：内存中的表就是最新的，不从磁盘重新加载
+      if (core_impl_->currentDbName == dbName) {
+        return true;
+      }
+      // 当前数据库的表整体换出保留在内存中；之前加载过的数据库直接换入
+      if (!core_impl_->currentDbName.empty()) {
+        core_impl_->inactiveDatabases[core_impl_->currentDbName] =
+            std::move(core_impl_->tables);
+      }
+      core_impl_->tables.clear();
       core_impl_->currentDbName = dbName;
-      // 切换数据库时，加载该数据库下的所有表到内存
-      core_impl_->tables.clear(); // 清空旧的表数据
+      if (auto it = core_impl_->inactiveDatabases.find(dbName);
+          it != core_impl_->inactiveDatabases.end()) {
+        core_impl_->tables = std::move(it->second);
+        core_impl_->inactiveDatabases.erase(it);
+        return true;
+      }
+      // 第一次使用该数据库时，加载它的所有表到内存
       for (const auto &entry : std::filesystem::directory_iterator(dbPath)) {
         if (entry.is_regular_file() && entry.path().extension() == ".meta") {
           std::string tableName = entry.path().stem().string();
-          TableData tableData;
-          tableData.name = tableName;
+          TableData &tableData = core_impl_->addTable(tableName);
 
           // 加载元数据
           std::ifstream metaFile(entry.path());
@@ -116,15 +129,13 @@ public:
             while (std::getline(dataFile, line)) {
               std::stringstream ss(line);
               std::string cell;
-              Row row;
+              Row &row = tableData.rows.emplace_back(); // 直接在表的内存资源中构造
               while (std::getline(ss, cell, ',')) {
-                row.push_back(cell);
+                row.emplace_back(cell);
               }
-              tableData.rows.push_back(row);
             }
             dataFile.close();
           }
-          core_impl_->tables[tableName] = tableData;
         }
       }
       std::cout << "Using database '" << dbName << "'. Loaded "
@@ -217,11 +228,9 @@ public:
       }
 
       // 在内存中创建 TableData 对象
-      TableData newTable;
-      newTable.name = tableName;
+      TableData &newTable = core_impl_->addTable(tableName);
       newTable.columns = columns; // 复制列定义
       // rows 将为空，等待 DML 操作插入
-      core_impl_->tables[tableName] = newTable;
 
       std::cout << "Table '" << tableName << "' created and loaded into memory."
                 << std::endl;
@@ -2,7 +2,10 @@
 // 该文件实现了DMLOperations类的具体逻辑，并增强了条件评估功能
 
 #include "../../include/server/DatabaseAPI.hpp" // 包含数据库API头文件
+#include "../../include/server/RowFilter.hpp"
+#include "../../include/server/TaskScheduler.hpp"
 #include <algorithm> // 用于 std::remove_if, std::sort
+#include <atomic>
 #include <charconv> // 用于 std::from_chars (C++17特性，用于数字转换)
 #include <fstream>  // 用于 std::ofstream 和 std::ifstream
 #include <iostream>
@@ -11,6 +14,7 @@
 #include <sstream>   // 用于 std::stringstream
 #include <stdexcept> // 用于标准异常类
 #include <string>
+#include <string_view> // 用于在 std::string 和 pmr 字符串之间比较
 #include <vector>
 
 // DatabaseCoreImpl 现在在 DatabaseAPI.hpp 中定义。不需要在这里重复定义。
@@ -20,17 +24,35 @@
 
 namespace DMLHelpers { // 使用命名空间 DMLHelpers 避免全局命名冲突
 
-// Helper to remove leading/trailing whitespace
-std::string trim(const std::string &str) {
-  size_t first = str.find_first_not_of(" \t\n\r");
-  if (std::string::npos == first) {
-    return str;
+// 扫描和排序每处理这么多行（次比较）检查一次语句是否被取消或超时
+constexpr size_t INTERRUPT_CHECK_ROWS = 1024;
+
+// 行数达到 PARALLEL_MIN_ROWS 的扫描和排序拆分成任务并行执行，每个任务至少处理
+// PARALLEL_CHUNK_ROWS 行，更小的任务调度开销超过收益
+constexpr size_t PARALLEL_MIN_ROWS = 32768;
+constexpr size_t PARALLEL_CHUNK_ROWS = 8192;
+
+// UPDATE 的撤销记录：被替换下来的旧值
+struct UndoEntry {
+  size_t row;
+  int column;
+  std::pmr::string oldValue;
+};
+
+// 将一行拼接为逗号分隔的字符串（用于事务日志）
+std::string joinRow(const Row &row) {
+  std::string result;
+  bool firstCol = true;
+  for (const auto &val : row) {
+    if (!firstCol)
+      result += ",";
+    result += val;
+    firstCol = false;
   }
-  size_t last = str.find_last_not_of(" \t\n\r");
-  return str.substr(first, (last - first + 1));
+  return result;
 }
 
-template <typename T> bool convertToType(const std::string &s, T &value) {
+template <typename T> bool convertToType(std::string_view s, T &value) {
   if constexpr (std::is_same_v<T, int>) {
     // 使用 std::from_chars 更安全地进行数字转换
     auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
@@ -40,7 +62,7 @@ template <typename T> bool convertToType(const std::string &s, T &value) {
     return ec == std::errc();
   } else if constexpr (std::is_same_v<T, bool>) {
     // 支持 "1", "0", "true", "false", 不区分大小写
-    std::string lower_s = s;
+    std::string lower_s(s);
     std::transform(lower_s.begin(), lower_s.end(), lower_s.begin(), ::tolower);
     if (lower_s == "1" || lower_s == "true") {
       value = true;
@@ -57,226 +79,159 @@ template <typename T> bool convertToType(const std::string &s, T &value) {
   return false; // 未知类型
 }
 
-// 前向声明 evaluateCondition，因为 evaluateSingleComparison
-// 可能在未来通过递归调用 或者为了结构清晰，先声明它
-bool evaluateCondition(const Row &row, const TableData &tableMetadata,
-                       const std::string &condition);
-
-/**
- * @brief 评估单个比较条件 (e.g., "column_name = 'value'", "age > 30")
- * @param row 当前行数据
- * @param tableMetadata 表的元数据
- * @param condition 单个比较条件字符串
- * @return 如果条件匹配则返回 true，否则返回 false
- */
-bool evaluateSingleComparison(const Row &row, const TableData &tableMetadata,
-                              const std::string &condition) {
-  std::string trimmedCondition = trim(condition);
-  if (trimmedCondition.empty()) {
-    return true; // 空条件视为真，尽管通常不会出现
-  }
-
-  // 查找操作符及其位置，按照优先级或长度排序以便正确匹配
-  std::vector<std::pair<std::string, std::string>> operators = {
-      {">=", ">="}, {"<=", "<="}, {"!=", "!="},
-      {"=", "="},   {">", ">"},   {"<", "<"}};
-
-  size_t opPos = std::string::npos;
-  std::string op;
-
-  for (const auto &op_pair : operators) {
-    size_t currentOpPos = trimmedCondition.find(op_pair.first);
-    if (currentOpPos != std::string::npos) {
-      // 找到操作符，确保不是部分匹配（例如 '=' 不应匹配 '!='）
-      // 这是一个简单的启发式，更严谨的需要正则或词法分析
-      // 确保找到的操作符不是更大操作符的一部分
-      bool is_part_of_larger_op = false;
-      if (op_pair.first == "=") {
-        if (currentOpPos > 0 && (trimmedCondition[currentOpPos - 1] == '>' ||
-                                 trimmedCondition[currentOpPos - 1] == '<' ||
-                                 trimmedCondition[currentOpPos - 1] == '!')) {
-          is_part_of_larger_op = true;
-        }
+// ORDER BY 的单列比较：INT/DOUBLE 按数值，其他类型按字符串
+struct RowLess {
+  int column;
+  DataType type;
+
+  bool operator()(const Row &a, const Row &b) const {
+    // 确保行有足够的元素
+    if (column >= a.size() || column >= b.size()) {
+      // 这不应该发生，但为了安全考虑，可以定义一个稳定顺序或抛出异常
+      return false;
+    }
+    // 根据列类型进行比较
+    if (type == DataType::INT) {
+      int val_a, val_b;
+      if (convertToType(a[column], val_a) && convertToType(b[column], val_b)) {
+        return val_a < val_b;
       }
-      // 对于双字符操作符，确保它不是意外地匹配了单字符部分
-      // 修正：确保不会将单个字符的操作符误认为是双字符操作符的一部分
-      // 比如对于 "A=B"，op_pair.first 是 "="，currentOpPos 是等号的位置
-      // trimmedCondition.substr(currentOpPos, 2) 会是 "=B"
-      // trimmedCondition.substr(currentOpPos - 1, 3) 会是 "A=B"
-      // 这样写有点复杂且容易出错，更简单的办法是按长度从大到小匹配操作符
-      // 当前的 operator
-      // 向量已经按长度从大到小排列，所以先找到的双字符操作符会优先匹配
-
-      if (is_part_of_larger_op) {
-        continue;
+      return false; // 转换失败
+    } else if (type == DataType::DOUBLE) {
+      double val_a, val_b;
+      if (convertToType(a[column], val_a) && convertToType(b[column], val_b)) {
+        return val_a < val_b;
       }
-
-      opPos = currentOpPos;
-      op = op_pair.second;
-      break; // 找到最左边的操作符后停止
+      return false; // conversion failed
+    } else { // 默认为字符串比较 (DataType::STRING 或 BOOL)
+      return a[column] < b[column];
     }
   }
+};
 
-  if (opPos == std::string::npos) {
-    std::cerr << "Warning: 无法解析单个比较条件 '" << trimmedCondition
-              << "': 未找到有效操作符。" << std::endl;
-    return false;
+/**
+ * @brief 返回处理 rows 行时可以使用的调度器，应串行执行时返回 nullptr。
+ */
+TaskScheduler *parallelScheduler(const DatabaseCoreImpl &core, size_t rows) {
+  if (!core.scheduler || core.scheduler->threadCount() < 2 ||
+      rows < PARALLEL_MIN_ROWS) {
+    return nullptr;
   }
+  return core.scheduler;
+}
 
-  std::string colName = trim(trimmedCondition.substr(0, opPos));
-  std::string valueStr = trim(trimmedCondition.substr(opPos + op.length()));
-
-  // 如果是字符串字面量，去除单引号
-  if (valueStr.length() >= 2 && valueStr.front() == '\'' &&
-      valueStr.back() == '\'') {
-    valueStr = valueStr.substr(1, valueStr.length() - 2);
+/**
+ * @brief 并行扫描：按连续的行区间拆分成任务，各自把匹配的行拷贝到自己的分段，
+ * 最后按区间顺序拼接，结果与串行扫描的顺序相同。
+ * 任一任务抛出（取消、超时、超出行数上限）时其余任务尽快停止，异常在这里重新抛出。
+ */
+void parallelFilter(TaskScheduler &scheduler, const DatabaseCoreImpl &core,
+                    const TableData &table, const RowFilter &filter,
+                    std::pmr::vector<Row> &resultSet) {
+  const size_t rowCount = table.rows.size();
+  const size_t chunkCount =
+      (rowCount + PARALLEL_CHUNK_ROWS - 1) / PARALLEL_CHUNK_ROWS;
+  std::vector<std::pmr::vector<Row>> chunks;
+  chunks.reserve(chunkCount);
+  for (size_t c = 0; c < chunkCount; ++c) {
+    chunks.emplace_back(resultSet.get_allocator());
   }
 
-  int colIndex = tableMetadata.getColumnIndex(colName);
-  if (colIndex == -1) {
-    // 列不存在
-    // std::cerr << "Warning: 比较条件中引用的列 '" << colName << "' 不存在。"
-    // << std::endl;
-    return false; // 如果列不存在，条件不匹配
+  std::atomic<uint64_t> matched{0};
+  TaskGroup group(scheduler);
+  for (size_t c = 0; c < chunkCount; ++c) {
+    group.run([&, c] {
+      const size_t begin = c * PARALLEL_CHUNK_ROWS;
+      const size_t end = std::min(begin + PARALLEL_CHUNK_ROWS, rowCount);
+      for (size_t i = begin; i < end; ++i) {
+        if ((i - begin) % INTERRUPT_CHECK_ROWS == 0) {
+          if (group.isCancelled()) {
+            return;
+          }
+          core.checkInterrupt();
+        }
+        const Row &row = table.rows[i];
+        if (filter.matches(row)) {
+          if (core.queryRowLimit > 0 &&
+              matched.fetch_add(1, std::memory_order_relaxed) >=
+                  core.queryRowLimit) {
+            throw ResultLimitExceeded(
+                "result exceeds the limit of " +
+                std::to_string(core.queryRowLimit) + " rows");
+          }
+          chunks[c].push_back(row);
+        }
+      }
+    });
   }
+  group.wait();
 
-  // 确保行数据有效，防止越界访问
-  if (colIndex >= row.size()) {
-    std::cerr << "Error: 行数据中列索引越界。" << std::endl;
-    return false;
+  size_t total = 0;
+  for (const auto &chunk : chunks) {
+    total += chunk.size();
   }
-
-  const std::string &rowValueStr = row[colIndex];
-  DataType colType = tableMetadata.getColumnType(colIndex);
-
-  // 根据数据类型和操作符进行比较
-  try {
-    if (colType == DataType::INT) {
-      int rowVal, targetVal;
-      if (convertToType(rowValueStr, rowVal) &&
-          convertToType(valueStr, targetVal)) {
-        if (op == "=")
-          return rowVal == targetVal;
-        if (op == "!=")
-          return rowVal != targetVal;
-        if (op == ">")
-          return rowVal > targetVal;
-        if (op == "<")
-          return rowVal < targetVal;
-        if (op == ">=")
-          return rowVal >= targetVal;
-        if (op == "<=")
-          return rowVal <= targetVal;
-      }
-    } else if (colType == DataType::DOUBLE) {
-      double rowVal, targetVal;
-      if (convertToType(rowValueStr, rowVal) &&
-          convertToType(valueStr, targetVal)) {
-        if (op == "=")
-          return rowVal == targetVal;
-        if (op == "!=")
-          return rowVal != targetVal;
-        if (op == ">")
-          return rowVal > targetVal;
-        if (op == "<")
-          return rowVal < targetVal;
-        if (op == ">=")
-          return rowVal >= targetVal;
-        if (op == "<=")
-          return rowVal <= targetVal;
-      }
-    } else if (colType == DataType::BOOL) {
-      bool rowVal, targetVal;
-      if (convertToType(rowValueStr, rowVal) &&
-          convertToType(valueStr, targetVal)) {
-        if (op == "=")
-          return rowVal == targetVal;
-        if (op == "!=")
-          return rowVal != targetVal;
-        // 对于布尔类型，通常只支持等式和非等式
-        std::cerr << "Warning: 布尔类型不支持 '>','<','>=','<=' 比较符。"
-                  << std::endl;
-      }
-    } else { // DataType::STRING
-      // 字符串的字典序比较
-      if (op == "=")
-        return rowValueStr == valueStr;
-      if (op == "!=")
-        return rowValueStr != valueStr;
-      if (op == ">")
-        return rowValueStr > valueStr;
-      if (op == "<")
-        return rowValueStr < valueStr;
-      if (op == ">=")
-        return rowValueStr >= valueStr;
-      if (op == "<=")
-        return rowValueStr <= valueStr;
-    }
-  } catch (const std::invalid_argument &e) {
-    std::cerr << "条件评估中类型转换错误: " << e.what() << " (row_value: '"
-              << rowValueStr << "', target_value: '" << valueStr << "')"
-              << std::endl;
-    return false;
-  } catch (const std::out_of_range &e) {
-    std::cerr << "条件评估中数值超出范围错误: " << e.what() << " (row_value: '"
-              << rowValueStr << "', target_value: '" << valueStr << "')"
-              << std::endl;
-    return false;
+  resultSet.reserve(total);
+  for (auto &chunk : chunks) {
+    std::move(chunk.begin(), chunk.end(), std::back_inserter(resultSet));
   }
-
-  return false; // 默认不匹配或遇到无法处理的情况
 }
 
 /**
- * @brief 评估一个复杂的条件字符串，支持 AND 和 OR 逻辑操作符。
- * 优先级：OR 的优先级低于 AND（即先处理 AND，再处理 OR）。
- * 不支持括号。
- * @param row 当前行数据
- * @param tableMetadata 表的元数据
- * @param condition 完整的条件字符串
- * @return 如果条件匹配则返回 true，否则返回 false
+ * @brief 并行排序：各分段分别排序，再逐轮两两归并；同一轮的归并互不重叠，可以并行。
  */
-bool evaluateCondition(const Row &row, const TableData &tableMetadata,
-                       const std::string &condition) {
-  std::string trimmedCondition = trim(condition);
-  if (trimmedCondition.empty()) {
-    return true; // 空条件，默认匹配
+void parallelSort(TaskScheduler &scheduler, const DatabaseCoreImpl &core,
+                  std::pmr::vector<Row> &rows, const RowLess &less) {
+  // 每个线程约分到 4 段，便于负载不均时相互窃取
+  const size_t segmentRows =
+      std::max(PARALLEL_CHUNK_ROWS,
+               rows.size() / (scheduler.threadCount() * 4) + 1);
+  std::vector<size_t> bounds;
+  for (size_t begin = 0; begin < rows.size(); begin += segmentRows) {
+    bounds.push_back(begin);
   }
-
-  // Step 1: Handle OR (lowest precedence)
-  size_t orPos = trimmedCondition.find(" OR ");
-  if (orPos != std::string::npos) {
-    std::string left = trimmedCondition.substr(0, orPos);
-    std::string right =
-        trimmedCondition.substr(orPos + 4); // " OR " has 4 chars
-    return evaluateCondition(row, tableMetadata, left) ||
-           evaluateCondition(row, tableMetadata, right);
+  bounds.push_back(rows.size());
+  const size_t segments = bounds.size() - 1;
+
+  TaskGroup group(scheduler);
+  for (size_t i = 0; i < segments; ++i) {
+    group.run([&, i] {
+      size_t comparisons = 0;
+      std::sort(rows.begin() + bounds[i], rows.begin() + bounds[i + 1],
+                [&](const Row &a, const Row &b) {
+                  if (++comparisons % INTERRUPT_CHECK_ROWS == 0) {
+                    core.checkInterrupt();
+                  }
+                  return less(a, b);
+                });
+    });
   }
-
-  // Step 2: Handle AND
-  size_t andPos = trimmedCondition.find(" AND ");
-  if (andPos != std::string::npos) {
-    std::string left = trimmedCondition.substr(0, andPos);
-    std::string right =
-        trimmedCondition.substr(andPos + 5); // " AND " has 5 chars
-    return evaluateCondition(row, tableMetadata, left) &&
-           evaluateCondition(row, tableMetadata, right);
+  group.wait();
+
+  for (size_t width = 1; width < segments; width *= 2) {
+    for (size_t i = 0; i + width < segments; i += 2 * width) {
+      group.run([&, i, width] {
+        core.checkInterrupt();
+        std::inplace_merge(rows.begin() + bounds[i],
+                           rows.begin() + bounds[i + width],
+                           rows.begin() + bounds[std::min(i + 2 * width, segments)],
+                           less);
+      });
+    }
+    group.wait();
   }
-
-  // Step 3: If no AND/OR, it's a single comparison
-  return evaluateSingleComparison(row, tableMetadata, trimmedCondition);
 }
 
 // QueryResult 的具体实现类，现在在 DMLOperations.cpp 中定义
 // 在 DatabaseAPI.hpp 中，只需要 QueryResult 抽象类的声明
 class InMemoryQueryResult : public QueryResult {
 private:
-  std::vector<Row> rows_;          // 实际的结果数据
+  std::pmr::vector<Row> rows_;     // 实际的结果数据（从查询内存资源分配）
   const TableData *tableMetadata_; // 指向原始表的元数据
   mutable int currentRowIndex_;    // 当前遍历到的行索引
 
 public:
-  InMemoryQueryResult(std::vector<Row> rows, const TableData *tableMetadata)
+  InMemoryQueryResult(std::pmr::vector<Row> rows,
+                      const TableData *tableMetadata)
       : rows_(std::move(rows)), tableMetadata_(tableMetadata),
         currentRowIndex_(-1) {
     if (!tableMetadata_) {
@@ -319,7 +274,7 @@ public:
     if (columnIndex < 0 || columnIndex >= rows_[currentRowIndex_].size()) {
       throw std::out_of_range("当前行数据列索引超出范围。");
     }
-    return rows_[currentRowIndex_][columnIndex];
+    return std::string(rows_[currentRowIndex_][columnIndex]);
   }
 
   int getInt(int columnIndex) const override {
@@ -426,10 +381,15 @@ public:
 
     // 检查主键重复
     if (hasPrimaryKey) {
-      for (const Row &existingRow : table->rows) {
+      for (size_t i = 0; i < table->rows.size(); ++i) {
+        if (i % DMLHelpers::INTERRUPT_CHECK_ROWS == 0) {
+          core_impl_->checkInterrupt();
+        }
+        const Row &existingRow = table->rows[i];
         if (primaryKeyColIndex != -1 &&
             existingRow.size() > primaryKeyColIndex &&
-            existingRow[primaryKeyColIndex] == primaryKeyValue) {
+            std::string_view(existingRow[primaryKeyColIndex]) ==
+                primaryKeyValue) {
           std::cerr << "Error: Duplicate primary key value '" << primaryKeyValue
                     << "' for table '" << tableName << "'." << std::endl;
           return 0; // 主键重复，插入失败
@@ -527,10 +487,15 @@ public:
 
     // 检查主键重复
     if (hasPrimaryKey) {
-      for (const Row &existingRow : table->rows) {
+      for (size_t i = 0; i < table->rows.size(); ++i) {
+        if (i % DMLHelpers::INTERRUPT_CHECK_ROWS == 0) {
+          core_impl_->checkInterrupt();
+        }
+        const Row &existingRow = table->rows[i];
         if (primaryKeyColIndex != -1 &&
             existingRow.size() > primaryKeyColIndex &&
-            existingRow[primaryKeyColIndex] == primaryKeyValue) {
+            std::string_view(existingRow[primaryKeyColIndex]) ==
+                primaryKeyValue) {
           std::cerr << "Error: 主键值 '" << primaryKeyValue << "' 在表 '"
                     << tableName << "' 中重复。" << std::endl;
           return 0; // 主键重复，插入失败
@@ -590,51 +555,70 @@ public:
                                    "' 不存在或未加载到内存。");
     }
 
-    int affectedRows = 0;
-    for (Row &row : table->rows) {
-      if (DMLHelpers::evaluateCondition(row, *table, whereClause)) {
-        // 如果有事务，记录旧行数据到日志
-        std::string oldRowDataString;
-        if (core_impl_->isTransactionActive) {
-          bool firstCol = true;
-          for (const auto &val : row) {
-            if (!firstCol)
-              oldRowDataString += ",";
-            oldRowDataString += val;
-            firstCol = false;
-          }
-        }
+    // 第一遍只找出匹配的行，不做修改，可以随时中止
+    const RowFilter filter(*table, whereClause);
+    std::pmr::vector<size_t> matches(core_impl_->queryResource());
+    core_impl_->rowsScanned += table->rows.size();
+    for (size_t i = 0; i < table->rows.size(); ++i) {
+      if (i % DMLHelpers::INTERRUPT_CHECK_ROWS == 0) {
+        core_impl_->checkInterrupt();
+      }
+      if (filter.matches(table->rows[i])) {
+        matches.push_back(i);
+      }
+    }
 
-        for (const auto &pair : updates) {
-          int colIndex = table->getColumnIndex(pair.first);
-          if (colIndex != -1) {
-            row[colIndex] = pair.second;
-          } else {
-            std::cerr << "Warning: 更新数据时列 '" << pair.first
-                      << "' 不存在于表 '" << tableName << "' 中。" << std::endl;
-          }
+    std::vector<std::pair<int, const std::string *>> assignments;
+    for (const auto &pair : updates) {
+      int colIndex = table->getColumnIndex(pair.first);
+      if (colIndex != -1) {
+        assignments.emplace_back(colIndex, &pair.second);
+      } else {
+        std::cerr << "Warning: 更新数据时列 '" << pair.first
+                  << "' 不存在于表 '" << tableName << "' 中。" << std::endl;
+      }
+    }
+
+    // 第二遍写入新值，旧值换入撤销记录；中途被取消或超出内存上限时全部换回，
+    // 语句不留下部分修改。预留空间保证记录撤销本身不会失败
+    std::vector<DMLHelpers::UndoEntry> undo;
+    undo.reserve(matches.size() * assignments.size());
+    try {
+      for (size_t n = 0; n < matches.size(); ++n) {
+        if (n % DMLHelpers::INTERRUPT_CHECK_ROWS == 0) {
+          core_impl_->checkInterrupt();
         }
-        Row newRow(table->columns.size());
-        
-        // 如果有事务，记录新行数据到日志
-        if (core_impl_->isTransactionActive) {
-          std::ofstream logFile(core_impl_->transactionLogPath, std::ios::app);
-          if (logFile.is_open()) {
-            std::string newRowDataString;
-            bool firstCol = true;
-            for (const auto &val : newRow) {
-              if (!firstCol)
-                newRowDataString += ",";
-              newRowDataString += val;
-              firstCol = false;
-            }
-            // 记录 UPDATE 操作：表名;旧数据;新数据
-            logFile << "UPDATE;" << tableName << ";" << oldRowDataString << ";"
-                    << newRowDataString << std::endl;
-            logFile.close();
+        Row &row = table->rows[matches[n]];
+        for (const auto &[colIndex, value] : assignments) {
+          std::pmr::string newValue(*value, row.get_allocator());
+          std::swap(row[colIndex], newValue);
+          undo.push_back({matches[n], colIndex, std::move(newValue)});
+        }
+      }
+    } catch (...) {
+      for (auto it = undo.rbegin(); it != undo.rend(); ++it) {
+        std::swap(table->rows[it->row][it->column], it->oldValue);
+      }
+      throw;
+    }
+    int affectedRows = static_cast<int>(matches.size());
+
+    // 语句完成后再写事务日志：表名;旧数据;新数据
+    if (core_impl_->isTransactionActive && !matches.empty()) {
+      std::ofstream logFile(core_impl_->transactionLogPath, std::ios::app);
+      if (logFile.is_open()) {
+        size_t next = 0;
+        for (size_t rowIndex : matches) {
+          const Row &row = table->rows[rowIndex];
+          Row oldRow(row);
+          for (; next < undo.size() && undo[next].row == rowIndex; ++next) {
+            oldRow[undo[next].column] = undo[next].oldValue;
           }
+          logFile << "UPDATE;" << tableName << ";"
+                  << DMLHelpers::joinRow(oldRow) << ";"
+                  << DMLHelpers::joinRow(row) << std::endl;
         }
-        affectedRows++;
+        logFile.close();
       }
     }
     std::cout << "DMLOperations::Impl: 更新表 '" << tableName
@@ -665,22 +649,42 @@ public:
                                    "' 不存在或未加载到内存。");
     }
 
-    int initialSize = static_cast<int>(table->rows.size());
-    std::vector<Row> rowsToDelete; // 用于存储要删除的行，以便记录到日志
+    // 第一遍只找出匹配的行，不做修改，可以随时中止
+    const RowFilter filter(*table, whereClause);
+    std::pmr::vector<size_t> matches(core_impl_->queryResource());
+    core_impl_->rowsScanned += table->rows.size();
+    for (size_t i = 0; i < table->rows.size(); ++i) {
+      if (i % DMLHelpers::INTERRUPT_CHECK_ROWS == 0) {
+        core_impl_->checkInterrupt();
+      }
+      if (filter.matches(table->rows[i])) {
+        matches.push_back(i);
+      }
+    }
 
-    // 使用 erase-remove idiom 删除符合条件的行
-    auto newEnd = std::remove_if(
-        table->rows.begin(), table->rows.end(), [&](const Row &row) {
-          if (DMLHelpers::evaluateCondition(row, *table, whereClause)) {
-            if (core_impl_->isTransactionActive) {
-              rowsToDelete.push_back(row); // 记录被删除的行
-            }
-            return true; // 标记为删除
-          }
-          return false;
-        });
-    table->rows.erase(newEnd, table->rows.end());
-    int removedRows = initialSize - static_cast<int>(table->rows.size());
+    // 用于存储要删除的行，以便记录到日志
+    std::pmr::vector<Row> rowsToDelete(core_impl_->queryResource());
+    if (core_impl_->isTransactionActive) {
+      for (size_t rowIndex : matches) {
+        rowsToDelete.push_back(table->rows[rowIndex]);
+      }
+    }
+
+    // 第二遍压缩掉匹配的行：只移动同一内存资源中的行，不会失败也不再检查取消
+    size_t kept = 0;
+    size_t next = 0;
+    for (size_t i = 0; i < table->rows.size(); ++i) {
+      if (next < matches.size() && matches[next] == i) {
+        ++next;
+        continue;
+      }
+      if (kept != i) {
+        table->rows[kept] = std::move(table->rows[i]);
+      }
+      ++kept;
+    }
+    table->rows.erase(table->rows.begin() + kept, table->rows.end());
+    int removedRows = static_cast<int>(matches.size());
 
     // 如果有事务，记录被删除的行到日志
     if (core_impl_->isTransactionActive) {
@@ -737,10 +741,31 @@ public:
                                    "' 不存在或未加载到内存。");
     }
 
-    std::vector<Row> resultSet;
-    for (const Row &row : table->rows) {
-      if (DMLHelpers::evaluateCondition(row, *table, whereClause)) {
-        resultSet.push_back(row);
+    const RowFilter filter(*table, whereClause);
+
+    // 结果集从当前查询的内存资源分配，计入查询和会话的内存用量
+    std::pmr::vector<Row> resultSet(core_impl_->queryResource());
+    core_impl_->rowsScanned += table->rows.size();
+    if (TaskScheduler *scheduler =
+            DMLHelpers::parallelScheduler(*core_impl_, table->rows.size())) {
+      DMLHelpers::parallelFilter(*scheduler, *core_impl_, *table, filter,
+                                 resultSet);
+    } else {
+      for (size_t i = 0; i < table->rows.size(); ++i) {
+        if (i % DMLHelpers::INTERRUPT_CHECK_ROWS == 0) {
+          core_impl_->checkInterrupt();
+        }
+        const Row &row = table->rows[i];
+        if (filter.matches(row)) {
+          // 在拷贝超出上限的那一行之前中止，已拷贝的行随 resultSet 释放
+          if (core_impl_->queryRowLimit > 0 &&
+              resultSet.size() >= core_impl_->queryRowLimit) {
+            throw ResultLimitExceeded(
+                "result exceeds the limit of " +
+                std::to_string(core_impl_->queryRowLimit) + " rows");
+          }
+          resultSet.push_back(row);
+        }
       }
     }
 
@@ -748,34 +773,23 @@ public:
     if (!orderBy.empty()) {
       int orderColIndex = table->getColumnIndex(orderBy);
       if (orderColIndex != -1) {
-        DataType orderColType = table->getColumnType(orderColIndex);
-        std::sort(resultSet.begin(), resultSet.end(),
-                  [&](const Row &a, const Row &b) {
-                    // 确保行有足够的元素
-                    if (orderColIndex >= a.size() ||
-                        orderColIndex >= b.size()) {
-                      // 这不应该发生，但为了安全考虑，可以定义一个稳定顺序或抛出异常
-                      return false;
-                    }
-                    // 根据列类型进行比较
-                    if (orderColType == DataType::INT) {
-                      int val_a, val_b;
-                      if (DMLHelpers::convertToType(a[orderColIndex], val_a) &&
-                          DMLHelpers::convertToType(b[orderColIndex], val_b)) {
-                        return val_a < val_b;
-                      }
-                      return false; // 转换失败
-                    } else if (orderColType == DataType::DOUBLE) {
-                      double val_a, val_b;
-                      if (DMLHelpers::convertToType(a[orderColIndex], val_a) &&
-                          DMLHelpers::convertToType(b[orderColIndex], val_b)) {
-                        return val_a < val_b;
+        DMLHelpers::RowLess less{orderColIndex,
+                                 table->getColumnType(orderColIndex)};
+        if (TaskScheduler *scheduler =
+                DMLHelpers::parallelScheduler(*core_impl_, resultSet.size())) {
+          DMLHelpers::parallelSort(*scheduler, *core_impl_, resultSet, less);
+        } else {
+          // 比较函数中检查取消：抛出后 resultSet 顺序不定，但随即被丢弃
+          size_t comparisons = 0;
+          std::sort(resultSet.begin(), resultSet.end(),
+                    [&](const Row &a, const Row &b) {
+                      if (++comparisons % DMLHelpers::INTERRUPT_CHECK_ROWS ==
+                          0) {
+                        core_impl_->checkInterrupt();
                       }
-                      return false; // conversion failed
-                    } else { // 默认为字符串比较 (DataType::STRING 或 BOOL)
-                      return a[orderColIndex] < b[orderColIndex];
-                    }
-                  });
+                      return less(a, b);
+                    });
+        }
       } else {
         std::cerr << "Warning: OrderBy 列 '" << orderBy
                   << "' 未找到或其类型不支持排序。" << std::endl;
@@ -42,4 +42,71 @@ DDLOperations &Database::getDDLOperations() { return *ddl_ops; }
 
 DMLOperations &Database::getDMLOperations() { return *dml_ops; }
 
-TransactionManager &Database::getTransactionManager() { return *tx_manager; }
\ No newline at end of file
+TransactionManager &Database::getTransactionManager() { return *tx_manager; }
+
+uint64_t Database::getRowsScanned() const {
+  return core_state_pImpl->rowsScanned;
+}
+
+TrackingMemoryResource &Database::getMemoryRoot() {
+  return core_state_pImpl->memoryRoot;
+}
+
+void Database::setTableMemoryLimit(uint64_t limitBytes) {
+  core_state_pImpl->tableMemoryLimit = limitBytes;
+  for (auto &pair : core_state_pImpl->tables) {
+    pair.second.memory->setLimit(limitBytes);
+  }
+}
+
+std::pmr::memory_resource *
+Database::setQueryMemoryResource(std::pmr::memory_resource *resource) {
+  std::pmr::memory_resource *previous = core_state_pImpl->queryMemory;
+  core_state_pImpl->queryMemory = resource;
+  return previous;
+}
+
+QueryInterrupt *Database::setQueryInterrupt(QueryInterrupt *interrupt) {
+  QueryInterrupt *previous = core_state_pImpl->interrupt;
+  core_state_pImpl->interrupt = interrupt;
+  return previous;
+}
+
+std::vector<MemoryUsage> Database::getTableMemoryUsage() const {
+  std::vector<MemoryUsage> result;
+  for (const auto &pair : core_state_pImpl->tables) {
+    result.push_back(pair.second.memory->usage());
+  }
+  return result;
+}
+
+std::optional<TableStatistics>
+Database::getTableStatistics(const std::string &tableName) const {
+  auto it = core_state_pImpl->tables.find(tableName);
+  if (it == core_state_pImpl->tables.end()) {
+    return std::nullopt;
+  }
+  TableStatistics stats;
+  stats.rowCount = it->second.rows.size();
+  stats.bytesInUse = it->second.memory->usage().bytesInUse;
+  return stats;
+}
+
+void Database::setQueryRowLimit(uint64_t maxRows) {
+  core_state_pImpl->queryRowLimit = maxRows;
+}
+
+void Database::setTaskScheduler(TaskScheduler *scheduler) {
+  core_state_pImpl->scheduler = scheduler;
+}
+
+// ========================================================================
+// DatabaseCoreImpl 辅助函数
+// ========================================================================
+
+TableData &DatabaseCoreImpl::addTable(const std::string &tableName) {
+  tables.erase(tableName);
+  auto [it, inserted] = tables.try_emplace(tableName, tableName, &memoryRoot,
+                                           tableMemoryLimit);
+  return it->second;
+}
\ No newline at end of file
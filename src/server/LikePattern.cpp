@@ -0,0 +1,346 @@
+#include "../../include/server/LikePattern.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LIKE_PATTERN_X86 1
+#endif
+
+namespace {
+
+// NFA 的状态用 uint64_t 的各位表示，第 0 位为初始状态
+constexpr size_t MAX_NFA_ELEMENTS = 63;
+
+unsigned char foldAscii(unsigned char c) {
+  return c >= 'A' && c <= 'Z' ? c | 0x20 : c;
+}
+
+bool isContinuationByte(unsigned char c) { return (c & 0xC0) == 0x80; }
+
+// expected 已按 caseInsensitive 转为小写
+bool equalBytes(const char *text, const char *expected, size_t size,
+                bool caseInsensitive) {
+  if (!caseInsensitive) {
+    return std::memcmp(text, expected, size) == 0;
+  }
+  for (size_t i = 0; i < size; ++i) {
+    if (foldAscii(static_cast<unsigned char>(text[i])) !=
+        static_cast<unsigned char>(expected[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// 首尾字节已经相同时比较中间部分
+bool equalInner(const char *candidate, std::string_view needle,
+                bool caseInsensitive) {
+  return needle.size() <= 2 ||
+         equalBytes(candidate + 1, needle.data() + 1, needle.size() - 2,
+                    caseInsensitive);
+}
+
+bool containsScalar(std::string_view text, std::string_view needle,
+                    bool caseInsensitive, size_t from) {
+  for (size_t i = from; i + needle.size() <= text.size(); ++i) {
+    if (equalBytes(text.data() + i, needle.data(), needle.size(),
+                   caseInsensitive)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+#ifdef LIKE_PATTERN_X86
+
+// 字母字节在比较前或上 0x20，使大写字母与小写的 needle 字节相同
+char foldMask(char c, bool caseInsensitive) {
+  return caseInsensitive && c >= 'a' && c <= 'z' ? 0x20 : 0;
+}
+
+bool containsSse2(std::string_view text, std::string_view needle,
+                  bool caseInsensitive) {
+  const size_t last = needle.size() - 1;
+  const __m128i firstByte = _mm_set1_epi8(needle.front());
+  const __m128i lastByte = _mm_set1_epi8(needle.back());
+  const __m128i firstFold = _mm_set1_epi8(foldMask(needle.front(), caseInsensitive));
+  const __m128i lastFold = _mm_set1_epi8(foldMask(needle.back(), caseInsensitive));
+  size_t i = 0;
+  for (; i + last + 16 <= text.size(); i += 16) {
+    const __m128i head = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i));
+    const __m128i tail =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(text.data() + i + last));
+    const __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(head, firstFold), firstByte),
+                                      _mm_cmpeq_epi8(_mm_or_si128(tail, lastFold), lastByte));
+    for (uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(hit)); mask != 0;
+         mask &= mask - 1) {
+      if (equalInner(text.data() + i + __builtin_ctz(mask), needle, caseInsensitive)) {
+        return true;
+      }
+    }
+  }
+  return containsScalar(text, needle, caseInsensitive, i);
+}
+
+__attribute__((target("avx2"))) bool
+containsAvx2(std::string_view text, std::string_view needle, bool caseInsensitive) {
+  const size_t last = needle.size() - 1;
+  const __m256i firstByte = _mm256_set1_epi8(needle.front());
+  const __m256i lastByte = _mm256_set1_epi8(needle.back());
+  const __m256i firstFold = _mm256_set1_epi8(foldMask(needle.front(), caseInsensitive));
+  const __m256i lastFold = _mm256_set1_epi8(foldMask(needle.back(), caseInsensitive));
+  size_t i = 0;
+  for (; i + last + 32 <= text.size(); i += 32) {
+    const __m256i head =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + i));
+    const __m256i tail =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i *>(text.data() + i + last));
+    const __m256i hit =
+        _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_or_si256(head, firstFold), firstByte),
+                         _mm256_cmpeq_epi8(_mm256_or_si256(tail, lastFold), lastByte));
+    for (uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(hit)); mask != 0;
+         mask &= mask - 1) {
+      if (equalInner(text.data() + i + __builtin_ctz(mask), needle, caseInsensitive)) {
+        return true;
+      }
+    }
+  }
+  // 剩余不足 32 个位置时交给 SSE2 版本
+  return i + needle.size() <= text.size() &&
+         containsSse2(text.substr(i), needle, caseInsensitive);
+}
+
+bool hasAvx2() {
+  static const bool supported = [] {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+  }();
+  return supported;
+}
+
+#endif
+
+bool containsBytes(std::string_view text, std::string_view needle,
+                   bool caseInsensitive) {
+  if (needle.size() > text.size()) {
+    return false;
+  }
+#ifdef LIKE_PATTERN_X86
+  return hasAvx2() ? containsAvx2(text, needle, caseInsensitive)
+                 : containsSse2(text, needle, caseInsensitive);
+#else
+  if (!caseInsensitive) {
+    return text.find(needle) != std::string_view::npos;
+  }
+  return containsScalar(text, needle, caseInsensitive, 0);
+#endif
+}
+
+// 文本中 position 处一个 UTF-8 字符的字节数；position 落在字符中间时返回 0
+size_t characterLength(std::string_view text, size_t position) {
+  unsigned char lead = static_cast<unsigned char>(text[position]);
+  if (isContinuationByte(lead)) {
+    return 0;
+  }
+  size_t length = 1;
+  while (position + length < text.size() &&
+         isContinuationByte(static_cast<unsigned char>(text[position + length]))) {
+    ++length;
+  }
+  return length;
+}
+
+} // namespace
+
+LikePattern::LikePattern(std::string_view pattern, bool caseInsensitive)
+    : caseInsensitive_(caseInsensitive) {
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    char c = pattern[i];
+    if (c == '%') {
+      if (elements_.empty() ||
+          elements_.back().kind != Element::Kind::ANY_SEQUENCE) {
+        elements_.push_back({Element::Kind::ANY_SEQUENCE});
+      }
+      continue;
+    }
+    if (c == '_') {
+      elements_.push_back({Element::Kind::ANY_CHAR});
+      continue;
+    }
+    // 末尾单独的反斜杠按字面值处理
+    if (c == '\\' && i + 1 < pattern.size()) {
+      c = pattern[++i];
+    }
+    if (caseInsensitive_) {
+      c = static_cast<char>(foldAscii(static_cast<unsigned char>(c)));
+    }
+    elements_.push_back({Element::Kind::LITERAL, c});
+  }
+
+  // 按 % 切分出各段字面值；含 _ 的模式只能用 NFA
+  std::vector<std::string> segments(1);
+  size_t wildcards = 0;
+  for (const auto &element : elements_) {
+    if (element.kind == Element::Kind::ANY_CHAR) {
+      compileNfa();
+      return;
+    }
+    if (element.kind == Element::Kind::ANY_SEQUENCE) {
+      ++wildcards;
+      segments.emplace_back();
+    } else {
+      segments.back() += element.byte;
+    }
+  }
+  const bool leading = !elements_.empty() &&
+                       elements_.front().kind == Element::Kind::ANY_SEQUENCE;
+  const bool trailing = !elements_.empty() &&
+                        elements_.back().kind == Element::Kind::ANY_SEQUENCE;
+  if (wildcards == 0) {
+    strategy_ = Strategy::EXACT;
+    prefix_ = std::move(segments.front());
+  } else if (wildcards == 1 && elements_.size() == 1) {
+    strategy_ = Strategy::ANY;
+  } else if (wildcards == 1 && trailing) {
+    strategy_ = Strategy::PREFIX;
+    prefix_ = std::move(segments.front());
+  } else if (wildcards == 1 && leading) {
+    strategy_ = Strategy::SUFFIX;
+    suffix_ = std::move(segments.back());
+  } else if (wildcards == 1) {
+    strategy_ = Strategy::PREFIX_SUFFIX;
+    prefix_ = std::move(segments.front());
+    suffix_ = std::move(segments.back());
+  } else if (wildcards == 2 && leading && trailing) {
+    strategy_ = Strategy::CONTAINS;
+    prefix_ = std::move(segments[1]);
+  } else {
+    compileNfa();
+  }
+}
+
+void LikePattern::compileNfa() {
+  strategy_ = Strategy::NFA;
+  size_t states = 0; // 已加入的非 % 元素数
+  for (const auto &element : elements_) {
+    if (element.kind == Element::Kind::ANY_SEQUENCE) {
+      continue;
+    }
+    if (++states > MAX_NFA_ELEMENTS) {
+      useNfa_ = false;
+      return;
+    }
+  }
+  useNfa_ = true;
+
+  size_t state = 0;
+  for (const auto &element : elements_) {
+    if (element.kind == Element::Kind::ANY_SEQUENCE) {
+      loops_ |= uint64_t{1} << state;
+      continue;
+    }
+    const uint64_t bit = uint64_t{1} << ++state;
+    if (element.kind == Element::Kind::ANY_CHAR) {
+      // _ 在字符的首字节上前进，后续字节由 anyChars_ 保持
+      anyChars_ |= bit;
+      for (size_t c = 0; c < accepts_.size(); ++c) {
+        if (!isContinuationByte(static_cast<unsigned char>(c))) {
+          accepts_[c] |= bit;
+        }
+      }
+      continue;
+    }
+    const unsigned char byte = static_cast<unsigned char>(element.byte);
+    accepts_[byte] |= bit;
+    if (caseInsensitive_ && byte >= 'a' && byte <= 'z') {
+      accepts_[byte & ~0x20] |= bit;
+    }
+  }
+  accepting_ = uint64_t{1} << state;
+}
+
+bool LikePattern::matches(std::string_view text) const {
+  switch (strategy_) {
+  case Strategy::EXACT:
+    return text.size() == prefix_.size() &&
+           equalBytes(text.data(), prefix_.data(), prefix_.size(),
+                      caseInsensitive_);
+  case Strategy::PREFIX:
+    return text.size() >= prefix_.size() &&
+           equalBytes(text.data(), prefix_.data(), prefix_.size(),
+                      caseInsensitive_);
+  case Strategy::SUFFIX:
+    return text.size() >= suffix_.size() &&
+           equalBytes(text.data() + text.size() - suffix_.size(),
+                      suffix_.data(), suffix_.size(), caseInsensitive_);
+  case Strategy::PREFIX_SUFFIX:
+    return text.size() >= prefix_.size() + suffix_.size() &&
+           equalBytes(text.data(), prefix_.data(), prefix_.size(),
+                      caseInsensitive_) &&
+           equalBytes(text.data() + text.size() - suffix_.size(),
+                      suffix_.data(), suffix_.size(), caseInsensitive_);
+  case Strategy::CONTAINS:
+    return containsBytes(text, prefix_, caseInsensitive_);
+  case Strategy::ANY:
+    return true;
+  case Strategy::NFA:
+    break;
+  }
+  return useNfa_ ? matchNfa(text) : matchBacktracking(text);
+}
+
+bool LikePattern::matchNfa(std::string_view text) const {
+  uint64_t active = 1;
+  for (char ch : text) {
+    const unsigned char c = static_cast<unsigned char>(ch);
+    uint64_t next = ((active << 1) & accepts_[c]) | (active & loops_);
+    if (isContinuationByte(c)) {
+      next |= active & anyChars_;
+    }
+    active = next;
+    if (active == 0) {
+      return false;
+    }
+  }
+  return (active & accepting_) != 0;
+}
+
+// 经典的通配符匹配：记住最近一个 % 的位置，失配时让它多吞一个字节再重试
+bool LikePattern::matchBacktracking(std::string_view text) const {
+  size_t t = 0;
+  size_t p = 0;
+  size_t retryElement = std::string_view::npos;
+  size_t retryText = 0;
+  while (t < text.size()) {
+    if (p < elements_.size()) {
+      const Element &element = elements_[p];
+      if (element.kind == Element::Kind::ANY_SEQUENCE) {
+        retryElement = ++p;
+        retryText = t;
+        continue;
+      }
+      if (element.kind == Element::Kind::ANY_CHAR) {
+        if (size_t length = characterLength(text, t); length != 0) {
+          t += length;
+          ++p;
+          continue;
+        }
+      } else if (equalBytes(text.data() + t, &element.byte, 1, caseInsensitive_)) {
+        ++t;
+        ++p;
+        continue;
+      }
+    }
+    if (retryElement == std::string_view::npos) {
+      return false;
+    }
+    p = retryElement;
+    t = ++retryText;
+  }
+  while (p < elements_.size() &&
+         elements_[p].kind == Element::Kind::ANY_SEQUENCE) {
+    ++p;
+  }
+  return p == elements_.size();
+}
@@ -0,0 +1,69 @@
+#include "../../include/server/MemoryTracker.hpp"
+
+TrackingMemoryResource::TrackingMemoryResource(
+    std::string name, TrackingMemoryResource *parent, uint64_t limitBytes,
+    std::pmr::memory_resource *upstream)
+    : name_(std::move(name)), parent_(parent), upstream_(upstream),
+      limitBytes_(limitBytes) {}
+
+MemoryUsage TrackingMemoryResource::usage() const {
+  MemoryUsage result;
+  result.name = name_;
+  result.bytesInUse = bytesInUse();
+  result.peakBytes = peakBytes();
+  result.allocations = allocations_.load(std::memory_order_relaxed);
+  result.limitBytes = limit();
+  return result;
+}
+
+void *TrackingMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+  charge(bytes);
+  try {
+    return upstream_->allocate(bytes, alignment);
+  } catch (...) {
+    release(bytes);
+    throw;
+  }
+}
+
+void TrackingMemoryResource::do_deallocate(void *p, size_t bytes,
+                                           size_t alignment) {
+  upstream_->deallocate(p, bytes, alignment);
+  release(bytes);
+}
+
+void TrackingMemoryResource::charge(size_t bytes) {
+  for (TrackingMemoryResource *node = this; node; node = node->parent_) {
+    uint64_t now =
+        node->bytesInUse_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    uint64_t limit = node->limit();
+    if (limit != 0 && now > limit) {
+      // 回滚已经计入的节点（包括当前超限的节点）
+      for (TrackingMemoryResource *undo = this; undo != node->parent_;
+           undo = undo->parent_) {
+        undo->bytesInUse_.fetch_sub(bytes, std::memory_order_relaxed);
+      }
+      throw MemoryLimitExceeded("Memory limit exceeded for '" + node->name_ +
+                                "': requested " + std::to_string(bytes) +
+                                " bytes with " + std::to_string(now - bytes) +
+                                " of " + std::to_string(limit) +
+                                " bytes in use");
+    }
+  }
+
+  // 全部节点都未超限后再更新峰值和分配次数
+  for (TrackingMemoryResource *node = this; node; node = node->parent_) {
+    uint64_t now = node->bytesInUse();
+    uint64_t peak = node->peakBytes_.load(std::memory_order_relaxed);
+    while (now > peak && !node->peakBytes_.compare_exchange_weak(
+                             peak, now, std::memory_order_relaxed)) {
+    }
+    node->allocations_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void TrackingMemoryResource::release(size_t bytes) {
+  for (TrackingMemoryResource *node = this; node; node = node->parent_) {
+    node->bytesInUse_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+}
@@ -0,0 +1,36 @@
+#include "../../include/server/QueryInterrupt.hpp"
+
+namespace {
+
+const char *reasonMessage(QueryCancelled::Reason reason) {
+  switch (reason) {
+  case QueryCancelled::Reason::STATEMENT_TIMEOUT:
+    return "statement timeout exceeded";
+  case QueryCancelled::Reason::USER_REQUEST:
+  default:
+    return "canceled by user request";
+  }
+}
+
+} // namespace
+
+QueryCancelled::QueryCancelled(Reason reason)
+    : std::runtime_error(reasonMessage(reason)), reason_(reason) {}
+
+void QueryInterrupt::start(std::chrono::milliseconds timeout) {
+  cancelled_.store(false, std::memory_order_relaxed);
+  deadline_ = timeout.count() > 0 ? Clock::now() + timeout
+                                   : Clock::time_point::max();
+}
+
+void QueryInterrupt::check() {
+  if (isCancelled()) {
+    throw QueryCancelled(QueryCancelled::Reason::USER_REQUEST);
+  }
+  if (deadline_ == Clock::time_point::max()) {
+    return; // 不限时，省去读时钟
+  }
+  if (Clock::now() >= deadline_) {
+    throw QueryCancelled(QueryCancelled::Reason::STATEMENT_TIMEOUT);
+  }
+}
@@ -0,0 +1,588 @@
+#include "../../include/server/RowFilter.hpp"
+#include "../../include/server/LikePattern.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <type_traits>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// IN 列表不少于这么多个值时改用哈希集合，更短的列表顺序比较更快
+constexpr size_t IN_HASH_MIN_VALUES = 8;
+
+using Node = RowFilter::Node;
+using NodePtr = std::unique_ptr<Node>;
+
+// ---------- 词法分析 ----------
+
+struct ConditionToken {
+  enum class Kind { WORD, STRING, OPERATOR, PAREN_OPEN, PAREN_CLOSE, COMMA, END };
+  Kind kind;
+  std::string text; // STRING 为去掉引号、还原转义后的内容
+};
+
+[[noreturn]] void syntaxError(const std::string &condition,
+                              const std::string &detail) {
+  throw SyntaxException("WHERE 条件语法错误 (" + detail + "): " + condition);
+}
+
+bool isWordChar(char c) {
+  return !std::isspace(static_cast<unsigned char>(c)) && c != '(' &&
+         c != ')' && c != ',' && c != '\'' && c != '=' && c != '<' &&
+         c != '>' && c != '!';
+}
+
+std::vector<ConditionToken> tokenize(const std::string &condition) {
+  using Kind = ConditionToken::Kind;
+  std::vector<ConditionToken> tokens;
+  size_t pos = 0;
+  while (pos < condition.size()) {
+    char c = condition[pos];
+    if (std::isspace(static_cast<unsigned char>(c))) {
+      ++pos;
+    } else if (c == '(' || c == ')' || c == ',') {
+      tokens.push_back({c == '(' ? Kind::PAREN_OPEN
+                        : c == ')' ? Kind::PAREN_CLOSE
+                                   : Kind::COMMA,
+                        std::string(1, c)});
+      ++pos;
+    } else if (c == '\'') {
+      std::string text;
+      ++pos;
+      while (true) {
+        if (pos >= condition.size()) {
+          syntaxError(condition, "未闭合的字符串");
+        }
+        if (condition[pos] == '\'') {
+          if (pos + 1 < condition.size() && condition[pos + 1] == '\'') {
+            text += '\'';
+            pos += 2;
+            continue;
+          }
+          ++pos;
+          break;
+        }
+        text += condition[pos++];
+      }
+      tokens.push_back({Kind::STRING, std::move(text)});
+    } else if (c == '=' || c == '<' || c == '>' || c == '!') {
+      std::string op(1, c);
+      char next = pos + 1 < condition.size() ? condition[pos + 1] : '\0';
+      if (next == '=' && c != '=') {
+        op += next;
+      } else if (c == '<' && next == '>') {
+        op += next;
+      } else if (c == '!') {
+        syntaxError(condition, "无效的操作符 '!'");
+      }
+      pos += op.size();
+      tokens.push_back({Kind::OPERATOR, op == "<>" ? "!=" : op});
+    } else {
+      size_t start = pos;
+      while (pos < condition.size() && isWordChar(condition[pos])) {
+        ++pos;
+      }
+      tokens.push_back({Kind::WORD, condition.substr(start, pos - start)});
+    }
+  }
+  tokens.push_back({Kind::END, ""});
+  return tokens;
+}
+
+bool isKeyword(const ConditionToken &token, std::string_view keyword) {
+  return token.kind == ConditionToken::Kind::WORD &&
+         token.text.size() == keyword.size() &&
+         std::equal(token.text.begin(), token.text.end(), keyword.begin(),
+                    [](char a, char b) {
+                      return std::toupper(static_cast<unsigned char>(a)) == b;
+                    });
+}
+
+// ---------- 类型化的值 ----------
+
+// 比较时的值类型：INT 为 int64_t，DOUBLE 为 double，BOOL 为 bool，STRING 为 string_view
+// 字面量保存为 Stored<T>（字符串需要自己持有内容）
+template <typename T> struct StoredType { using type = T; };
+template <> struct StoredType<std::string_view> { using type = std::string; };
+template <typename T> using Stored = typename StoredType<T>::type;
+
+bool parseValue(std::string_view s, int64_t &value) {
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return ec == std::errc();
+}
+
+bool parseValue(std::string_view s, double &value) {
+  auto [ptr, ec] = std::from_chars(s.data(), s.data() + s.size(), value);
+  return ec == std::errc();
+}
+
+// 支持 "1", "0", "true", "false"，不区分大小写
+bool parseValue(std::string_view s, bool &value) {
+  std::string lower(s);
+  std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+  if (lower == "1" || lower == "true") {
+    value = true;
+    return true;
+  }
+  if (lower == "0" || lower == "false") {
+    value = false;
+    return true;
+  }
+  return false;
+}
+
+bool parseValue(std::string_view s, std::string_view &value) {
+  value = s;
+  return true;
+}
+
+bool parseValue(std::string_view s, std::string &value) {
+  value = s;
+  return true;
+}
+
+// 读取并转换行中的一列，转换失败时该行不匹配
+template <typename T> bool readColumn(const Row &row, int column, T &value) {
+  return static_cast<size_t>(column) < row.size() &&
+         parseValue(std::string_view(row[column]), value);
+}
+
+struct StringHash {
+  using is_transparent = void;
+  size_t operator()(std::string_view s) const {
+    return std::hash<std::string_view>{}(s);
+  }
+};
+
+template <typename T>
+using HashSet =
+    std::conditional_t<std::is_same_v<T, std::string_view>,
+                       std::unordered_set<std::string, StringHash, std::equal_to<>>,
+                       std::unordered_set<T>>;
+
+// ---------- 条件树的节点 ----------
+
+class ConstantNode : public Node {
+public:
+  explicit ConstantNode(bool value) : value_(value) {}
+  bool matches(const Row &) const override { return value_; }
+
+private:
+  bool value_;
+};
+
+class AndNode : public Node {
+public:
+  explicit AndNode(std::vector<NodePtr> children)
+      : children_(std::move(children)) {}
+  bool matches(const Row &row) const override {
+    for (const auto &child : children_) {
+      if (!child->matches(row)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  std::vector<NodePtr> children_;
+};
+
+class OrNode : public Node {
+public:
+  explicit OrNode(std::vector<NodePtr> children)
+      : children_(std::move(children)) {}
+  bool matches(const Row &row) const override {
+    for (const auto &child : children_) {
+      if (child->matches(row)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  std::vector<NodePtr> children_;
+};
+
+class NotNode : public Node {
+public:
+  explicit NotNode(NodePtr child) : child_(std::move(child)) {}
+  bool matches(const Row &row) const override { return !child_->matches(row); }
+
+private:
+  NodePtr child_;
+};
+
+template <typename T, typename Compare> class ComparisonNode : public Node {
+public:
+  ComparisonNode(int column, Stored<T> target)
+      : column_(column), target_(std::move(target)) {}
+  bool matches(const Row &row) const override {
+    T value;
+    return readColumn(row, column_, value) && Compare{}(value, target_);
+  }
+
+private:
+  int column_;
+  Stored<T> target_;
+};
+
+// 短的 IN 列表：顺序比较
+template <typename T> class InListNode : public Node {
+public:
+  InListNode(int column, std::vector<Stored<T>> values)
+      : column_(column), values_(std::move(values)) {}
+  bool matches(const Row &row) const override {
+    T value;
+    if (!readColumn(row, column_, value)) {
+      return false;
+    }
+    for (const auto &candidate : values_) {
+      if (value == candidate) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private:
+  int column_;
+  std::vector<Stored<T>> values_;
+};
+
+// 长的 IN 列表：编译时构建哈希集合，每行一次查找
+template <typename T> class InSetNode : public Node {
+public:
+  InSetNode(int column, std::vector<Stored<T>> values)
+      : column_(column), values_(std::make_move_iterator(values.begin()),
+                                 std::make_move_iterator(values.end())) {}
+  bool matches(const Row &row) const override {
+    T value;
+    return readColumn(row, column_, value) &&
+           values_.find(value) != values_.end();
+  }
+
+private:
+  int column_;
+  HashSet<T> values_;
+};
+
+template <typename T> class RangeNode : public Node {
+public:
+  RangeNode(int column, Stored<T> low, Stored<T> high)
+      : column_(column), low_(std::move(low)), high_(std::move(high)) {}
+  bool matches(const Row &row) const override {
+    T value;
+    if (!readColumn(row, column_, value)) {
+      return false;
+    }
+    if constexpr (std::is_same_v<T, int64_t>) {
+      // 无符号减法把 low <= value <= high 合成一次比较（构造时保证 low <= high）
+      return static_cast<uint64_t>(value) - static_cast<uint64_t>(low_) <=
+             static_cast<uint64_t>(high_) - static_cast<uint64_t>(low_);
+    } else {
+      return !(value < low_) && !(high_ < value);
+    }
+  }
+
+private:
+  int column_;
+  Stored<T> low_;
+  Stored<T> high_;
+};
+
+// LIKE / ILIKE 直接匹配列中保存的文本，不按列类型转换
+class LikeNode : public Node {
+public:
+  LikeNode(int column, LikePattern pattern)
+      : column_(column), pattern_(std::move(pattern)) {}
+  bool matches(const Row &row) const override {
+    return static_cast<size_t>(column_) < row.size() &&
+           pattern_.matches(std::string_view(row[column_]));
+  }
+
+private:
+  int column_;
+  LikePattern pattern_;
+};
+
+// ---------- 语法分析 ----------
+
+// 解析得到、尚未按列类型转换的谓词
+struct Predicate {
+  enum class Kind { COMPARE, IN_LIST, BETWEEN, LIKE };
+  Kind kind;
+  std::string column;
+  std::string op;                  // COMPARE 的操作符，LIKE 为 "LIKE" 或 "ILIKE"
+  std::vector<std::string> values; // COMPARE 和 LIKE 一个，IN 若干，BETWEEN 为下界和上界
+};
+
+template <typename T>
+NodePtr makeComparison(int column, const std::string &op, Stored<T> target) {
+  if (op == "=")
+    return std::make_unique<ComparisonNode<T, std::equal_to<>>>(column, std::move(target));
+  if (op == "!=")
+    return std::make_unique<ComparisonNode<T, std::not_equal_to<>>>(column, std::move(target));
+  if (op == "<")
+    return std::make_unique<ComparisonNode<T, std::less<>>>(column, std::move(target));
+  if (op == "<=")
+    return std::make_unique<ComparisonNode<T, std::less_equal<>>>(column, std::move(target));
+  if (op == ">")
+    return std::make_unique<ComparisonNode<T, std::greater<>>>(column, std::move(target));
+  return std::make_unique<ComparisonNode<T, std::greater_equal<>>>(column, std::move(target));
+}
+
+// 按列的值类型 T 构建谓词节点；字面量无法转换为 T 的比较不匹配任何行
+template <typename T> NodePtr buildPredicate(int column, const Predicate &p) {
+  constexpr bool ordered = !std::is_same_v<T, bool>;
+  switch (p.kind) {
+  case Predicate::Kind::COMPARE: {
+    Stored<T> target;
+    if (!parseValue(p.values[0], target)) {
+      return std::make_unique<ConstantNode>(false);
+    }
+    if (!ordered && p.op != "=" && p.op != "!=") {
+      std::cerr << "Warning: 布尔类型不支持 '>','<','>=','<=' 比较符。"
+                << std::endl;
+      return std::make_unique<ConstantNode>(false);
+    }
+    return makeComparison<T>(column, p.op, std::move(target));
+  }
+  case Predicate::Kind::IN_LIST: {
+    std::vector<Stored<T>> values;
+    values.reserve(p.values.size());
+    for (const auto &text : p.values) {
+      Stored<T> value;
+      if (parseValue(text, value)) {
+        values.push_back(std::move(value));
+      }
+    }
+    if (values.empty()) {
+      return std::make_unique<ConstantNode>(false);
+    }
+    if (values.size() >= IN_HASH_MIN_VALUES) {
+      return std::make_unique<InSetNode<T>>(column, std::move(values));
+    }
+    return std::make_unique<InListNode<T>>(column, std::move(values));
+  }
+  case Predicate::Kind::BETWEEN: {
+    Stored<T> low, high;
+    if (!parseValue(p.values[0], low) || !parseValue(p.values[1], high)) {
+      return std::make_unique<ConstantNode>(false);
+    }
+    if constexpr (!ordered) {
+      std::cerr << "Warning: 布尔类型不支持 BETWEEN。" << std::endl;
+      return std::make_unique<ConstantNode>(false);
+    } else {
+      if (high < low) {
+        return std::make_unique<ConstantNode>(false);
+      }
+      return std::make_unique<RangeNode<T>>(column, std::move(low),
+                                            std::move(high));
+    }
+  }
+  case Predicate::Kind::LIKE:
+    break; // 与列类型无关，由调用方构造 LikeNode
+  }
+  return std::make_unique<ConstantNode>(false);
+}
+
+class ConditionParser {
+public:
+  ConditionParser(const TableData &table, const std::string &condition)
+      : table_(table), condition_(condition), tokens_(tokenize(condition)) {}
+
+  NodePtr parse() {
+    NodePtr root = parseOr();
+    if (peek().kind != ConditionToken::Kind::END) {
+      syntaxError(condition_, "多余的 '" + peek().text + "'");
+    }
+    return root;
+  }
+
+private:
+  using Kind = ConditionToken::Kind;
+
+  const ConditionToken &peek() const { return tokens_[position_]; }
+  const ConditionToken &next() {
+    const ConditionToken &token = tokens_[position_];
+    if (token.kind != Kind::END) {
+      ++position_;
+    }
+    return token;
+  }
+  void expect(Kind kind, const char *what) {
+    if (peek().kind != kind) {
+      syntaxError(condition_, std::string("缺少 ") + what);
+    }
+    next();
+  }
+
+  NodePtr parseOr() {
+    std::vector<NodePtr> children;
+    children.push_back(parseAnd());
+    while (isKeyword(peek(), "OR")) {
+      next();
+      children.push_back(parseAnd());
+    }
+    if (children.size() == 1) {
+      return std::move(children.front());
+    }
+    return std::make_unique<OrNode>(std::move(children));
+  }
+
+  NodePtr parseAnd() {
+    std::vector<NodePtr> children;
+    children.push_back(parseNot());
+    while (isKeyword(peek(), "AND")) {
+      next();
+      children.push_back(parseNot());
+    }
+    if (children.size() == 1) {
+      return std::move(children.front());
+    }
+    return std::make_unique<AndNode>(std::move(children));
+  }
+
+  // not := NOT not | '(' or ')' | predicate；与客户端一致，只有 NOT 和括号计入嵌套层数
+  NodePtr parseNot() {
+    if (!isKeyword(peek(), "NOT") && peek().kind != Kind::PAREN_OPEN) {
+      return parsePredicate();
+    }
+    if (++depth_ > MAX_DEPTH) {
+      syntaxError(condition_, "嵌套层数过多");
+    }
+    NodePtr node;
+    if (isKeyword(peek(), "NOT")) {
+      next();
+      node = std::make_unique<NotNode>(parseNot());
+    } else if (peek().kind == Kind::PAREN_OPEN) {
+      next();
+      node = parseOr();
+      expect(Kind::PAREN_CLOSE, "')'");
+    }
+    --depth_;
+    return node;
+  }
+
+  std::string parseLiteral() {
+    const ConditionToken &token = peek();
+    if (token.kind != Kind::STRING && token.kind != Kind::WORD) {
+      syntaxError(condition_, "缺少值");
+    }
+    return next().text;
+  }
+
+  NodePtr parsePredicate() {
+    if (peek().kind != Kind::WORD) {
+      syntaxError(condition_, "缺少列名");
+    }
+    Predicate p;
+    p.column = next().text;
+    // col NOT IN / BETWEEN / LIKE / ILIKE 等价于 NOT (col IN / BETWEEN / LIKE / ILIKE)
+    bool negated = false;
+    if (isKeyword(peek(), "NOT")) {
+      next();
+      negated = true;
+      if (!isKeyword(peek(), "IN") && !isKeyword(peek(), "BETWEEN") &&
+          !isKeyword(peek(), "LIKE") && !isKeyword(peek(), "ILIKE")) {
+        syntaxError(condition_, "NOT 之后缺少 IN、BETWEEN、LIKE 或 ILIKE");
+      }
+    }
+    NodePtr node = parseOperands(p);
+    if (negated) {
+      return std::make_unique<NotNode>(std::move(node));
+    }
+    return node;
+  }
+
+  NodePtr parseOperands(Predicate &p) {
+    if (isKeyword(peek(), "IN")) {
+      next();
+      p.kind = Predicate::Kind::IN_LIST;
+      expect(Kind::PAREN_OPEN, "'('");
+      do {
+        p.values.push_back(parseLiteral());
+      } while (peek().kind == Kind::COMMA && (next(), true));
+      expect(Kind::PAREN_CLOSE, "')'");
+    } else if (isKeyword(peek(), "BETWEEN")) {
+      next();
+      p.kind = Predicate::Kind::BETWEEN;
+      p.values.push_back(parseLiteral());
+      if (!isKeyword(peek(), "AND")) {
+        syntaxError(condition_, "BETWEEN 缺少 AND");
+      }
+      next();
+      p.values.push_back(parseLiteral());
+    } else if (isKeyword(peek(), "LIKE") || isKeyword(peek(), "ILIKE")) {
+      p.kind = Predicate::Kind::LIKE;
+      p.op = isKeyword(next(), "ILIKE") ? "ILIKE" : "LIKE";
+      p.values.push_back(parseLiteral());
+    } else {
+      if (peek().kind != Kind::OPERATOR) {
+        syntaxError(condition_, "缺少比较操作符");
+      }
+      p.kind = Predicate::Kind::COMPARE;
+      p.op = next().text;
+      p.values.push_back(parseLiteral());
+    }
+
+    int column = table_.getColumnIndex(p.column);
+    if (column == -1) {
+      return std::make_unique<ConstantNode>(false); // 列不存在，条件不匹配
+    }
+    if (p.kind == Predicate::Kind::LIKE) {
+      return std::make_unique<LikeNode>(
+          column, LikePattern(p.values[0], p.op == "ILIKE"));
+    }
+    switch (table_.getColumnType(column)) {
+    case DataType::INT:
+      return buildPredicate<int64_t>(column, p);
+    case DataType::DOUBLE:
+      return buildPredicate<double>(column, p);
+    case DataType::BOOL:
+      return buildPredicate<bool>(column, p);
+    case DataType::STRING:
+      break;
+    }
+    return buildPredicate<std::string_view>(column, p);
+  }
+
+  const TableData &table_;
+  static constexpr int MAX_DEPTH = 64;
+
+  const std::string &condition_;
+  std::vector<ConditionToken> tokens_;
+  size_t position_ = 0;
+  int depth_ = 0;
+};
+
+} // namespace
+
+RowFilter::RowFilter(const TableData &table, const std::string &condition) {
+  if (condition.find_first_not_of(" \t\n\r") != std::string::npos) {
+    root_ = ConditionParser(table, condition).parse();
+  }
+}
+
+RowFilter::~RowFilter() = default;
+
+std::string RowFilter::quote(std::string_view value) {
+  std::string quoted = "'";
+  for (char c : value) {
+    if (c == '\'') {
+      quoted += '\'';
+    }
+    quoted += c;
+  }
+  quoted += '\'';
+  return quoted;
+}
@@ -0,0 +1,188 @@
+#include "../../include/server/ServerStats.hpp"
+#include <algorithm> // 用于 std::sort
+#include <bit>       // 用于 std::bit_width
+#include <mutex>     // 用于 std::unique_lock
+
+const char *queryStageName(QueryStage stage) {
+  switch (stage) {
+  case QueryStage::RECEIVE:
+    return "receive";
+  case QueryStage::PARSE:
+    return "parse";
+  case QueryStage::PLAN:
+    return "plan";
+  case QueryStage::EXECUTE:
+    return "execute";
+  case QueryStage::SERIALIZE:
+    return "serialize";
+  case QueryStage::SEND:
+    return "send";
+  case QueryStage::TOTAL:
+    return "total";
+  default:
+    return "unknown";
+  }
+}
+
+uint64_t QueryTimings::totalNanos() const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < QUERY_STAGE_COUNT; ++i) {
+    if (i != static_cast<size_t>(QueryStage::TOTAL)) {
+      total += stageNanos[i];
+    }
+  }
+  return total;
+}
+
+// ========== LatencyHistogram ==========
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+  if (value < SUB_BUCKET_COUNT) {
+    return static_cast<size_t>(value);
+  }
+  // magnitude 为最高有效位的位置，value 落在 [2^magnitude, 2^(magnitude+1))
+  unsigned magnitude = std::bit_width(value) - 1;
+  unsigned shift = magnitude - SUB_BUCKET_BITS;
+  uint64_t sub = (value >> shift) - SUB_BUCKET_COUNT;
+  return static_cast<size_t>((shift + 1) * SUB_BUCKET_COUNT + sub);
+}
+
+uint64_t LatencyHistogram::bucketLowerBound(size_t index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+  unsigned shift = static_cast<unsigned>(index / SUB_BUCKET_COUNT) - 1;
+  uint64_t sub = index % SUB_BUCKET_COUNT;
+  return (SUB_BUCKET_COUNT + sub) << shift;
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+  if (index < SUB_BUCKET_COUNT) {
+    return index;
+  }
+  unsigned shift = static_cast<unsigned>(index / SUB_BUCKET_COUNT) - 1;
+  return bucketLowerBound(index) + ((1ull << shift) - 1);
+}
+
+void LatencyHistogram::record(uint64_t nanos) {
+  buckets_[bucketIndex(nanos)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(nanos, std::memory_order_relaxed);
+
+  uint64_t current = max_.load(std::memory_order_relaxed);
+  while (nanos > current &&
+         !max_.compare_exchange_weak(current, nanos,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+uint64_t LatencyHistogram::percentile(double quantile) const {
+  uint64_t total = count();
+  if (total == 0) {
+    return 0;
+  }
+  quantile = std::clamp(quantile, 0.0, 1.0);
+  uint64_t target = static_cast<uint64_t>(quantile * total);
+  if (target == 0) {
+    target = 1;
+  }
+
+  uint64_t seen = 0;
+  for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= target) {
+      uint64_t lower = bucketLowerBound(i);
+      uint64_t upper = bucketUpperBound(i);
+      // 不超过观测到的最大值，避免 p99 比 max 还大
+      return std::min(lower + (upper - lower) / 2, max());
+    }
+  }
+  return max();
+}
+
+LatencySummary LatencyHistogram::summary() const {
+  LatencySummary result;
+  result.count = count();
+  result.meanMicros = result.count ? sum() / 1000.0 / result.count : 0;
+  result.p50Micros = percentile(0.50) / 1000.0;
+  result.p90Micros = percentile(0.90) / 1000.0;
+  result.p99Micros = percentile(0.99) / 1000.0;
+  result.maxMicros = max() / 1000.0;
+  return result;
+}
+
+// ========== ServerStats ==========
+
+ServerStats::OperationStats &
+ServerStats::lookup(const std::string &operation, const std::string &table) {
+  std::string key = operation + '\0' + table;
+  {
+    std::shared_lock lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+      return *it->second;
+    }
+  }
+
+  std::unique_lock lock(mutex_);
+  auto &entry = entries_[key];
+  if (!entry) {
+    entry = std::make_unique<OperationStats>();
+    entry->operation = operation;
+    entry->table = table;
+  }
+  return *entry;
+}
+
+void ServerStats::record(const std::string &operation,
+                         const std::string &table,
+                         const QueryTimings &timings) {
+  OperationStats &stats = lookup(operation, table);
+  for (size_t i = 0; i < QUERY_STAGE_COUNT; ++i) {
+    if (i == static_cast<size_t>(QueryStage::TOTAL)) {
+      stats.stages[i].record(timings.totalNanos());
+    } else {
+      stats.stages[i].record(timings.stageNanos[i]);
+    }
+  }
+  stats.rowsScanned.fetch_add(timings.rowsScanned, std::memory_order_relaxed);
+  stats.rowsReturned.fetch_add(timings.rowsReturned,
+                               std::memory_order_relaxed);
+  stats.bytesSent.fetch_add(timings.bytesSent, std::memory_order_relaxed);
+}
+
+std::vector<OperationStatsSnapshot> ServerStats::snapshot() const {
+  std::vector<OperationStatsSnapshot> result;
+  {
+    std::shared_lock lock(mutex_);
+    result.reserve(entries_.size());
+    for (const auto &pair : entries_) {
+      const OperationStats &stats = *pair.second;
+      OperationStatsSnapshot snap;
+      snap.operation = stats.operation;
+      snap.table = stats.table;
+      for (size_t i = 0; i < QUERY_STAGE_COUNT; ++i) {
+        snap.stages[i] = stats.stages[i].summary();
+      }
+      snap.rowsScanned = stats.rowsScanned.load(std::memory_order_relaxed);
+      snap.rowsReturned = stats.rowsReturned.load(std::memory_order_relaxed);
+      snap.bytesSent = stats.bytesSent.load(std::memory_order_relaxed);
+      result.push_back(std::move(snap));
+    }
+  }
+
+  std::sort(result.begin(), result.end(),
+            [](const OperationStatsSnapshot &a,
+               const OperationStatsSnapshot &b) {
+              if (a.operation != b.operation) {
+                return a.operation < b.operation;
+              }
+              return a.table < b.table;
+            });
+  return result;
+}
+
+void ServerStats::reset() {
+  std::unique_lock lock(mutex_);
+  entries_.clear();
+}
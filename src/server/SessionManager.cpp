@@ -0,0 +1,142 @@
+#include "../../include/server/SessionManager.hpp"
+
+#include <cerrno>
+#include <stdexcept>
+#include <sys/random.h>
+
+namespace {
+
+int64_t steadyNowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+} // namespace
+
+SessionManager::SessionManager(std::chrono::seconds idleTimeout)
+    : idleTimeoutNanos_(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(idleTimeout)
+              .count()) {}
+
+std::string SessionManager::generateToken() {
+  unsigned char bytes[TOKEN_BYTES];
+  size_t filled = 0;
+  while (filled < sizeof(bytes)) {
+    ssize_t n = getrandom(bytes + filled, sizeof(bytes) - filled, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error("getrandom failed, cannot generate session token");
+    }
+    filled += static_cast<size_t>(n);
+  }
+
+  static constexpr char HEX[] = "0123456789abcdef";
+  std::string token;
+  token.reserve(TOKEN_BYTES * 2);
+  for (unsigned char byte : bytes) {
+    token += HEX[byte >> 4];
+    token += HEX[byte & 0x0f];
+  }
+  return token;
+}
+
+std::shared_ptr<Session> SessionManager::create(const std::string &username,
+                                                uint64_t connectionId) {
+  auto session = std::make_shared<Session>();
+  session->id = nextId_.fetch_add(1, std::memory_order_relaxed);
+  session->username = username;
+  session->connectionId = connectionId;
+  session->lastActiveNanos.store(steadyNowNanos(), std::memory_order_relaxed);
+
+  // 128 位随机令牌几乎不会重复，重复时重新生成
+  while (true) {
+    session->token = generateToken();
+    Shard &shard = shardFor(session->token);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    removeExpiredLocked(shard, steadyNowNanos());
+    if (shard.sessions.emplace(session->token, session).second) {
+      return session;
+    }
+  }
+}
+
+std::shared_ptr<Session> SessionManager::find(std::string_view token,
+                                              uint64_t connectionId) {
+  Shard &shard = shardFor(token);
+  int64_t now = steadyNowNanos();
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.sessions.find(token);
+  if (it == shard.sessions.end()) {
+    return nullptr;
+  }
+  if (expired(*it->second, now)) {
+    shard.sessions.erase(it);
+    return nullptr;
+  }
+  if (it->second->connectionId != connectionId) {
+    return nullptr;
+  }
+  it->second->lastActiveNanos.store(now, std::memory_order_relaxed);
+  return it->second;
+}
+
+bool SessionManager::remove(std::string_view token) {
+  Shard &shard = shardFor(token);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.sessions.find(token);
+  if (it == shard.sessions.end()) {
+    return false;
+  }
+  shard.sessions.erase(it);
+  return true;
+}
+
+size_t SessionManager::removeExpired() {
+  int64_t now = steadyNowNanos();
+  size_t removed = 0;
+  for (Shard &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    removed += removeExpiredLocked(shard, now);
+  }
+  return removed;
+}
+
+size_t SessionManager::size() const {
+  size_t total = 0;
+  for (const Shard &shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    total += shard.sessions.size();
+  }
+  return total;
+}
+
+SessionManager::Shard &SessionManager::shardFor(std::string_view token) {
+  // 分片用哈希的高位，分片内的桶用低位，两者互不相关
+  size_t hash = TokenHash{}(token);
+  return shards_[(hash >> 32) % SHARD_COUNT];
+}
+
+bool SessionManager::expired(const Session &session, int64_t nowNanos) const {
+  return idleTimeoutNanos_ > 0 &&
+         nowNanos - session.lastActiveNanos.load(std::memory_order_relaxed) >=
+             idleTimeoutNanos_;
+}
+
+size_t SessionManager::removeExpiredLocked(Shard &shard, int64_t nowNanos) {
+  if (idleTimeoutNanos_ <= 0) {
+    return 0;
+  }
+  size_t removed = 0;
+  for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+    if (expired(*it->second, nowNanos)) {
+      it = shard.sessions.erase(it);
+      ++removed;
+    } else {
+      ++it;
+    }
+  }
+  return removed;
+}
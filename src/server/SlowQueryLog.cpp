@@ -0,0 +1,138 @@
+#include "../../include/server/SlowQueryLog.hpp"
+#include <ctime>      // 用于 gmtime_r
+#include <filesystem> // 用于日志轮转时的重命名
+#include <iomanip>    // 用于 std::put_time
+#include <iostream>   // 用于在控制台打印错误信息
+#include <sstream>    // 用于 std::ostringstream
+
+SlowQueryLog::SlowQueryLog(SlowQueryLogConfig config)
+    : config_(std::move(config)) {
+  if (!enabled()) {
+    return;
+  }
+  openFile();
+  worker_ = std::thread(&SlowQueryLog::run, this);
+}
+
+SlowQueryLog::~SlowQueryLog() {
+  {
+    std::lock_guard lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_one();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+bool SlowQueryLog::submit(SlowQueryEntry entry) {
+  if (!enabled()) {
+    return false;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    if (queue_.size() >= config_.maxQueueSize) {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    queue_.push_back(std::move(entry));
+  }
+  cv_.notify_one();
+  return true;
+}
+
+void SlowQueryLog::run() {
+  std::deque<SlowQueryEntry> batch;
+  while (true) {
+    {
+      std::unique_lock lock(mutex_);
+      cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+      if (queue_.empty() && stopping_) {
+        break;
+      }
+      batch.swap(queue_);
+    }
+
+    // 在锁外格式化和写文件，不影响请求线程入队
+    for (const auto &entry : batch) {
+      write(entry);
+    }
+    batch.clear();
+    file_.flush();
+  }
+}
+
+void SlowQueryLog::write(const SlowQueryEntry &entry) {
+  auto micros = [&](QueryStage stage) {
+    return entry.timings.get(stage) / 1000;
+  };
+
+  std::time_t seconds = std::chrono::system_clock::to_time_t(entry.timestamp);
+  auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    entry.timestamp.time_since_epoch())
+                    .count() %
+                1000;
+  std::tm utc{};
+  gmtime_r(&seconds, &utc);
+
+  std::ostringstream line;
+  line << std::put_time(&utc, "%Y-%m-%dT%H:%M:%S") << '.' << std::setw(3)
+       << std::setfill('0') << millis << 'Z' << std::setfill(' ')
+       << " session=" << (entry.session.empty() ? "-" : entry.session)
+       << " total_us=" << entry.timings.totalNanos() / 1000
+       << " receive_us=" << micros(QueryStage::RECEIVE)
+       << " deserialize_us=" << micros(QueryStage::PARSE)
+       << " plan_us=" << micros(QueryStage::PLAN)
+       << " execute_us=" << micros(QueryStage::EXECUTE)
+       << " serialize_us=" << micros(QueryStage::SERIALIZE)
+       << " send_us=" << micros(QueryStage::SEND)
+       << " rows_scanned=" << entry.timings.rowsScanned
+       << " rows_returned=" << entry.timings.rowsReturned
+       << " bytes_sent=" << entry.timings.bytesSent
+       << " statement=\"" << entry.statement << "\"\n";
+
+  std::string text = line.str();
+  if (fileBytes_ > 0 && fileBytes_ + text.size() > config_.maxFileBytes) {
+    rotate();
+  }
+  if (file_.is_open()) {
+    file_ << text;
+    fileBytes_ += text.size();
+  }
+}
+
+void SlowQueryLog::rotate() {
+  file_.close();
+  try {
+    // path.N-1 -> path.N, ..., path -> path.1，最旧的文件被覆盖
+    for (unsigned i = config_.maxFiles; i > 0; --i) {
+      std::filesystem::path from =
+          i == 1 ? std::filesystem::path(config_.path)
+                 : std::filesystem::path(config_.path + "." +
+                                         std::to_string(i - 1));
+      std::filesystem::path to = config_.path + "." + std::to_string(i);
+      if (std::filesystem::exists(from)) {
+        std::filesystem::rename(from, to);
+      }
+    }
+    if (config_.maxFiles == 0) {
+      std::filesystem::remove(config_.path);
+    }
+  } catch (const std::filesystem::filesystem_error &e) {
+    std::cerr << "Slow query log rotation failed: " << e.what() << std::endl;
+  }
+  openFile();
+}
+
+void SlowQueryLog::openFile() {
+  file_.open(config_.path, std::ios::app);
+  if (!file_.is_open()) {
+    std::cerr << "Error: Cannot open slow query log '" << config_.path << "'."
+              << std::endl;
+    fileBytes_ = 0;
+    return;
+  }
+  std::error_code ec;
+  auto size = std::filesystem::file_size(config_.path, ec);
+  fileBytes_ = ec ? 0 : size;
+}
@@ -0,0 +1,483 @@
+#include "../../include/server/TaskScheduler.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <pthread.h>
+#include <sched.h>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+
+namespace {
+
+// 找不到任务时先让出 CPU 重试这么多轮，再睡眠等待唤醒
+constexpr int SPIN_ROUNDS = 64;
+
+/**
+ * @brief Chase-Lev 工作窃取双端队列（按 Lê 等人给出的 C11 内存序实现）。
+ * push()/pop() 只能由持有者线程调用，steal() 可以从任意线程调用。
+ * 扩容后的旧数组保留到队列销毁，窃取者可能仍在读取它们。
+ */
+template <typename T> class WorkStealingDeque {
+public:
+  explicit WorkStealingDeque(int64_t capacity = 256) {
+    rings_.push_back(std::make_unique<Ring>(capacity));
+    ring_.store(rings_.back().get(), std::memory_order_relaxed);
+  }
+
+  void push(T *item) {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed);
+    int64_t top = top_.load(std::memory_order_acquire);
+    Ring *ring = ring_.load(std::memory_order_relaxed);
+    if (bottom - top > ring->capacity - 1) {
+      ring = grow(ring, top, bottom);
+    }
+    ring->put(bottom, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(bottom + 1, std::memory_order_relaxed);
+  }
+
+  T *pop() {
+    int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+    Ring *ring = ring_.load(std::memory_order_relaxed);
+    bottom_.store(bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t top = top_.load(std::memory_order_relaxed);
+
+    if (top > bottom) { // 队列为空
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T *item = ring->get(bottom);
+    if (top == bottom) { // 最后一个元素，与窃取者竞争
+      if (!top_.compare_exchange_strong(top, top + 1,
+                                        std::memory_order_seq_cst,
+                                        std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(bottom + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // 竞争失败时也返回 nullptr，调用方换一个队列重试即可
+  T *steal() {
+    int64_t top = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t bottom = bottom_.load(std::memory_order_acquire);
+    if (top >= bottom) {
+      return nullptr;
+    }
+    Ring *ring = ring_.load(std::memory_order_acquire);
+    T *item = ring->get(top);
+    if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+private:
+  struct Ring {
+    explicit Ring(int64_t size)
+        : capacity(size), slots(std::make_unique<std::atomic<T *>[]>(size)) {}
+
+    T *get(int64_t index) const {
+      return slots[index & (capacity - 1)].load(std::memory_order_relaxed);
+    }
+    void put(int64_t index, T *item) {
+      slots[index & (capacity - 1)].store(item, std::memory_order_relaxed);
+    }
+
+    const int64_t capacity; // 2 的幂
+    std::unique_ptr<std::atomic<T *>[]> slots;
+  };
+
+  Ring *grow(Ring *old, int64_t top, int64_t bottom) {
+    rings_.push_back(std::make_unique<Ring>(old->capacity * 2));
+    Ring *ring = rings_.back().get();
+    for (int64_t i = top; i < bottom; ++i) {
+      ring->put(i, old->get(i));
+    }
+    ring_.store(ring, std::memory_order_release);
+    return ring;
+  }
+
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  std::atomic<Ring *> ring_{nullptr};
+  std::vector<std::unique_ptr<Ring>> rings_; // 只由持有者线程修改
+};
+
+// 解析 cpulist 格式（例如 "0-3,8-11"）
+std::vector<int> parseCpuList(const std::string &text) {
+  std::vector<int> cpus;
+  std::stringstream stream(text);
+  std::string range;
+  while (std::getline(stream, range, ',')) {
+    try {
+      size_t dash = range.find('-');
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; ++cpu) {
+        cpus.push_back(cpu);
+      }
+    } catch (const std::exception &) {
+      // 忽略无法解析的片段
+    }
+  }
+  return cpus;
+}
+
+// 当前进程可用的 CPU，按 (NUMA 节点, CPU 编号) 排序；读不到节点信息时都算作节点 0
+std::vector<std::pair<int, int>> availableCpusByNode() {
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return {};
+  }
+
+  std::map<int, int> nodeOf;
+  std::error_code ec;
+  for (const auto &entry :
+       std::filesystem::directory_iterator("/sys/devices/system/node", ec)) {
+    std::string name = entry.path().filename().string();
+    if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+        !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+      continue;
+    }
+    std::ifstream file(entry.path() / "cpulist");
+    std::string text;
+    std::getline(file, text);
+    for (int cpu : parseCpuList(text)) {
+      nodeOf[cpu] = std::stoi(name.substr(4));
+    }
+  }
+
+  std::vector<std::pair<int, int>> cpus;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &allowed)) {
+      auto it = nodeOf.find(cpu);
+      cpus.emplace_back(it == nodeOf.end() ? 0 : it->second, cpu);
+    }
+  }
+  std::sort(cpus.begin(), cpus.end());
+  return cpus;
+}
+
+struct WorkerContext {
+  const TaskScheduler *scheduler = nullptr;
+  int index = -1;
+};
+
+thread_local WorkerContext currentWorker;
+thread_local TaskGroup *currentGroup = nullptr;
+
+} // namespace
+
+struct TaskScheduler::Worker {
+  WorkStealingDeque<Task> deques[PRIORITY_LEVELS];
+  std::thread thread;
+  int cpu = -1; // 绑定的 CPU，未绑定时为 -1
+  int node = 0;
+  std::vector<int> victims; // 窃取时依次尝试的工作线程，同一节点的在前
+  std::atomic<uint64_t> executed{0};
+  std::atomic<uint64_t> stolen{0};
+};
+
+// ========== TaskScheduler ==========
+
+TaskScheduler::TaskScheduler(const SchedulerConfig &config) {
+  size_t count = config.threads;
+  if (count == 0) {
+    count = std::max(1u, std::thread::hardware_concurrency());
+  }
+  for (size_t i = 0; i < count; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+
+  if (config.pinThreads) {
+    pinWorkers();
+  }
+  for (size_t i = 0; i < count; ++i) {
+    Worker &worker = *workers_[i];
+    for (int pass = 0; pass < 2; ++pass) {
+      for (size_t step = 1; step < count; ++step) {
+        size_t other = (i + step) % count;
+        bool sameNode = workers_[other]->node == worker.node;
+        if (sameNode == (pass == 0)) {
+          worker.victims.push_back(static_cast<int>(other));
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    workers_[i]->thread = std::thread([this, i] { workerLoop(i); });
+    if (workers_[i]->cpu >= 0) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(workers_[i]->cpu, &set);
+      pthread_setaffinity_np(workers_[i]->thread.native_handle(), sizeof(set),
+                             &set);
+    }
+  }
+}
+
+TaskScheduler::~TaskScheduler() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  wakeup_.notify_all();
+  for (auto &worker : workers_) {
+    worker->thread.join();
+  }
+}
+
+void TaskScheduler::pinWorkers() {
+  std::vector<std::pair<int, int>> cpus = availableCpusByNode();
+  if (cpus.empty()) {
+    return;
+  }
+  std::set<int> nodes;
+  for (size_t i = 0; i < workers_.size(); ++i) {
+    // 工作线程多于 CPU 时从头开始复用
+    const auto &[node, cpu] = cpus[i % cpus.size()];
+    workers_[i]->node = node;
+    workers_[i]->cpu = cpu;
+    nodes.insert(node);
+  }
+  numaNodes_ = nodes.size();
+}
+
+void TaskScheduler::submit(std::function<void()> fn, TaskPriority priority) {
+  enqueue(new Task{std::move(fn), nullptr, priority});
+}
+
+bool TaskScheduler::onWorkerThread() const {
+  return currentWorker.scheduler == this;
+}
+
+bool TaskScheduler::cancellationRequested() {
+  return currentGroup && currentGroup->isCancelled();
+}
+
+SchedulerStats TaskScheduler::stats() const {
+  SchedulerStats result;
+  result.threads = workers_.size();
+  result.numaNodes = numaNodes_;
+  for (const auto &worker : workers_) {
+    result.tasksExecuted += worker->executed.load(std::memory_order_relaxed);
+    result.tasksStolen += worker->stolen.load(std::memory_order_relaxed);
+  }
+  result.tasksCancelled = cancelled_.load(std::memory_order_relaxed);
+  result.externalSubmissions = external_.load(std::memory_order_relaxed);
+  return result;
+}
+
+void TaskScheduler::enqueue(Task *task) {
+  size_t level = static_cast<size_t>(task->priority);
+  if (currentWorker.scheduler == this) {
+    workers_[currentWorker.index]->deques[level].push(task);
+  } else {
+    std::lock_guard<std::mutex> lock(mutex_);
+    injected_[level].push_back(task);
+    injectedCount_.fetch_add(1, std::memory_order_relaxed);
+    external_.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  // 与 workerLoop 中先登记 sleeping_ 再检查 queued_ 的顺序配对，不会漏掉唤醒
+  queued_.fetch_add(1, std::memory_order_seq_cst);
+  if (sleeping_.load(std::memory_order_seq_cst) > 0) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wakeup_.notify_one();
+  }
+}
+
+bool TaskScheduler::runOne(int self) {
+  bool stolen = false;
+  Task *task = nullptr;
+  for (size_t level = 0; level < PRIORITY_LEVELS && !task; ++level) {
+    if (self >= 0) {
+      task = workers_[self]->deques[level].pop();
+    }
+    if (!task && injectedCount_.load(std::memory_order_relaxed) > 0) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!injected_[level].empty()) {
+        task = injected_[level].front();
+        injected_[level].pop_front();
+        injectedCount_.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+    if (!task) {
+      task = stealFrom(self, level);
+      stolen = task != nullptr;
+    }
+  }
+  if (!task) {
+    return false;
+  }
+  queued_.fetch_sub(1, std::memory_order_relaxed);
+  execute(task, stolen);
+  return true;
+}
+
+TaskScheduler::Task *TaskScheduler::stealFrom(int self, size_t level) {
+  if (self >= 0) {
+    for (int victim : workers_[self]->victims) {
+      if (Task *task = workers_[victim]->deques[level].steal()) {
+        return task;
+      }
+    }
+    return nullptr;
+  }
+  for (auto &worker : workers_) {
+    if (Task *task = worker->deques[level].steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+void TaskScheduler::execute(Task *task, bool stolen) {
+  TaskGroup *group = task->group;
+  std::exception_ptr error;
+
+  if (group && group->isCancelled()) {
+    cancelled_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    TaskGroup *outer = std::exchange(currentGroup, group);
+    try {
+      task->fn();
+    } catch (...) {
+      error = std::current_exception();
+    }
+    currentGroup = outer;
+
+    // 非工作线程在等待任务组时帮忙执行的任务记到第一个工作线程上
+    Worker &worker = *workers_[onWorkerThread() ? currentWorker.index : 0];
+    worker.executed.fetch_add(1, std::memory_order_relaxed);
+    if (stolen) {
+      worker.stolen.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  delete task;
+
+  if (group) {
+    group->taskFinished(error);
+  } else if (error) {
+    try {
+      std::rethrow_exception(error);
+    } catch (const std::exception &e) {
+      std::cerr << "[SCHEDULER] Task failed: " << e.what() << std::endl;
+    } catch (...) {
+      std::cerr << "[SCHEDULER] Task failed with an unknown exception"
+                << std::endl;
+    }
+  }
+}
+
+void TaskScheduler::workerLoop(size_t index) {
+  currentWorker = {this, static_cast<int>(index)};
+  int idleRounds = 0;
+  while (true) {
+    if (runOne(static_cast<int>(index))) {
+      idleRounds = 0;
+      continue;
+    }
+    if (++idleRounds < SPIN_ROUNDS) {
+      std::this_thread::yield();
+      continue;
+    }
+    idleRounds = 0;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (stopping_ && queued_.load(std::memory_order_seq_cst) == 0) {
+      return;
+    }
+    sleeping_.fetch_add(1, std::memory_order_seq_cst);
+    if (queued_.load(std::memory_order_seq_cst) == 0 && !stopping_) {
+      wakeup_.wait(lock);
+    }
+    sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+  }
+}
+
+// ========== TaskGroup ==========
+
+TaskGroup::TaskGroup(TaskScheduler &scheduler, TaskPriority priority)
+    : scheduler_(scheduler), priority_(priority) {}
+
+TaskGroup::~TaskGroup() {
+  if (pending_.load(std::memory_order_acquire) > 0) {
+    cancel();
+  }
+  join();
+}
+
+void TaskGroup::run(std::function<void()> fn) {
+  pending_.fetch_add(1, std::memory_order_relaxed);
+  scheduler_.enqueue(new TaskScheduler::Task{std::move(fn), this, priority_});
+}
+
+void TaskGroup::wait() {
+  join();
+  std::exception_ptr error;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    error = std::exchange(error_, nullptr);
+  }
+  cancelled_.store(false, std::memory_order_relaxed); // 之后可以继续使用这个组
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void TaskGroup::join() {
+  const int self =
+      scheduler_.onWorkerThread() ? currentWorker.index : -1;
+  while (pending_.load(std::memory_order_acquire) > 0) {
+    if (scheduler_.runOne(self)) {
+      continue;
+    }
+    // 组内剩下的任务正在其他线程上执行；限时等待，期间新提交的任务也能被及时执行
+    std::unique_lock<std::mutex> lock(mutex_);
+    finished_.wait_for(lock, std::chrono::milliseconds(1), [this] {
+      return pending_.load(std::memory_order_acquire) == 0;
+    });
+  }
+  // 最后一个任务在持有 mutex_ 时把 pending_ 减到 0，加锁一次确保它已经离开，
+  // 之后调用方可以安全地销毁这个组
+  std::lock_guard<std::mutex> lock(mutex_);
+}
+
+void TaskGroup::taskFinished(std::exception_ptr error) {
+  if (error) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+      error_ = error;
+    }
+    cancel();
+  }
+
+  size_t pending = pending_.load(std::memory_order_relaxed);
+  while (pending > 1) {
+    if (pending_.compare_exchange_weak(pending, pending - 1,
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_relaxed)) {
+      return;
+    }
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    finished_.notify_all();
+  }
+}
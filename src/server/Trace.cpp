@@ -0,0 +1,144 @@
+#include "../../include/server/Trace.hpp"
+#include <algorithm> // 用于 std::min
+#include <fstream>   // 用于导出文件
+#include <iomanip>   // 用于 std::setprecision
+
+// ========== TraceBuffer ==========
+
+TraceBuffer::TraceBuffer(uint32_t threadId, size_t capacity)
+    : threadId_(threadId), slots_(std::make_unique<Slot[]>(capacity)),
+      capacity_(capacity) {}
+
+void TraceBuffer::push(const char *name, uint64_t startTicks,
+                       uint64_t endTicks) {
+  uint64_t index = writeIndex_.load(std::memory_order_relaxed);
+  Slot &slot = slots_[index % capacity_];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.startTicks.store(startTicks, std::memory_order_relaxed);
+  slot.endTicks.store(endTicks, std::memory_order_relaxed);
+  writeIndex_.store(index + 1, std::memory_order_release);
+}
+
+std::vector<TraceBuffer::Span> TraceBuffer::snapshot() const {
+  uint64_t end = writeIndex_.load(std::memory_order_acquire);
+  uint64_t begin = end > capacity_ ? end - capacity_ : 0;
+
+  std::vector<Span> spans;
+  spans.reserve(end - begin);
+  for (uint64_t i = begin; i < end; ++i) {
+    const Slot &slot = slots_[i % capacity_];
+    spans.push_back({slot.name.load(std::memory_order_relaxed),
+                     slot.startTicks.load(std::memory_order_relaxed),
+                     slot.endTicks.load(std::memory_order_relaxed)});
+  }
+
+  // 复制期间写线程可能已经绕回并覆盖了最旧的槽位，丢弃这部分
+  uint64_t after = writeIndex_.load(std::memory_order_acquire);
+  if (after > begin + capacity_) {
+    size_t overwritten =
+        static_cast<size_t>(std::min<uint64_t>(after - begin - capacity_,
+                                               spans.size()));
+    spans.erase(spans.begin(), spans.begin() + overwritten);
+  }
+  return spans;
+}
+
+// ========== Tracer ==========
+
+Tracer::Tracer()
+    : baseTicks_(readTraceTicks()),
+      baseTime_(std::chrono::steady_clock::now()) {}
+
+Tracer &Tracer::instance() {
+  static Tracer tracer;
+  return tracer;
+}
+
+void Tracer::setEnabled(bool enabled, size_t spansPerThread) {
+  {
+    std::lock_guard lock(mutex_);
+    spansPerThread_ = std::max<size_t>(spansPerThread, 1);
+  }
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+TraceBuffer &Tracer::threadBuffer() {
+  thread_local TraceBuffer *buffer = nullptr;
+  if (!buffer) {
+    std::lock_guard lock(mutex_);
+    buffers_.push_back(std::make_unique<TraceBuffer>(
+        static_cast<uint32_t>(buffers_.size() + 1), spansPerThread_));
+    buffer = buffers_.back().get();
+  }
+  return *buffer;
+}
+
+size_t Tracer::threadCount() const {
+  std::lock_guard lock(mutex_);
+  return buffers_.size();
+}
+
+double Tracer::ticksPerMicro() const {
+#if defined(__x86_64__) || defined(__i386__)
+  // 用构造以来经过的 TSC 计数和 steady_clock 时间估算频率
+  uint64_t nowTicks = readTraceTicks();
+  auto elapsed = std::chrono::steady_clock::now() - baseTime_;
+  double elapsedMicros =
+      std::chrono::duration<double, std::micro>(elapsed).count();
+  if (nowTicks <= baseTicks_ || elapsedMicros <= 0) {
+    return 0;
+  }
+  return (nowTicks - baseTicks_) / elapsedMicros;
+#else
+  return 1000.0; // steady_clock 纳秒
+#endif
+}
+
+double Tracer::ticksToMicros(uint64_t ticks, double ticksPerMicro) const {
+  if (ticksPerMicro <= 0) {
+    return 0;
+  }
+  return static_cast<double>(static_cast<int64_t>(ticks - baseTicks_)) /
+         ticksPerMicro;
+}
+
+size_t Tracer::exportChromeJson(std::ostream &out) const {
+  std::vector<std::pair<uint32_t, std::vector<TraceBuffer::Span>>> threads;
+  {
+    std::lock_guard lock(mutex_);
+    for (const auto &buffer : buffers_) {
+      threads.emplace_back(buffer->threadId(), buffer->snapshot());
+    }
+  }
+
+  const double rate = ticksPerMicro();
+  size_t count = 0;
+  out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+  out << std::fixed << std::setprecision(3);
+  for (const auto &[threadId, spans] : threads) {
+    for (const auto &span : spans) {
+      if (!span.name) {
+        continue;
+      }
+      double start = ticksToMicros(span.startTicks, rate);
+      double end = ticksToMicros(span.endTicks, rate);
+      out << (count ? "," : "") << "\n{\"name\":\"" << span.name
+          << "\",\"cat\":\"sdsql\",\"ph\":\"X\",\"pid\":1,\"tid\":"
+          << threadId << ",\"ts\":" << start
+          << ",\"dur\":" << (end > start ? end - start : 0.0) << "}";
+      ++count;
+    }
+  }
+  out << "\n]}\n";
+  return count;
+}
+
+bool Tracer::exportChromeJson(const std::string &path,
+                              size_t &spanCount) const {
+  std::ofstream file(path, std::ios::trunc);
+  if (!file.is_open()) {
+    return false;
+  }
+  spanCount = exportChromeJson(file);
+  return file.good();
+}
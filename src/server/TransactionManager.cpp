@@ -81,7 +81,7 @@ public:
       if (dataFile.is_open()) {
         for (const Row &row : tableData.rows) {
           bool firstCol = true;
-          for (const std::string &cell : row) {
+          for (const auto &cell : row) {
             if (!firstCol)
               dataFile << ",";
             dataFile << cell;
@@ -132,8 +132,7 @@ public:
     for (const auto &entry : std::filesystem::directory_iterator(dbPath)) {
       if (entry.is_regular_file() && entry.path().extension() == ".meta") {
         std::string tableName = entry.path().stem().string();
-        TableData tableData;
-        tableData.name = tableName;
+        TableData &tableData = core_impl_->addTable(tableName);
 
         std::ifstream metaFile(entry.path());
         std::string line;
@@ -156,15 +155,13 @@ public:
           while (std::getline(dataFile, line)) {
             std::stringstream ss(line);
             std::string cell;
-            Row row;
+            Row &row = tableData.rows.emplace_back();
             while (std::getline(ss, cell, ',')) {
-              row.push_back(cell);
+              row.emplace_back(cell);
             }
-            tableData.rows.push_back(row);
           }
           dataFile.close();
         }
-        core_impl_->tables[tableName] = tableData;
       }
     }
 